@@ -49,6 +49,7 @@ template <class modelType, class methodType, typename propsType>
 Scene<modelType, methodType, propsType>::Scene()
 {
 	model = new modelType();
+	method = NULL;
 }
 
 template <class modelType, class methodType, typename propsType>
@@ -74,44 +75,140 @@ void Scene<modelType, methodType, propsType>::load(propsType& props)
 	method = new methodType(model);
 }
 
+// Linear solver settings are used only by the scenes with sparse solvers
+template <class modelType, class methodType, typename propsType>
+void Scene<modelType, methodType, propsType>::load(propsType& props, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig)
+{
+	if (presConfig != NULL || tempConfig != NULL)
+		cout << "Solver configs are not used by this scene" << endl;
+	load(props);
+}
+
+// Default settings of the sparse solvers, the others have none
+template <class methodType>
+static ParSolverConfig getPresDefaultConfig()
+{
+	return ParSolverConfig();
+}
+
+template <class methodType>
+static ParSolverConfig getTempDefaultConfig()
+{
+	return ParSolverConfig();
+}
+
 template <>
-void Scene<gasOil_3d::GasOil_3D, gasOil_3d::Par3DSolver, gasOil_3d::Properties>::load(gasOil_3d::Properties& props)
+ParSolverConfig getPresDefaultConfig<gasOil_3d::Par3DSolver>()
+{
+	return gasOil_3d::Par3DSolver::getDefaultConfig();
+}
+
+template <>
+ParSolverConfig getPresDefaultConfig<gasOil_perf::ParPerfSolver>()
+{
+	return gasOil_perf::ParPerfSolver::getDefaultConfig();
+}
+
+template <>
+ParSolverConfig getPresDefaultConfig<oil_perf_nit::OilPerfNITSolver>()
+{
+	return oil_perf_nit::OilPerfNITSolver::getPresDefaultConfig();
+}
+
+template <>
+ParSolverConfig getTempDefaultConfig<oil_perf_nit::OilPerfNITSolver>()
+{
+	return oil_perf_nit::OilPerfNITSolver::getTempDefaultConfig();
+}
+
+template <>
+ParSolverConfig getPresDefaultConfig<gasOil_perf_nit::ParPerfNITSolver>()
+{
+	return gasOil_perf_nit::ParPerfNITSolver::getPresDefaultConfig();
+}
+
+template <>
+ParSolverConfig getTempDefaultConfig<gasOil_perf_nit::ParPerfNITSolver>()
+{
+	return gasOil_perf_nit::ParPerfNITSolver::getTempDefaultConfig();
+}
+
+template <class modelType, class methodType, typename propsType>
+bool Scene<modelType, methodType, propsType>::load(propsType& props, const std::string& presConfigFile, const std::string& tempConfigFile)
+{
+	ParSolverConfig presConfig = getPresDefaultConfig<methodType>();
+	ParSolverConfig tempConfig = getTempDefaultConfig<methodType>();
+	if (!presConfigFile.empty() && !presConfig.load(presConfigFile))
+		return false;
+	if (!tempConfigFile.empty() && !tempConfig.load(tempConfigFile))
+		return false;
+
+	load(props, presConfigFile.empty() ? NULL : &presConfig, tempConfigFile.empty() ? NULL : &tempConfig);
+	return true;
+}
+
+template <>
+void Scene<gasOil_3d::GasOil_3D, gasOil_3d::Par3DSolver, gasOil_3d::Properties>::load(gasOil_3d::Properties& props, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig)
 {
 	model->load(props);
 	init_paralution();
 	//set_omp_threads_paralution(1);
 	//info_paralution();
-	method = new gasOil_3d::Par3DSolver(model);
+	method = new gasOil_3d::Par3DSolver(model, presConfig);
 }
 
 template <>
-void Scene<gasOil_perf::GasOil_Perf, gasOil_perf::ParPerfSolver, gasOil_perf::Properties>::load(gasOil_perf::Properties& props)
+void Scene<gasOil_3d::GasOil_3D, gasOil_3d::Par3DSolver, gasOil_3d::Properties>::load(gasOil_3d::Properties& props)
+{
+	load(props, NULL, NULL);
+}
+
+template <>
+void Scene<gasOil_perf::GasOil_Perf, gasOil_perf::ParPerfSolver, gasOil_perf::Properties>::load(gasOil_perf::Properties& props, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig)
 {
 	model->load(props);
 	init_paralution();
 	//set_omp_threads_paralution(1);
 	//info_paralution();
-	method = new gasOil_perf::ParPerfSolver(model);
+	method = new gasOil_perf::ParPerfSolver(model, presConfig);
 }
 
 template <>
-void Scene<oil_perf_nit::Oil_Perf_NIT, oil_perf_nit::OilPerfNITSolver, oil_perf_nit::Properties>::load(oil_perf_nit::Properties& props)
+void Scene<gasOil_perf::GasOil_Perf, gasOil_perf::ParPerfSolver, gasOil_perf::Properties>::load(gasOil_perf::Properties& props)
+{
+	load(props, NULL, NULL);
+}
+
+template <>
+void Scene<oil_perf_nit::Oil_Perf_NIT, oil_perf_nit::OilPerfNITSolver, oil_perf_nit::Properties>::load(oil_perf_nit::Properties& props, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig)
 {
 	model->load(props);
 	init_paralution();
 	//set_omp_threads_paralution(1);
 	//info_paralution();
-	method = new oil_perf_nit::OilPerfNITSolver(model);
+	method = new oil_perf_nit::OilPerfNITSolver(model, presConfig, tempConfig);
 }
 
 template <>
-void Scene<gasOil_perf_nit::GasOil_Perf_NIT, gasOil_perf_nit::ParPerfNITSolver, gasOil_perf_nit::Properties>::load(gasOil_perf_nit::Properties& props)
+void Scene<oil_perf_nit::Oil_Perf_NIT, oil_perf_nit::OilPerfNITSolver, oil_perf_nit::Properties>::load(oil_perf_nit::Properties& props)
+{
+	load(props, NULL, NULL);
+}
+
+template <>
+void Scene<gasOil_perf_nit::GasOil_Perf_NIT, gasOil_perf_nit::ParPerfNITSolver, gasOil_perf_nit::Properties>::load(gasOil_perf_nit::Properties& props, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig)
 {
 	model->load(props);
 	init_paralution();
 	//set_omp_threads_paralution(1);
 	//info_paralution();
-	method = new gasOil_perf_nit::ParPerfNITSolver(model);
+	method = new gasOil_perf_nit::ParPerfNITSolver(model, presConfig, tempConfig);
+}
+
+template <>
+void Scene<gasOil_perf_nit::GasOil_Perf_NIT, gasOil_perf_nit::ParPerfNITSolver, gasOil_perf_nit::Properties>::load(gasOil_perf_nit::Properties& props)
+{
+	load(props, NULL, NULL);
 }
 
 template <class modelType, class methodType, typename propsType>
@@ -4,6 +4,8 @@
 #include <new>
 #include <string>
 
+struct ParSolverConfig;
+
 template <class modelType, class methodType, typename propsType>
 class Scene
 {
@@ -17,6 +19,12 @@ public:
 	
 	void load(propsType& props);
 	void load(propsType& props, int i);
+	// Pressure (or the whole system) & temperature solvers settings, NULL keeps the defaults.
+	// Configs read from files are expected to be loaded over methodType defaults, e.g. ParPerfSolver::getDefaultConfig()
+	void load(propsType& props, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig = NULL);
+	// Settings are read from files over methodType defaults, empty name keeps the defaults.
+	// Returns false without loading if a file is rejected
+	bool load(propsType& props, const std::string& presConfigFile, const std::string& tempConfigFile);
 	void setSnapshotterType(std::string type);
 
 	void start();
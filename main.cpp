@@ -117,17 +117,17 @@ using namespace std;
 	props->L = -50.0*1.e3;
 	
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 	
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -218,17 +218,17 @@ using namespace std;
 	props->L = -50.0*1.e3;
 	
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 	
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -338,17 +338,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->L = -50.0*1.e3;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/new/Boil100.txt");
+	props->B_oil = "props/new/Boil100.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/new/Rs100.txt");
+	props->Rs = "props/new/Rs100.txt";
 
 	return props;
 }
@@ -417,17 +417,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->beta_sk = 6.41*1.E-10;
 	
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 	
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -499,17 +499,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->props_gas.dens_stc = 0.8;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -587,17 +587,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->beta_sk = 1.0*1.E-9;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 	
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -858,17 +858,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->L = -50.0*1.e3;
 	
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/new/koil.txt");
-	setDataFromFile(props->kr_gas, "props/new/kgas0.txt");
+	props->kr_oil = "props/new/koil.txt";
+	props->kr_gas = "props/new/kgas0.txt";
 	
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/new/Boil200.txt");
+	props->B_oil = "props/new/Boil200.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/new/Rs200.txt");
+	props->Rs = "props/new/Rs200.txt";
 
 	return props;
 }*/
@@ -917,8 +917,8 @@ gasOil_rz_NIT::Properties* getProps()
 	//props->props_gas.visc = 0.01;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->z_factor, "props/z_real.txt");
-	setDataFromFile(props->visc_gas, "props/gas_visc_real.txt");
+	props->z_factor = "props/z_real.txt";
+	props->visc_gas = "props/gas_visc_real.txt";
 
 	return props;
 }*/
@@ -1053,17 +1053,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->L = -50.0*1.e3;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 	
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -1157,17 +1157,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->props_gas.dens_stc = 0.8;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -1243,17 +1243,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->props_gas.dens_stc = 0.8;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }*/
@@ -1354,17 +1354,17 @@ gasOil_rz_NIT::Properties* getProps()
 	props->L = -50.0*1.e3;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/new/Boil100.txt");
+	props->B_oil = "props/new/Boil100.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/new/Rs100.txt");
+	props->Rs = "props/new/Rs100.txt";
 
 	return props;
 }*/
@@ -1603,33 +1603,42 @@ gasOil_rz_NIT::Properties* getProps()
 
 int main(int argc, char** argv)
 {
+	// Linear solver settings: diffusion_solver [pressure config] [temperature config]
+	const string presConfigFile = (argc > 1 ? argv[1] : "");
+	const string tempConfigFile = (argc > 2 ? argv[2] : "");
+
 	gasOil_rz_NIT::Properties* props = getProps();
 	Scene<gasOil_rz_NIT::GasOil_RZ_NIT, gasOil_rz_NIT::GasOil2DNITSolver, gasOil_rz_NIT::Properties> scene;
-	scene.load(*props);
+	if (!scene.load(*props, presConfigFile, tempConfigFile))
+		return 1;
 	scene.setSnapshotterType("VTK");
 	scene.start();
 	
 	/*gasOil_3d::Properties* props = getProps();
 	Scene<gasOil_3d::GasOil_3D, gasOil_3d::Par3DSolver, gasOil_3d::Properties> scene;
-	scene.load(*props);
+	if (!scene.load(*props, presConfigFile, tempConfigFile))
+		return 1;
 	scene.setSnapshotterType("VTK");
 	scene.start();*/
 
 	/*gasOil_perf_nit::Properties* props = getProps();
 	Scene<gasOil_perf_nit::GasOil_Perf_NIT, gasOil_perf_nit::ParPerfNITSolver, gasOil_perf_nit::Properties> scene;
-	scene.load(*props);
+	if (!scene.load(*props, presConfigFile, tempConfigFile))
+		return 1;
 	scene.setSnapshotterType("VTK");
 	scene.start();*/
 
 	/*gasOil_perf::Properties* props = getProps();
 	Scene<gasOil_perf::GasOil_Perf, gasOil_perf::ParPerfSolver, gasOil_perf::Properties> scene;
-	scene.load(*props);
+	if (!scene.load(*props, presConfigFile, tempConfigFile))
+		return 1;
 	scene.setSnapshotterType("VTK");
 	scene.start();*/
 
 	/*oil_perf_nit::Properties* props = getProps();
 	Scene<oil_perf_nit::Oil_Perf_NIT, oil_perf_nit::OilPerfNITSolver, oil_perf_nit::Properties> scene;
-	scene.load(*props);
+	if (!scene.load(*props, presConfigFile, tempConfigFile))
+		return 1;
 	scene.setSnapshotterType("VTK");
 	scene.start();*/
 	
@@ -0,0 +1,206 @@
+#include "method/BandSweep.h"
+
+#include <algorithm>
+
+// Largest number of variables per cell tried for grouped numbering
+#define MAX_VAR_NUM 8
+
+BandSweep::BandSweep() : Sweep()
+{
+	varNum = 0;
+	kl = ku = 0;
+}
+
+BandSweep::~BandSweep()
+{
+}
+
+int BandSweep::getIdx(const int node, const int eq, const int order, const int MZ, const int NX) const
+{
+	if (order == 0)
+		return node * MZ + eq;
+	else
+		return (eq / order) * (order * NX) + node * order + eq % order;
+}
+
+void BandSweep::getBandWidth(const int order, int& lower, int& upper, const int MZ, const int NX) const
+{
+	int diff;
+
+	lower = upper = 0;
+	for (int k = 0; k < (int)a.size(); k++)
+	{
+		diff = getIdx(ind_j[k] / MZ, ind_j[k] % MZ, order, MZ, NX) - getIdx(ind_i[k] / MZ, ind_i[k] % MZ, order, MZ, NX);
+		if (diff > upper)
+			upper = diff;
+		else if (-diff > lower)
+			lower = -diff;
+	}
+}
+
+void BandSweep::setOrdering(const int MZ, const int NX)
+{
+	int lower, upper;
+	double cost, minCost;
+
+	// Elimination cost is about size * kl * (2 * kl + ku)
+	varNum = 0;
+	getBandWidth(0, kl, ku, MZ, NX);
+	minCost = (double)kl * (double)(2 * kl + ku);
+
+	for (int order = 1; order <= MAX_VAR_NUM; order++)
+	{
+		if (MZ % order != 0)
+			continue;
+
+		getBandWidth(order, lower, upper, MZ, NX);
+		cost = (double)lower * (double)(2 * lower + upper);
+		if (cost < minCost)
+		{
+			minCost = cost;
+			varNum = order;
+			kl = lower;
+			ku = upper;
+		}
+	}
+}
+
+void BandSweep::addBlocks(const int row, const int colA, const int colB, const int colC, const int MZ)
+{
+	const int NX = (int)rhs.size() / MZ;
+
+	for (int i = 0; i < MZ; i++)
+	{
+		for (int j = 0; j < MZ; j++)
+		{
+			if (A[i][j] != 0.0 && colA >= 0 && colA < NX)
+			{
+				ind_i.push_back(row * MZ + i);
+				ind_j.push_back(colA * MZ + j);
+				a.push_back(A[i][j]);
+			}
+			if (B[i][j] != 0.0 && colB >= 0 && colB < NX)
+			{
+				ind_i.push_back(row * MZ + i);
+				ind_j.push_back(colB * MZ + j);
+				a.push_back(B[i][j]);
+			}
+			if (C[i][j] != 0.0 && colC >= 0 && colC < NX)
+			{
+				ind_i.push_back(row * MZ + i);
+				ind_j.push_back(colC * MZ + j);
+				a.push_back(C[i][j]);
+			}
+		}
+		rhs[row * MZ + i] = RightSide[i][0];
+	}
+}
+
+void BandSweep::factorSolve(const int size)
+{
+	const int width = 2 * kl + ku + 1;
+	int piv, last, jlast;
+	double maxVal, l;
+	double *ri, *rr;
+
+	// Row i stored with offset so that ri[j] is the (i, j) entry
+	for (int i = 0; i < size; i++)
+	{
+		ri = &band[i * width + kl - i];
+
+		last = std::min(size - 1, i + kl);
+		jlast = std::min(size - 1, i + ku + kl);
+
+		// Partial pivoting within the lower band
+		piv = i;
+		maxVal = fabs(ri[i]);
+		for (int r = i + 1; r <= last; r++)
+		{
+			rr = &band[r * width + kl - r];
+			if (fabs(rr[i]) > maxVal)
+			{
+				maxVal = fabs(rr[i]);
+				piv = r;
+			}
+		}
+		if (piv != i)
+		{
+			rr = &band[piv * width + kl - piv];
+			for (int j = i; j <= jlast; j++)
+				std::swap(ri[j], rr[j]);
+			std::swap(x[i], x[piv]);
+		}
+
+		for (int r = i + 1; r <= last; r++)
+		{
+			rr = &band[r * width + kl - r];
+			if (rr[i] != 0.0)
+			{
+				l = rr[i] / ri[i];
+				for (int j = i + 1; j <= jlast; j++)
+					rr[j] -= l * ri[j];
+				x[r] -= l * x[i];
+				rr[i] = 0.0;
+			}
+		}
+	}
+
+	for (int i = size - 1; i >= 0; i--)
+	{
+		ri = &band[i * width + kl - i];
+		jlast = std::min(size - 1, i + ku + kl);
+		for (int j = i + 1; j <= jlast; j++)
+			x[i] -= ri[j] * x[j];
+		x[i] /= ri[i];
+	}
+}
+
+void BandSweep::assemble(const int NZ, const int MZ, const int key)
+{
+	ind_i.clear();
+	ind_j.clear();
+	a.clear();
+	rhs.assign((NZ + 1) * MZ, 0.0);
+
+	// Same block rows as in Sweep::Solve: node, then nodes of A, B & C blocks
+	RightBoundAppr(MZ, key);
+	addBlocks(NZ, NZ, NZ - 1, NZ - 2, MZ);
+	for (int m = NZ - 1; m > 0; m--)
+	{
+		MiddleAppr(m, MZ, key);
+		addBlocks(m, m + 1, m, m - 1, MZ);
+	}
+	LeftBoundAppr(MZ, key);
+	addBlocks(0, 2, 1, 0, MZ);
+}
+
+void BandSweep::Solve(int NZ, int MZ, int key)
+{
+	const int NX = NZ + 1;
+	const int size = NX * MZ;
+	int width;
+
+	assemble(NZ, MZ, key);
+	setOrdering(MZ, NX);
+
+	width = 2 * kl + ku + 1;
+	band.assign((size_t)size * width, 0.0);
+	x.resize(size);
+
+	int r, c;
+	for (int k = 0; k < (int)a.size(); k++)
+	{
+		r = getIdx(ind_i[k] / MZ, ind_i[k] % MZ, varNum, MZ, NX);
+		c = getIdx(ind_j[k] / MZ, ind_j[k] % MZ, varNum, MZ, NX);
+		band[r * width + kl + c - r] += a[k];
+	}
+	for (int n = 0; n < NX; n++)
+		for (int e = 0; e < MZ; e++)
+			x[getIdx(n, e, varNum, MZ, NX)] = rhs[n * MZ + e];
+
+	factorSolve(size);
+
+	for (int n = 0; n < NX; n++)
+		for (int e = 0; e < MZ; e++)
+			fz[n][e + 1] = x[getIdx(n, e, varNum, MZ, NX)];
+}
@@ -0,0 +1,48 @@
+#ifndef BANDSWEEP_H_
+#define BANDSWEEP_H_
+
+#include <vector>
+
+#include "method/sweep.h"
+
+// Sweep that solves the whole block-tridiagonal system with a banded LU.
+// Blocks are still filled through LeftBoundAppr / MiddleAppr / RightBoundAppr,
+// but only their non-zeros are kept and unknowns are renumbered to get the narrowest band.
+// For RZ grids the band is limited by the radial size, so the cost grows linearly with z-cells
+// instead of the cubic dense elimination of bz blocks.
+class BandSweep : public Sweep
+{
+protected:
+	// Non-zeros of assembled system in (node, eq) numbering
+	std::vector<int> ind_i;
+	std::vector<int> ind_j;
+	std::vector<double> a;
+	std::vector<double> rhs;
+
+	// Unknowns numbering: varNum == 0 is node-major, else variables of one layer of varNum equations
+	// are grouped through all nodes
+	int varNum;
+	int kl, ku;
+	int getIdx(const int node, const int eq, const int order, const int MZ, const int NX) const;
+	void getBandWidth(const int order, int& lower, int& upper, const int MZ, const int NX) const;
+	void setOrdering(const int MZ, const int NX);
+
+	// Band storage, row i keeps columns [i - kl, i + ku + kl] for partial pivoting fill-in
+	std::vector<double> band;
+	std::vector<double> x;
+
+	void addBlocks(const int row, const int colA, const int colB, const int colC, const int MZ);
+	// Collects the whole system through the approximation hooks
+	void assemble(const int NZ, const int MZ, const int key);
+	void factorSolve(const int size);
+
+public:
+	BandSweep();
+	~BandSweep();
+
+	void Solve(int NZ, int MZ, int key);
+	// Blocks are read directly from A, B & C, bz is not used
+	void construction_bz(int num_eq, int flag) {};
+};
+
+#endif /* BANDSWEEP_H_ */
@@ -0,0 +1,95 @@
+#include "method/BlockILUPreconditioner.h"
+
+#include <iostream>
+
+using namespace paralution;
+using std::vector;
+using std::cout;
+using std::endl;
+
+BlockILUPreconditioner::BlockILUPreconditioner()
+{
+	blockSize = 1;
+	mat = NULL;
+}
+
+BlockILUPreconditioner::~BlockILUPreconditioner()
+{
+	Clear();
+}
+
+void BlockILUPreconditioner::Set(const int _blockSize)
+{
+	blockSize = _blockSize;
+}
+
+void BlockILUPreconditioner::Print() const
+{
+	cout << "Block ILU(0) preconditioner: block size = " << blockSize << endl;
+}
+
+void BlockILUPreconditioner::copyToHostCSR(const LocalMatrix<double>& src, vector<int>& row, vector<int>& col, vector<double>& val)
+{
+	LocalMatrix<double> host;
+	host.CloneFrom(src);
+	host.MoveToHost();
+	host.ConvertToCSR();
+
+	row.resize(host.get_nrow() + 1);
+	col.resize(host.get_nnz());
+	val.resize(host.get_nnz());
+	host.CopyToCSR(&row[0], &col[0], &val[0]);
+	host.Clear();
+}
+
+void BlockILUPreconditioner::BuildFromCSR(const int size, const int* row, const int* col, const double* val)
+{
+	Clear();
+
+	// Block size is validated by ParSolverConfig::check
+	mat = createBlockMatrix(blockSize);
+	mat->setFromCSR(size, row, col, val);
+	mat->factorILU0();
+
+	rhs_buf.resize(size);
+	x_buf.resize(size);
+
+	this->build_ = true;
+}
+
+void BlockILUPreconditioner::Build()
+{
+	vector<int> row, col;
+	vector<double> val;
+	copyToHostCSR(*this->op_, row, col, val);
+
+	BuildFromCSR((int)row.size() - 1, &row[0], &col[0], &val[0]);
+}
+
+void BlockILUPreconditioner::Clear()
+{
+	if (mat != NULL)
+	{
+		delete mat;
+		mat = NULL;
+	}
+	rhs_buf.clear();
+	x_buf.clear();
+
+	this->build_ = false;
+}
+
+void BlockILUPreconditioner::Solve(const LocalVector<double>& rhs, LocalVector<double>* x)
+{
+	rhs.CopyToData(&rhs_buf[0]);
+	mat->solveILU0(&rhs_buf[0], &x_buf[0]);
+	x->CopyFromData(&x_buf[0]);
+}
+
+void BlockILUPreconditioner::MoveToHostLocalData_()
+{
+}
+
+void BlockILUPreconditioner::MoveToAcceleratorLocalData_()
+{
+}
@@ -0,0 +1,40 @@
+#ifndef BLOCKILUPRECONDITIONER_H_
+#define BLOCKILUPRECONDITIONER_H_
+
+#include <vector>
+
+#include "paralution.hpp"
+#include "method/BlockMatrix.h"
+
+// Block ILU(0) over natural point blocks of the operator
+class BlockILUPreconditioner : public paralution::Preconditioner<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double>
+{
+protected:
+	int blockSize;
+	BaseBlockMatrix* mat;
+
+	std::vector<double> rhs_buf;
+	std::vector<double> x_buf;
+
+public:
+	BlockILUPreconditioner();
+	virtual ~BlockILUPreconditioner();
+
+	void Set(const int _blockSize);
+	// Builds the factorization from host scalar CSR arrays
+	void BuildFromCSR(const int size, const int* row, const int* col, const double* val);
+
+	virtual void Print() const;
+	virtual void Build();
+	virtual void Clear();
+	virtual void Solve(const paralution::LocalVector<double>& rhs, paralution::LocalVector<double>* x);
+
+	// Host CSR copy of paralution matrix
+	static void copyToHostCSR(const paralution::LocalMatrix<double>& src, std::vector<int>& row, std::vector<int>& col, std::vector<double>& val);
+
+protected:
+	virtual void MoveToHostLocalData_();
+	virtual void MoveToAcceleratorLocalData_();
+};
+
+#endif /* BLOCKILUPRECONDITIONER_H_ */
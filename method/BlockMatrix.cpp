@@ -0,0 +1,294 @@
+#include "method/BlockMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+using std::vector;
+
+// Dense bs x bs kernels, loops are unrolled by the compiler for fixed bs
+template <int bs>
+static inline void blockMultSub(const double* a, const double* b, double* c)
+{
+	for (int i = 0; i < bs; i++)
+		for (int k = 0; k < bs; k++)
+		{
+			const double aik = a[i * bs + k];
+			for (int j = 0; j < bs; j++)
+				c[i * bs + j] -= aik * b[k * bs + j];
+		}
+}
+
+template <int bs>
+static inline void blockMult(const double* a, const double* b, double* c)
+{
+	for (int i = 0; i < bs * bs; i++)
+		c[i] = 0.0;
+	for (int i = 0; i < bs; i++)
+		for (int k = 0; k < bs; k++)
+		{
+			const double aik = a[i * bs + k];
+			for (int j = 0; j < bs; j++)
+				c[i * bs + j] += aik * b[k * bs + j];
+		}
+}
+
+template <int bs>
+static inline void blockVecMultAdd(const double* a, const double* x, double* y)
+{
+	for (int i = 0; i < bs; i++)
+	{
+		double sum = 0.0;
+		for (int j = 0; j < bs; j++)
+			sum += a[i * bs + j] * x[j];
+		y[i] += sum;
+	}
+}
+
+template <int bs>
+static inline void blockVecMultSub(const double* a, const double* x, double* y)
+{
+	for (int i = 0; i < bs; i++)
+	{
+		double sum = 0.0;
+		for (int j = 0; j < bs; j++)
+			sum += a[i * bs + j] * x[j];
+		y[i] -= sum;
+	}
+}
+
+// Gauss-Jordan inversion with partial pivoting,
+// vanishing pivots are replaced to keep the factorization alive
+template <int bs>
+static inline void blockInverse(double* a)
+{
+	double inv[bs * bs];
+	for (int i = 0; i < bs; i++)
+		for (int j = 0; j < bs; j++)
+			inv[i * bs + j] = (i == j ? 1.0 : 0.0);
+
+	for (int l = 0; l < bs; l++)
+	{
+		int piv = l;
+		for (int i = l + 1; i < bs; i++)
+			if (fabs(a[i * bs + l]) > fabs(a[piv * bs + l]))
+				piv = i;
+		if (piv != l)
+			for (int j = 0; j < bs; j++)
+			{
+				std::swap(a[l * bs + j], a[piv * bs + j]);
+				std::swap(inv[l * bs + j], inv[piv * bs + j]);
+			}
+
+		if (fabs(a[l * bs + l]) < 1.E-30)
+			a[l * bs + l] = (a[l * bs + l] < 0.0 ? -1.E-30 : 1.E-30);
+
+		const double mult = 1.0 / a[l * bs + l];
+		for (int j = 0; j < bs; j++)
+		{
+			a[l * bs + j] *= mult;
+			inv[l * bs + j] *= mult;
+		}
+		for (int i = 0; i < bs; i++)
+		{
+			if (i == l)
+				continue;
+			const double f = a[i * bs + l];
+			for (int j = 0; j < bs; j++)
+			{
+				a[i * bs + j] -= f * a[l * bs + j];
+				inv[i * bs + j] -= f * inv[l * bs + j];
+			}
+		}
+	}
+
+	for (int i = 0; i < bs * bs; i++)
+		a[i] = inv[i];
+}
+
+template <int bs>
+BlockMatrix<bs>::BlockMatrix()
+{
+	blocksNum = 0;
+	isFactorized = false;
+}
+
+template <int bs>
+BlockMatrix<bs>::~BlockMatrix()
+{
+}
+
+template <int bs>
+void BlockMatrix<bs>::buildPattern(const int size, const vector<vector<int> >& nebrs)
+{
+	blocksNum = size / bs;
+	row.assign(blocksNum + 1, 0);
+	col.clear();
+	diag.assign(blocksNum, -1);
+
+	for (int i = 0; i < blocksNum; i++)
+	{
+		vector<int> cols = nebrs[i];
+		cols.push_back(i);
+		std::sort(cols.begin(), cols.end());
+		cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+
+		for (int k = 0; k < (int)cols.size(); k++)
+		{
+			if (cols[k] == i)
+				diag[i] = (int)col.size();
+			col.push_back(cols[k]);
+		}
+		row[i + 1] = (int)col.size();
+	}
+
+	val.assign(col.size() * bs * bs, 0.0);
+	isFactorized = false;
+}
+
+template <int bs>
+int BlockMatrix<bs>::findBlock(const int i, const int j) const
+{
+	const int* begin = &col[0] + row[i];
+	const int* end = &col[0] + row[i + 1];
+	const int* it = std::lower_bound(begin, end, j);
+	if (it != end && *it == j)
+		return (int)(it - &col[0]);
+	return -1;
+}
+
+template <int bs>
+void BlockMatrix<bs>::setFromCSR(const int size, const int* _row, const int* _col, const double* _val)
+{
+	vector<vector<int> > nebrs(size / bs);
+	for (int i = 0; i < size; i++)
+		for (int l = _row[i]; l < _row[i + 1]; l++)
+			nebrs[i / bs].push_back(_col[l] / bs);
+	buildPattern(size, nebrs);
+
+	for (int i = 0; i < size; i++)
+		for (int l = _row[i]; l < _row[i + 1]; l++)
+		{
+			const int k = findBlock(i / bs, _col[l] / bs);
+			val[k * bs * bs + (i % bs) * bs + _col[l] % bs] += _val[l];
+		}
+}
+
+template <int bs>
+void BlockMatrix<bs>::setPattern(const int size, const int* ind_i, const int* ind_j, const int counter, int* slots)
+{
+	vector<vector<int> > nebrs(size / bs);
+	for (int l = 0; l < counter; l++)
+		nebrs[ind_i[l] / bs].push_back(ind_j[l] / bs);
+	buildPattern(size, nebrs);
+
+	for (int l = 0; l < counter; l++)
+	{
+		const int k = findBlock(ind_i[l] / bs, ind_j[l] / bs);
+		slots[l] = k * bs * bs + (ind_i[l] % bs) * bs + ind_j[l] % bs;
+	}
+}
+
+template <int bs>
+void BlockMatrix<bs>::Apply(const double* x, double* y) const
+{
+	for (int i = 0; i < blocksNum; i++)
+	{
+		double* yi = y + i * bs;
+		for (int k = 0; k < bs; k++)
+			yi[k] = 0.0;
+		for (int l = row[i]; l < row[i + 1]; l++)
+			blockVecMultAdd<bs>(&val[l * bs * bs], x + col[l] * bs, yi);
+	}
+}
+
+template <int bs>
+void BlockMatrix<bs>::factorILU0()
+{
+	const int bs2 = bs * bs;
+	double tmp[bs * bs];
+	vector<int> marker(blocksNum, -1);
+
+	lu = val;
+
+	for (int i = 0; i < blocksNum; i++)
+	{
+		for (int l = row[i]; l < row[i + 1]; l++)
+			marker[col[l]] = l;
+
+		for (int l = row[i]; l < diag[i]; l++)
+		{
+			const int k = col[l];
+			// L_ik = A_ik * inv(U_kk)
+			blockMult<bs>(&lu[l * bs2], &lu[diag[k] * bs2], tmp);
+			for (int m = 0; m < bs2; m++)
+				lu[l * bs2 + m] = tmp[m];
+
+			// A_ij -= L_ik * U_kj for j in pattern of row i
+			for (int m = diag[k] + 1; m < row[k + 1]; m++)
+			{
+				const int pos = marker[col[m]];
+				if (pos >= 0)
+					blockMultSub<bs>(&lu[l * bs2], &lu[m * bs2], &lu[pos * bs2]);
+			}
+		}
+
+		blockInverse<bs>(&lu[diag[i] * bs2]);
+
+		for (int l = row[i]; l < row[i + 1]; l++)
+			marker[col[l]] = -1;
+	}
+
+	isFactorized = true;
+}
+
+template <int bs>
+void BlockMatrix<bs>::solveILU0(const double* rhs, double* x) const
+{
+	const int bs2 = bs * bs;
+	double tmp[bs];
+
+	// Forward substitution with unit-diagonal L
+	for (int i = 0; i < blocksNum; i++)
+	{
+		double* xi = x + i * bs;
+		for (int k = 0; k < bs; k++)
+			xi[k] = rhs[i * bs + k];
+		for (int l = row[i]; l < diag[i]; l++)
+			blockVecMultSub<bs>(&lu[l * bs2], x + col[l] * bs, xi);
+	}
+
+	// Backward substitution with inverted diagonal blocks
+	for (int i = blocksNum - 1; i >= 0; i--)
+	{
+		double* xi = x + i * bs;
+		for (int l = diag[i] + 1; l < row[i + 1]; l++)
+			blockVecMultSub<bs>(&lu[l * bs2], x + col[l] * bs, xi);
+		for (int k = 0; k < bs; k++)
+			tmp[k] = 0.0;
+		blockVecMultAdd<bs>(&lu[diag[i] * bs2], xi, tmp);
+		for (int k = 0; k < bs; k++)
+			xi[k] = tmp[k];
+	}
+}
+
+BaseBlockMatrix* createBlockMatrix(const int blockSize)
+{
+	switch (blockSize)
+	{
+	case 1:
+		return new BlockMatrix<1>();
+	case 2:
+		return new BlockMatrix<2>();
+	case 3:
+		return new BlockMatrix<3>();
+	case 4:
+		return new BlockMatrix<4>();
+	default:
+		return NULL;
+	}
+}
+
+template class BlockMatrix<1>;
+template class BlockMatrix<2>;
+template class BlockMatrix<3>;
+template class BlockMatrix<4>;
@@ -0,0 +1,71 @@
+#ifndef BLOCKMATRIX_H_
+#define BLOCKMATRIX_H_
+
+#include <vector>
+
+// Block compressed sparse row matrix interface for runtime chosen block size
+class BaseBlockMatrix
+{
+public:
+	virtual ~BaseBlockMatrix() {};
+
+	virtual int getBlockSize() const = 0;
+	virtual int getBlocksNum() const = 0;
+	virtual int getNonZeroBlocksNum() const = 0;
+
+	// Pattern and values from scalar CSR arrays
+	virtual void setFromCSR(const int size, const int* row, const int* col, const double* val) = 0;
+	// Pattern from scalar elements in filling order, slots[k] is the position of k-th element in values
+	virtual void setPattern(const int size, const int* ind_i, const int* ind_j, const int counter, int* slots) = 0;
+	// bs x bs row-major blocks in pattern order, elements are accumulated there by slots
+	virtual double* getValues() = 0;
+	virtual int getValuesNum() const = 0;
+	// y = A * x
+	virtual void Apply(const double* x, double* y) const = 0;
+	// Block ILU(0) with the same block pattern
+	virtual void factorILU0() = 0;
+	virtual void solveILU0(const double* rhs, double* x) const = 0;
+};
+
+template <int bs>
+class BlockMatrix : public BaseBlockMatrix
+{
+protected:
+	int blocksNum;
+
+	// Block rows offsets, block columns and bs x bs row-major blocks
+	std::vector<int> row;
+	std::vector<int> col;
+	std::vector<double> val;
+	// Position of diagonal block in each block row
+	std::vector<int> diag;
+
+	// Factors of block ILU(0): strictly lower part is unit-diagonal L,
+	// diagonal blocks are stored inverted
+	std::vector<double> lu;
+	bool isFactorized;
+
+	void buildPattern(const int size, const std::vector<std::vector<int> >& nebrs);
+	int findBlock(const int i, const int j) const;
+
+public:
+	BlockMatrix();
+	~BlockMatrix();
+
+	int getBlockSize() const { return bs; };
+	int getBlocksNum() const { return blocksNum; };
+	int getNonZeroBlocksNum() const { return (int)col.size(); };
+
+	void setFromCSR(const int size, const int* row, const int* col, const double* val);
+	void setPattern(const int size, const int* ind_i, const int* ind_j, const int counter, int* slots);
+	double* getValues() { return &val[0]; };
+	int getValuesNum() const { return (int)val.size(); };
+	void Apply(const double* x, double* y) const;
+	void factorILU0();
+	void solveILU0(const double* rhs, double* x) const;
+};
+
+// Block sizes from 1 to 4 are supported, NULL otherwise
+BaseBlockMatrix* createBlockMatrix(const int blockSize);
+
+#endif /* BLOCKMATRIX_H_ */
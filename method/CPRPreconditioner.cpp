@@ -0,0 +1,266 @@
+#include "method/CPRPreconditioner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace paralution;
+using std::vector;
+using std::cout;
+using std::endl;
+
+CPRPreconditioner::CPRPreconditioner()
+{
+	blockSize = 2;
+	blocksNum = 0;
+	presSolverType = CPR_PRES_AMG;
+	presCycles = 1;
+	presFill = 1;
+	isBuilt = false;
+}
+
+CPRPreconditioner::~CPRPreconditioner()
+{
+	Clear();
+}
+
+void CPRPreconditioner::Set(const int _blockSize, const int _presSolverType, const int _presCycles, const int _presFill)
+{
+	blockSize = _blockSize;
+	presSolverType = _presSolverType;
+	presCycles = _presCycles;
+	presFill = _presFill;
+}
+
+void CPRPreconditioner::Print() const
+{
+	cout << "CPR preconditioner: block size = " << blockSize << ", pressure stage = ";
+	cout << (presSolverType == CPR_PRES_AMG ? "AMG" : "ILU") << ", smoother = block ILU(0)" << endl;
+}
+
+void CPRPreconditioner::setWeights(const int* row, const int* col, const double* val)
+{
+	const int bs = blockSize;
+	vector<double> diag(bs * bs);
+
+	weights.assign(blocksNum * bs, 0.0);
+	for (int k = 0; k < blocksNum; k++)
+	{
+		// Transposed diagonal block
+		for (int i = 0; i < bs; i++)
+		{
+			for (int j = 0; j < bs; j++)
+				diag[j * bs + i] = 0.0;
+			for (int l = row[k * bs + i]; l < row[k * bs + i + 1]; l++)
+				if (col[l] / bs == k)
+					diag[(col[l] % bs) * bs + i] = val[l];
+		}
+
+		// Solving D^T * w = e_0 with partial pivoting
+		double* w = &weights[k * bs];
+		w[0] = 1.0;
+		bool isSingular = false;
+		for (int l = 0; l < bs; l++)
+		{
+			int piv = l;
+			for (int i = l + 1; i < bs; i++)
+				if (fabs(diag[i * bs + l]) > fabs(diag[piv * bs + l]))
+					piv = i;
+			if (fabs(diag[piv * bs + l]) < 1.E-30)
+			{
+				isSingular = true;
+				break;
+			}
+			if (piv != l)
+			{
+				for (int j = 0; j < bs; j++)
+					std::swap(diag[l * bs + j], diag[piv * bs + j]);
+				std::swap(w[l], w[piv]);
+			}
+			for (int i = l + 1; i < bs; i++)
+			{
+				const double mult = diag[i * bs + l] / diag[l * bs + l];
+				for (int j = l; j < bs; j++)
+					diag[i * bs + j] -= mult * diag[l * bs + j];
+				w[i] -= mult * w[l];
+			}
+		}
+		if (!isSingular)
+		{
+			for (int i = bs - 1; i >= 0; i--)
+			{
+				for (int j = i + 1; j < bs; j++)
+					w[i] -= diag[i * bs + j] * w[j];
+				w[i] /= diag[i * bs + i];
+			}
+		}
+
+		// Normalization to the unit pressure weight
+		if (isSingular || fabs(w[0]) < 1.E-30)
+		{
+			w[0] = 1.0;
+			for (int i = 1; i < bs; i++)
+				w[i] = 0.0;
+		} else {
+			const double norm = w[0];
+			for (int i = 0; i < bs; i++)
+				w[i] /= norm;
+		}
+	}
+}
+
+void CPRPreconditioner::buildPresMatrix(const int* row, const int* col, const double* val)
+{
+	const int bs = blockSize;
+	vector<int> pres_row(blocksNum + 1, 0);
+	vector<int> pres_col;
+	vector<double> pres_val;
+	vector<int> marker(blocksNum, -1);
+
+	pres_col.reserve(row[blocksNum * bs] / (bs * bs) + blocksNum);
+	pres_val.reserve(row[blocksNum * bs] / (bs * bs) + blocksNum);
+
+	for (int k = 0; k < blocksNum; k++)
+	{
+		const int start = (int)pres_col.size();
+		for (int i = 0; i < bs; i++)
+		{
+			const double w = weights[k * bs + i];
+			if (w == 0.0)
+				continue;
+			for (int l = row[k * bs + i]; l < row[k * bs + i + 1]; l++)
+			{
+				if (col[l] % bs != 0)
+					continue;
+				const int j = col[l] / bs;
+				if (marker[j] < start)
+				{
+					marker[j] = (int)pres_col.size();
+					pres_col.push_back(j);
+					pres_val.push_back(w * val[l]);
+				} else
+					pres_val[marker[j]] += w * val[l];
+			}
+		}
+		pres_row[k + 1] = (int)pres_col.size();
+	}
+
+	presMat.Clear();
+	presMat.AllocateCSR("pressure", (int)pres_col.size(), blocksNum, blocksNum);
+	presMat.CopyFromCSR(&pres_row[0], &pres_col[0], &pres_val[0]);
+}
+
+void CPRPreconditioner::Build()
+{
+	if (isBuilt)
+		Clear();
+
+	const int size = this->op_->get_nrow();
+	blocksNum = size / blockSize;
+
+	// Host copy of the operator in CSR format
+	vector<int> row, col;
+	vector<double> val;
+	BlockILUPreconditioner::copyToHostCSR(*this->op_, row, col, val);
+
+	setWeights(&row[0], &col[0], &val[0]);
+	buildPresMatrix(&row[0], &col[0], &val[0]);
+
+	presMat.CloneBackend(*this->op_);
+	presRhs.CloneBackend(*this->op_);
+	presSol.CloneBackend(*this->op_);
+	presRhs.Allocate("pressure rhs", blocksNum);
+	presSol.Allocate("pressure solution", blocksNum);
+
+	if (presSolverType == CPR_PRES_AMG)
+	{
+		amg.SetOperator(presMat);
+		amg.Verbose(0);
+		amg.Build();
+		// Fixed number of V-cycles keeps the preconditioner linear
+		amg.Init(0.0, 0.0, 1E+8, presCycles);
+	} else {
+		presIlu.Set(presFill);
+		presIlu.SetOperator(presMat);
+		presIlu.Build();
+	}
+
+	ilu.Set(blockSize);
+	ilu.BuildFromCSR(size, &row[0], &col[0], &val[0]);
+
+	prolong.CloneBackend(*this->op_);
+	res.CloneBackend(*this->op_);
+	prolong.Allocate("prolongation", size);
+	res.Allocate("residual", size);
+
+	isBuilt = true;
+	this->build_ = true;
+}
+
+void CPRPreconditioner::Clear()
+{
+	if (!isBuilt)
+		return;
+
+	amg.Clear();
+	presIlu.Clear();
+	ilu.Clear();
+	presMat.Clear();
+	presRhs.Clear();
+	presSol.Clear();
+	prolong.Clear();
+	res.Clear();
+	weights.clear();
+
+	isBuilt = false;
+	this->build_ = false;
+}
+
+void CPRPreconditioner::Solve(const LocalVector<double>& rhs, LocalVector<double>* x)
+{
+	const int bs = blockSize;
+
+	// Restriction of the residual to the pressure equation
+	for (int k = 0; k < blocksNum; k++)
+	{
+		double sum = 0.0;
+		for (int i = 0; i < bs; i++)
+			sum += weights[k * bs + i] * rhs[k * bs + i];
+		presRhs[k] = sum;
+	}
+
+	presSol.Zeros();
+	if (presSolverType == CPR_PRES_AMG)
+		amg.Solve(presRhs, &presSol);
+	else
+		presIlu.Solve(presRhs, &presSol);
+
+	// Prolongation of the pressure correction
+	prolong.Zeros();
+	for (int k = 0; k < blocksNum; k++)
+		prolong[k * bs] = presSol[k];
+
+	// Smoothing of the remaining residual over the full system
+	this->op_->Apply(prolong, &res);
+	res.ScaleAdd(-1.0, rhs);
+	ilu.Solve(res, x);
+	x->AddScale(prolong, 1.0);
+}
+
+void CPRPreconditioner::MoveToHostLocalData_()
+{
+	presMat.MoveToHost();
+	presRhs.MoveToHost();
+	presSol.MoveToHost();
+	prolong.MoveToHost();
+	res.MoveToHost();
+}
+
+void CPRPreconditioner::MoveToAcceleratorLocalData_()
+{
+	presMat.MoveToAccelerator();
+	presRhs.MoveToAccelerator();
+	presSol.MoveToAccelerator();
+	prolong.MoveToAccelerator();
+	res.MoveToAccelerator();
+}
@@ -0,0 +1,58 @@
+#ifndef CPRPRECONDITIONER_H_
+#define CPRPRECONDITIONER_H_
+
+#include <vector>
+
+#include "paralution.hpp"
+#include "method/BlockILUPreconditioner.h"
+
+#define CPR_PRES_AMG 0
+#define CPR_PRES_ILU 1
+
+// Two-stage constrained pressure residual preconditioner
+// for point-block systems with pressure as the first variable of each block
+class CPRPreconditioner : public paralution::Preconditioner<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double>
+{
+protected:
+	int blockSize;
+	int blocksNum;
+
+	// Pressure stage
+	int presSolverType;
+	int presCycles;
+	int presFill;
+	paralution::LocalMatrix<double> presMat;
+	paralution::LocalVector<double> presRhs;
+	paralution::LocalVector<double> presSol;
+	paralution::AMG<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double> amg;
+	paralution::ILU<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double> presIlu;
+
+	// Smoothing stage
+	BlockILUPreconditioner ilu;
+	paralution::LocalVector<double> prolong;
+	paralution::LocalVector<double> res;
+
+	// Quasi-IMPES decoupling weights
+	std::vector<double> weights;
+	void setWeights(const int* row, const int* col, const double* val);
+	void buildPresMatrix(const int* row, const int* col, const double* val);
+
+	bool isBuilt;
+
+public:
+	CPRPreconditioner();
+	virtual ~CPRPreconditioner();
+
+	void Set(const int _blockSize, const int _presSolverType = CPR_PRES_AMG, const int _presCycles = 1, const int _presFill = 1);
+
+	virtual void Print() const;
+	virtual void Build();
+	virtual void Clear();
+	virtual void Solve(const paralution::LocalVector<double>& rhs, paralution::LocalVector<double>* x);
+
+protected:
+	virtual void MoveToHostLocalData_();
+	virtual void MoveToAcceleratorLocalData_();
+};
+
+#endif /* CPRPRECONDITIONER_H_ */
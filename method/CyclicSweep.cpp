@@ -0,0 +1,285 @@
+#include "method/CyclicSweep.h"
+
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using std::vector;
+
+// LU with partial pivoting of n x n row-major matrix in place
+static void luFactor(double* a, int* piv, const int n)
+{
+	int p;
+	double maxVal, l;
+
+	for (int k = 0; k < n; k++)
+	{
+		p = k;
+		maxVal = fabs(a[k * n + k]);
+		for (int i = k + 1; i < n; i++)
+			if (fabs(a[i * n + k]) > maxVal)
+			{
+				maxVal = fabs(a[i * n + k]);
+				p = i;
+			}
+		piv[k] = p;
+		if (p != k)
+			for (int j = 0; j < n; j++)
+				std::swap(a[k * n + j], a[p * n + j]);
+
+		for (int i = k + 1; i < n; i++)
+		{
+			l = a[i * n + k] /= a[k * n + k];
+			if (l == 0.0)
+				continue;
+			for (int j = k + 1; j < n; j++)
+				a[i * n + j] -= l * a[k * n + j];
+		}
+	}
+}
+
+// Solves LU * x = b for nrhs columns of n x nrhs row-major b in place
+static void luSolve(const double* lu, const int* piv, const int n, double* b, const int nrhs)
+{
+	double l;
+
+	for (int k = 0; k < n; k++)
+		if (piv[k] != k)
+			for (int j = 0; j < nrhs; j++)
+				std::swap(b[k * nrhs + j], b[piv[k] * nrhs + j]);
+
+	for (int k = 0; k < n; k++)
+	{
+		for (int i = k + 1; i < n; i++)
+		{
+			l = lu[i * n + k];
+			if (l == 0.0)
+				continue;
+			for (int j = 0; j < nrhs; j++)
+				b[i * nrhs + j] -= l * b[k * nrhs + j];
+		}
+	}
+	for (int k = n - 1; k >= 0; k--)
+	{
+		for (int j = 0; j < nrhs; j++)
+			b[k * nrhs + j] /= lu[k * n + k];
+		for (int i = 0; i < k; i++)
+		{
+			l = lu[i * n + k];
+			if (l == 0.0)
+				continue;
+			for (int j = 0; j < nrhs; j++)
+				b[i * nrhs + j] -= l * b[k * nrhs + j];
+		}
+	}
+}
+
+// c -= a * b, where a is n x n and b, c are n x m, all row-major with given leading dimensions
+static void mulSub(double* c, const int ldc, const double* a, const int lda, const double* b, const int ldb, const int n, const int m)
+{
+	double aik;
+
+	for (int i = 0; i < n; i++)
+		for (int k = 0; k < n; k++)
+		{
+			aik = a[i * lda + k];
+			if (aik == 0.0)
+				continue;
+			for (int j = 0; j < m; j++)
+				c[i * ldc + j] -= aik * b[k * ldb + j];
+		}
+}
+
+CyclicSweep::CyclicSweep() : BandSweep()
+{
+	cyclicMinNodes = CYCLIC_MIN_NODES;
+	isCyclicSolve = false;
+	bs = blocksNum = 0;
+}
+
+CyclicSweep::~CyclicSweep()
+{
+}
+
+void CyclicSweep::setCyclicReduction(const int minNodes)
+{
+	cyclicMinNodes = minNodes;
+}
+
+void CyclicSweep::construction_bz(int num_eq, int flag)
+{
+	// Sequential sweep still needs bz
+	if (!isCyclicSolve)
+		Sweep::construction_bz(num_eq, flag);
+}
+
+void CyclicSweep::fillBlocks(const int MZ, const int NX)
+{
+	const int bs2 = bs * bs;
+	int node, sr, sc, lr, lc;
+
+	L.assign(blocksNum * bs2, 0.0);
+	D.assign(blocksNum * bs2, 0.0);
+	U.assign(blocksNum * bs2, 0.0);
+	f.assign(blocksNum * bs, 0.0);
+	xs.assign(blocksNum * bs, 0.0);
+	X.assign(blocksNum * bs * (2 * bs + 1), 0.0);
+	piv.assign(blocksNum * bs, 0);
+
+	// Odd number of nodes: second half of the last block is identity
+	if (NX % 2 == 1)
+		for (int i = MZ; i < bs; i++)
+			D[(blocksNum - 1) * bs2 + i * bs + i] = 1.0;
+
+	for (int k = 0; k < (int)a.size(); k++)
+	{
+		node = ind_i[k] / MZ;
+		sr = node / 2;
+		lr = (node % 2) * MZ + ind_i[k] % MZ;
+		node = ind_j[k] / MZ;
+		sc = node / 2;
+		lc = (node % 2) * MZ + ind_j[k] % MZ;
+
+		if (sc == sr)
+			D[sr * bs2 + lr * bs + lc] += a[k];
+		else if (sc == sr - 1)
+			L[sr * bs2 + lr * bs + lc] += a[k];
+		else
+			U[sr * bs2 + lr * bs + lc] += a[k];
+	}
+	for (int r = 0; r < NX * MZ; r++)
+	{
+		node = r / MZ;
+		f[(node / 2) * bs + (node % 2) * MZ + r % MZ] = rhs[r];
+	}
+}
+
+void CyclicSweep::eliminate(const int j)
+{
+	const int bs2 = bs * bs;
+	const int ld = 2 * bs + 1;
+	double* xj = &X[j * bs * ld];
+
+	for (int i = 0; i < bs; i++)
+	{
+		memcpy(xj + i * ld, &L[j * bs2 + i * bs], sizeof(double) * bs);
+		memcpy(xj + i * ld + bs, &U[j * bs2 + i * bs], sizeof(double) * bs);
+		xj[i * ld + 2 * bs] = f[j * bs + i];
+	}
+
+	luFactor(&D[j * bs2], &piv[j * bs], bs);
+	luSolve(&D[j * bs2], &piv[j * bs], bs, xj, ld);
+}
+
+void CyclicSweep::reduce(const int i, const int s)
+{
+	const int bs2 = bs * bs;
+	const int ld = 2 * bs + 1;
+	vector<double> tmp(bs2, 0.0);
+	double* li = &L[i * bs2];
+	double* ui = &U[i * bs2];
+	const double* xj;
+
+	// Lower neighbour always exists for the kept blocks
+	xj = &X[(i - s) * bs * ld];
+	mulSub(&D[i * bs2], bs, li, bs, xj + bs, ld, bs, bs);
+	mulSub(&f[i * bs], 1, li, bs, xj + 2 * bs, ld, bs, 1);
+	mulSub(&tmp[0], bs, li, bs, xj, ld, bs, bs);
+	memcpy(li, &tmp[0], sizeof(double) * bs2);
+
+	std::fill(tmp.begin(), tmp.end(), 0.0);
+	if (i + s < blocksNum)
+	{
+		xj = &X[(i + s) * bs * ld];
+		mulSub(&D[i * bs2], bs, ui, bs, xj, ld, bs, bs);
+		mulSub(&f[i * bs], 1, ui, bs, xj + 2 * bs, ld, bs, 1);
+		mulSub(&tmp[0], bs, ui, bs, xj + bs, ld, bs, bs);
+	}
+	memcpy(ui, &tmp[0], sizeof(double) * bs2);
+}
+
+void CyclicSweep::solveBack(const int j, const int s)
+{
+	const int ld = 2 * bs + 1;
+	const double* xj = &X[j * bs * ld];
+	double* x = &xs[j * bs];
+
+	for (int i = 0; i < bs; i++)
+		x[i] = xj[i * ld + 2 * bs];
+	if (j - s >= 0)
+		mulSub(x, 1, xj, ld, &xs[(j - s) * bs], 1, bs, 1);
+	if (j + s < blocksNum)
+		mulSub(x, 1, xj + bs, ld, &xs[(j + s) * bs], 1, bs, 1);
+}
+
+void CyclicSweep::reduction()
+{
+	int s, num;
+
+	levels.clear();
+	for (s = 1; blocksNum / s > 1; s *= 2)
+	{
+		// Blocks s-1, 3s-1, ... are eliminated, 2s-1, 4s-1, ... are kept
+		num = (blocksNum + s) / (2 * s);
+		#pragma omp parallel for schedule(static)
+		for (int k = 0; k < num; k++)
+			eliminate(s - 1 + 2 * s * k);
+
+		num = blocksNum / (2 * s);
+		#pragma omp parallel for schedule(static)
+		for (int k = 0; k < num; k++)
+			reduce(2 * s - 1 + 2 * s * k, s);
+
+		levels.push_back(s);
+	}
+
+	// The only block left
+	const int r = s - 1;
+	luFactor(&D[r * bs * bs], &piv[r * bs], bs);
+	memcpy(&xs[r * bs], &f[r * bs], sizeof(double) * bs);
+	luSolve(&D[r * bs * bs], &piv[r * bs], bs, &xs[r * bs], 1);
+
+	for (int l = (int)levels.size() - 1; l >= 0; l--)
+	{
+		s = levels[l];
+		num = (blocksNum + s) / (2 * s);
+		#pragma omp parallel for schedule(static)
+		for (int k = 0; k < num; k++)
+			solveBack(s - 1 + 2 * s * k, s);
+	}
+}
+
+void CyclicSweep::Solve(int NZ, int MZ, int key)
+{
+	const int NX = NZ + 1;
+	int threads = 1;
+#ifdef _OPENMP
+	threads = omp_get_max_threads();
+#endif
+
+	if (cyclicMinNodes > 0 && NX >= cyclicMinNodes && threads > 1)
+		solveCyclic(NZ, MZ, key);
+	else
+		Sweep::Solve(NZ, MZ, key);
+}
+
+void CyclicSweep::solveCyclic(int NZ, int MZ, int key)
+{
+	const int NX = NZ + 1;
+
+	isCyclicSolve = true;
+	assemble(NZ, MZ, key);
+
+	bs = 2 * MZ;
+	blocksNum = (NX + 1) / 2;
+	fillBlocks(MZ, NX);
+	reduction();
+
+	for (int n = 0; n < NX; n++)
+		for (int e = 0; e < MZ; e++)
+			fz[n][e + 1] = xs[(n / 2) * bs + (n % 2) * MZ + e];
+
+	isCyclicSolve = false;
+}
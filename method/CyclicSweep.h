@@ -0,0 +1,55 @@
+#ifndef CYCLICSWEEP_H_
+#define CYCLICSWEEP_H_
+
+#include <vector>
+
+#include "method/BandSweep.h"
+
+// Number of radial nodes starting from which cyclic reduction is used by default
+#define CYCLIC_MIN_NODES 1024
+
+// Sweep with parallel block cyclic reduction for long radial grids.
+// Boundary rows couple three nodes, so nodes are paired into blocks of 2 * MZ unknowns
+// to get a block-tridiagonal system. Each reduction level eliminates every second block
+// and runs in parallel over the blocks. Short grids or a single thread use the sequential Sweep::Solve.
+// There is no pivoting between blocks, so diagonal blocks are assumed to be non-singular.
+class CyclicSweep : public BandSweep
+{
+protected:
+	int cyclicMinNodes;
+	bool isCyclicSolve;
+
+	// Block size & number of paired blocks
+	int bs;
+	int blocksNum;
+	// Sub-, main and super-diagonal bs x bs row-major blocks, right side & solution
+	std::vector<double> L;
+	std::vector<double> D;
+	std::vector<double> U;
+	std::vector<double> f;
+	std::vector<double> xs;
+	// D^-1 [L | U | f] of eliminated blocks, bs x (2 * bs + 1)
+	std::vector<double> X;
+	std::vector<int> piv;
+	// Strides of reduction levels
+	std::vector<int> levels;
+
+	void fillBlocks(const int MZ, const int NX);
+	void eliminate(const int j);
+	void reduce(const int i, const int s);
+	void solveBack(const int j, const int s);
+	void reduction();
+	// Cyclic reduction path of Solve regardless of grid size & threads
+	void solveCyclic(int NZ, int MZ, int key);
+
+public:
+	CyclicSweep();
+	~CyclicSweep();
+
+	void Solve(int NZ, int MZ, int key);
+	void construction_bz(int num_eq, int flag);
+	// Cyclic reduction for grids of at least minNodes nodes, non-positive value disables it
+	void setCyclicReduction(const int minNodes);
+};
+
+#endif /* CYCLICSWEEP_H_ */
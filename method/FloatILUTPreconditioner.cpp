@@ -0,0 +1,98 @@
+#include "method/FloatILUTPreconditioner.h"
+#include "method/BlockILUPreconditioner.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace paralution;
+using std::vector;
+using std::cout;
+using std::endl;
+
+FloatILUTPreconditioner::FloatILUTPreconditioner()
+{
+	tol = 1.E-10;
+	maxRow = 1000;
+	isBuilt = false;
+}
+
+FloatILUTPreconditioner::~FloatILUTPreconditioner()
+{
+	Clear();
+}
+
+void FloatILUTPreconditioner::Set(const double _tol, const int _maxRow)
+{
+	tol = _tol;
+	maxRow = _maxRow;
+}
+
+void FloatILUTPreconditioner::Print() const
+{
+	cout << "Single precision ILUT preconditioner: tolerance = " << tol << ", maximal row fill = " << maxRow << endl;
+}
+
+void FloatILUTPreconditioner::Build()
+{
+	if (isBuilt)
+		Clear();
+
+	const int size = this->op_->get_nrow();
+
+	// Rounded host copy of the operator
+	vector<int> row, col;
+	vector<double> val;
+	BlockILUPreconditioner::copyToHostCSR(*this->op_, row, col, val);
+	const vector<float> valFloat(val.begin(), val.end());
+
+	mat.AllocateCSR("float operator", (int)valFloat.size(), size, size);
+	mat.CopyFromCSR(&row[0], &col[0], &valFloat[0]);
+	mat.CloneBackend(*this->op_);
+	rhsFloat.CloneBackend(*this->op_);
+	solFloat.CloneBackend(*this->op_);
+	rhsFloat.Allocate("float rhs", size);
+	solFloat.Allocate("float solution", size);
+
+	ilut.Set((float)tol, maxRow);
+	ilut.SetOperator(mat);
+	ilut.Build();
+
+	isBuilt = true;
+	this->build_ = true;
+}
+
+void FloatILUTPreconditioner::Clear()
+{
+	if (!isBuilt)
+		return;
+
+	ilut.Clear();
+	mat.Clear();
+	rhsFloat.Clear();
+	solFloat.Clear();
+
+	isBuilt = false;
+	this->build_ = false;
+}
+
+void FloatILUTPreconditioner::Solve(const LocalVector<double>& rhs, LocalVector<double>* x)
+{
+	rhsFloat.CopyFromDouble(rhs);
+	solFloat.Zeros();
+	ilut.Solve(rhsFloat, &solFloat);
+	x->CopyFromFloat(solFloat);
+}
+
+void FloatILUTPreconditioner::MoveToHostLocalData_()
+{
+	mat.MoveToHost();
+	rhsFloat.MoveToHost();
+	solFloat.MoveToHost();
+}
+
+void FloatILUTPreconditioner::MoveToAcceleratorLocalData_()
+{
+	mat.MoveToAccelerator();
+	rhsFloat.MoveToAccelerator();
+	solFloat.MoveToAccelerator();
+}
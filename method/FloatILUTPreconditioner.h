@@ -0,0 +1,37 @@
+#ifndef FLOATILUTPRECONDITIONER_H_
+#define FLOATILUTPRECONDITIONER_H_
+
+#include "paralution.hpp"
+
+// ILUT preconditioner with factors stored in single precision,
+// vectors are converted at each application, so the outer Krylov solver stays in double precision
+class FloatILUTPreconditioner : public paralution::Preconditioner<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double>
+{
+protected:
+	double tol;
+	int maxRow;
+
+	paralution::LocalMatrix<float> mat;
+	paralution::LocalVector<float> rhsFloat;
+	paralution::LocalVector<float> solFloat;
+	paralution::ILUT<paralution::LocalMatrix<float>, paralution::LocalVector<float>, float> ilut;
+
+	bool isBuilt;
+
+public:
+	FloatILUTPreconditioner();
+	virtual ~FloatILUTPreconditioner();
+
+	void Set(const double _tol, const int _maxRow);
+
+	virtual void Print() const;
+	virtual void Build();
+	virtual void Clear();
+	virtual void Solve(const paralution::LocalVector<double>& rhs, paralution::LocalVector<double>* x);
+
+protected:
+	virtual void MoveToHostLocalData_();
+	virtual void MoveToAcceleratorLocalData_();
+};
+
+#endif /* FLOATILUTPRECONDITIONER_H_ */
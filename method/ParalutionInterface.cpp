@@ -1,49 +1,538 @@
 #include "method/ParalutionInterface.h"
+#include "method/mcmath.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
 
 using namespace paralution;
 using std::ifstream;
+using std::istringstream;
+using std::string;
 using std::cout;
 using std::endl;
+using std::vector;
 
-ParSolver::ParSolver() : resHistoryFile("snaps/resHistory.dat")
+typedef std::chrono::steady_clock Clock;
+
+static double getSeconds(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Krylov operator over the assembled block CSR matrix
+class BlockMatrixOperator : public JacobianOperator
+{
+protected:
+	const BaseBlockMatrix& mat;
+public:
+	BlockMatrixOperator(const BaseBlockMatrix& _mat) : mat(_mat) {};
+	void applyJacobian(const double* v, double* y) { mat.Apply(v, y); };
+};
+
+// Krylov operator over the assembled CSR matrix
+class CSRMatrixOperator : public JacobianOperator
+{
+protected:
+	const LocalMatrix<double>& mat;
+	LocalVector<double> in, out;
+public:
+	CSRMatrixOperator(const LocalMatrix<double>& _mat, const int size) : mat(_mat)
+	{
+		in.Allocate("in", size);
+		out.Allocate("out", size);
+	};
+	void applyJacobian(const double* v, double* y)
+	{
+		in.MoveToHost();
+		in.CopyFromData(v);
+		in.MoveToAccelerator();
+		out.MoveToAccelerator();
+		mat.Apply(in, &out);
+		out.MoveToHost();
+		out.CopyToData(y);
+	};
+};
+
+ParSolverStats::ParSolverStats()
+{
+	reset();
+}
+
+void ParSolverStats::reset()
+{
+	solvesNum = buildsNum = 0;
+	iterNum = maxIterNum = 0;
+	initRes = finalRes = 0.0;
+	setupTime = solveTime = 0.0;
+}
+
+void ParSolverStats::print(const string& title) const
+{
+	cout << title << ": solves = " << solvesNum << ", builds = " << buildsNum;
+	cout << ", iterations = " << iterNum << " (max " << maxIterNum << ")";
+	cout << ", setup = " << setupTime << " s, solve = " << solveTime << " s";
+	cout << ", last residual " << initRes << " -> " << finalRes << endl;
+}
+
+ParSolverConfig::ParSolverConfig()
+{
+	method = SOLVER_GMRES;
+	restart = 30;
+	absTol = 1.E-15;
+	relTol = 1.E-10;
+	divTol = 1.E+4;
+	maxIter = 5000;
+
+	precond = PRECOND_ILUT;
+	blockSize = 1;
+	ilutTol = 1.E-10;
+	ilutMaxRow = 1000;
+	precision = PRECISION_DOUBLE;
+	innerRelTol = 1.E-2;
+	innerMaxIter = 100;
+	cprPres = CPR_PRES_AMG;
+	fillLevel = 1;
+
+	rebuildFreq = 10;
+	blowUpRatio = 3.0;
+
+	isInexactNewton = false;
+	ewGamma = 0.9;
+	ewAlpha = 2.0;
+	ewEta0 = 1.E-2;
+	ewEtaMax = 1.E-1;
+
+	isWarmStart = false;
+	recycleSize = 0;
+
+	isJFNK = false;
+
+	isVerbose = false;
+}
+
+ParSolverConfig::ParSolverConfig(const int _precond, const int _blockSize) : ParSolverConfig()
+{
+	precond = _precond;
+	blockSize = _blockSize;
+}
+
+// Whole value has to be a number
+static bool parseInt(const string& value, int& result)
+{
+	char* end;
+	const long num = strtol(value.c_str(), &end, 10);
+	if (end == value.c_str() || *end != '\0')
+		return false;
+	result = (int)num;
+	return true;
+}
+
+static bool parseDouble(const string& value, double& result)
+{
+	char* end;
+	const double num = strtod(value.c_str(), &end);
+	if (end == value.c_str() || *end != '\0')
+		return false;
+	result = num;
+	return true;
+}
+
+static bool parseBool(const string& value, bool& result)
+{
+	if (value == "1" || value == "true")
+		result = true;
+	else if (value == "0" || value == "false")
+		result = false;
+	else
+		return false;
+	return true;
+}
+
+bool ParSolverConfig::load(const string& fileName)
+{
+	ifstream file;
+	file.open(fileName.c_str(), ifstream::in);
+	if (!file.is_open())
+	{
+		cout << "Solver config " << fileName << " is not found" << endl;
+		return false;
+	}
+
+	// Settings are applied only if the whole file is valid
+	ParSolverConfig conf = *this;
+	bool isValid = true;
+	string line, name, value;
+	while (getline(file, line))
+	{
+		line = line.substr(0, line.find('#'));
+		istringstream str(line);
+		if (!(str >> name >> value))
+			continue;
+
+		// Becomes false for unknown names & malformed values
+		bool isParsed = true;
+		if (name == "method")
+		{
+			if (value == "gmres")
+				conf.method = SOLVER_GMRES;
+			else if (value == "bicgstab")
+				conf.method = SOLVER_BICGSTAB;
+			else
+				isParsed = false;
+		}
+		else if (name == "restart")
+			isParsed = parseInt(value, conf.restart);
+		else if (name == "abs_tol")
+			isParsed = parseDouble(value, conf.absTol);
+		else if (name == "rel_tol")
+			isParsed = parseDouble(value, conf.relTol);
+		else if (name == "div_tol")
+			isParsed = parseDouble(value, conf.divTol);
+		else if (name == "max_iter")
+			isParsed = parseInt(value, conf.maxIter);
+		else if (name == "precond")
+		{
+			if (value == "ilut")
+				conf.precond = PRECOND_ILUT;
+			else if (value == "cpr")
+				conf.precond = PRECOND_CPR;
+			else if (value == "bilu0")
+				conf.precond = PRECOND_BILU0;
+			else if (value == "amg")
+				conf.precond = PRECOND_AMG;
+			else
+				isParsed = false;
+		}
+		else if (name == "block_size")
+			isParsed = parseInt(value, conf.blockSize);
+		else if (name == "ilut_tol")
+			isParsed = parseDouble(value, conf.ilutTol);
+		else if (name == "ilut_max_row")
+			isParsed = parseInt(value, conf.ilutMaxRow);
+		else if (name == "precision")
+		{
+			if (value == "double")
+				conf.precision = PRECISION_DOUBLE;
+			else if (value == "single_precond")
+				conf.precision = PRECISION_SINGLE_PRECOND;
+			else if (value == "single_krylov")
+				conf.precision = PRECISION_SINGLE_KRYLOV;
+			else
+				isParsed = false;
+		}
+		else if (name == "inner_rel_tol")
+			isParsed = parseDouble(value, conf.innerRelTol);
+		else if (name == "inner_max_iter")
+			isParsed = parseInt(value, conf.innerMaxIter);
+		else if (name == "cpr_pres")
+		{
+			if (value == "amg")
+				conf.cprPres = CPR_PRES_AMG;
+			else if (value == "ilu")
+				conf.cprPres = CPR_PRES_ILU;
+			else
+				isParsed = false;
+		}
+		else if (name == "fill_level")
+			isParsed = parseInt(value, conf.fillLevel);
+		else if (name == "rebuild_freq")
+			isParsed = parseInt(value, conf.rebuildFreq);
+		else if (name == "blow_up_ratio")
+			isParsed = parseDouble(value, conf.blowUpRatio);
+		else if (name == "inexact_newton")
+			isParsed = parseBool(value, conf.isInexactNewton);
+		else if (name == "ew_gamma")
+			isParsed = parseDouble(value, conf.ewGamma);
+		else if (name == "ew_alpha")
+			isParsed = parseDouble(value, conf.ewAlpha);
+		else if (name == "ew_eta0")
+			isParsed = parseDouble(value, conf.ewEta0);
+		else if (name == "ew_eta_max")
+			isParsed = parseDouble(value, conf.ewEtaMax);
+		else if (name == "warm_start")
+			isParsed = parseBool(value, conf.isWarmStart);
+		else if (name == "recycle_size")
+			isParsed = parseInt(value, conf.recycleSize);
+		else if (name == "jfnk")
+			isParsed = parseBool(value, conf.isJFNK);
+		else if (name == "verbose")
+			isParsed = parseBool(value, conf.isVerbose);
+		else
+		{
+			cout << "Error: unknown solver option " << name << " in " << fileName << endl;
+			isValid = false;
+			continue;
+		}
+
+		if (!isParsed)
+		{
+			cout << "Error: invalid value " << value << " of " << name << " in " << fileName << endl;
+			isValid = false;
+		}
+	}
+	file.close();
+
+	if (!isValid || !conf.check())
+	{
+		cout << "Solver config " << fileName << " is rejected" << endl;
+		return false;
+	}
+
+	*this = conf;
+	return true;
+}
+
+// Prints the error if value is out of [minVal, maxVal]
+template <typename T>
+static bool checkRange(const char* name, const T value, const T minVal, const T maxVal)
+{
+	if (value >= minVal && value <= maxVal)
+		return true;
+
+	cout << "Error: " << name << " = " << value << " is out of [" << minVal << ", " << maxVal << "]" << endl;
+	return false;
+}
+
+bool ParSolverConfig::check() const
+{
+	const int maxInt = std::numeric_limits<int>::max();
+	const double maxDouble = std::numeric_limits<double>::max();
+	bool isValid = checkRange("restart", restart, 1, maxInt) &&
+		checkRange("max_iter", maxIter, 1, maxInt) &&
+		checkRange("abs_tol", absTol, 0.0, maxDouble) &&
+		checkRange("rel_tol", relTol, 0.0, 1.0) &&
+		checkRange("div_tol", divTol, 1.0, maxDouble) &&
+		checkRange("block_size", blockSize, 1, maxInt) &&
+		checkRange("ilut_tol", ilutTol, 0.0, 1.0) &&
+		checkRange("ilut_max_row", ilutMaxRow, 1, maxInt) &&
+		checkRange("inner_rel_tol", innerRelTol, 0.0, 1.0) &&
+		checkRange("inner_max_iter", innerMaxIter, 1, maxInt) &&
+		checkRange("fill_level", fillLevel, 0, maxInt) &&
+		checkRange("rebuild_freq", rebuildFreq, 1, maxInt) &&
+		checkRange("blow_up_ratio", blowUpRatio, 1.0, maxDouble) &&
+		checkRange("ew_gamma", ewGamma, 0.0, 1.0) &&
+		checkRange("ew_alpha", ewAlpha, 1.0, 2.0) &&
+		checkRange("ew_eta0", ewEta0, 0.0, 1.0) &&
+		checkRange("ew_eta_max", ewEtaMax, 0.0, 1.0) &&
+		checkRange("recycle_size", recycleSize, 0, maxInt);
+	if (!isValid)
+		return false;
+
+	if ((precond == PRECOND_CPR || precond == PRECOND_BILU0) && blockSize > 4)
+	{
+		cout << "Error: block size " << blockSize << " is not supported, block sizes from 1 to 4 are" << endl;
+		return false;
+	}
+	// Single precision variants are built for ILUT only
+	if (precision != PRECISION_DOUBLE && precond != PRECOND_ILUT)
+	{
+		cout << "Error: single precision is supported only with ILUT preconditioner" << endl;
+		return false;
+	}
+	// Block operator is solved by the own FGMRES
+	if (precond == PRECOND_BILU0 && method != SOLVER_GMRES)
+	{
+		cout << "Error: block ILU(0) is supported only with GMRES method" << endl;
+		return false;
+	}
+	// Recycled vectors are kept in the restarted FGMRES basis
+	if (recycleSize > 0 && (method != SOLVER_GMRES || recycleSize >= restart))
+	{
+		cout << "Error: recycle size " << recycleSize << " requires GMRES method with larger restart" << endl;
+		return false;
+	}
+	// Defect correction runs its own single precision GMRES
+	if (method == SOLVER_BICGSTAB && precision == PRECISION_SINGLE_KRYLOV)
+	{
+		cout << "Error: single_krylov precision is supported only with GMRES method" << endl;
+		return false;
+	}
+	// Own FGMRES applies the preconditioner alone, defect correction is the whole solve
+	if (precision == PRECISION_SINGLE_KRYLOV && (isJFNK || recycleSize > 0))
+	{
+		cout << "Error: single_krylov precision is not supported with jfnk or recycling, single_precond is" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+ParSolver::ParSolver()
 {
 	isAssembled = false;
 	isPrecondBuilt = false;
-	gmres.Init(1.E-15, 1.E-8, 1E+4, 20000);
-	bicgstab.Init(1.E-15, 1.E-8, 1E+4, 20000);
+
+	row_ptr = NULL;
+	col = NULL;
+	val = NULL;
+	slots = NULL;
+	nnz = 0;
+	blockMat = NULL;
+
+	solvesSinceBuild = 0;
+	buildIterNum = 0;
+	iterNum = 0;
+	initRes = finalRes = 0.0;
+	setupTime = solveTime = 0.0;
+	isNewTimeStep = true;
+	isNewPeriod = true;
+	newtonRes = newtonEta = 0.0;
+
+	guessScale = 1.0;
+	isGuessStored = false;
+	stepSolvesNum = 0;
+	recNum = 0;
+	isRecycleStale = true;
 }
 
 ParSolver::~ParSolver()
 {
+	if (isPrecondBuilt)
+		getKrylov().Clear();
+
+	delete[] slots;
+	delete blockMat;
+	// Arrays are left to Mat only during the assembly
+	delete[] row_ptr;
+	delete[] col;
+	delete[] val;
 }
 
 void ParSolver::Init(int vecSize)
 {
 	matSize = vecSize;
 	x.Allocate("x", vecSize);
+	Rhs.Allocate("rhs", vecSize);
+	guess.Allocate("guess", vecSize);
+	r.Allocate("r", vecSize);
+	z.Allocate("z", vecSize);
+	guess.Zeros();
+	isGuessStored = false;
+	stepSolvesNum = 0;
+	recNum = 0;
 }
 
-void ParSolver::Assemble(const int* ind_i, const int* ind_j, const double* a, const int counter, const int* ind_rhs, const double* rhs)
+void ParSolver::setPattern(const int* ind_i, const int* ind_j, const int counter)
 {
-	Mat.Zeros();
-	Rhs.Zeros();
-	x.Zeros();
+	// Pattern can be rebuilt, the previous arrays are owned by Mat
+	if (isPrecondBuilt)
+	{
+		getKrylov().Clear();
+		isPrecondBuilt = false;
+	}
+	Mat.Clear();
+	delete blockMat;
+	blockMat = NULL;
 
-	if (isAssembled)
+	delete[] slots;
+	slots = new int[counter];
+	// Block ILU(0) works on the block operator, Mat is not used
+	if (config.precond == PRECOND_BILU0)
 	{
-		Mat.AssembleUpdate(a);
-		Rhs.Assemble(ind_rhs, rhs, matSize, "rhs");
-	} else {
-		Mat.Assemble(ind_i, ind_j, a, counter, "A", matSize, matSize);
-		Rhs.Assemble(ind_rhs, rhs, matSize, "rhs");
+		if (matSize % config.blockSize != 0)
+		{
+			cout << "Error: matrix size " << matSize << " is not a multiple of block size " << config.blockSize << ", point blocks are used" << endl;
+			config.blockSize = 1;
+		}
+		blockMat = createBlockMatrix(config.blockSize);
+		blockMat->setPattern(matSize, ind_i, ind_j, counter, slots);
+		opIn.resize(matSize);
+		opOut.resize(matSize);
+		return;
+	}
+
+	// Sorting elements by rows and columns
+	vector<int> order(counter);
+	for (int k = 0; k < counter; k++)
+		order[k] = k;
+	std::sort(order.begin(), order.end(), [&](const int l, const int r)
+	{
+		return ind_i[l] < ind_i[r] || (ind_i[l] == ind_i[r] && ind_j[l] < ind_j[r]);
+	});
+
+	// Duplicated elements share the same slot
+	nnz = 0;
+	for (int k = 0; k < counter; k++)
+	{
+		const int cur = order[k];
+		if (k > 0 && ind_i[cur] == ind_i[order[k - 1]] && ind_j[cur] == ind_j[order[k - 1]])
+			slots[cur] = nnz - 1;
+		else
+			slots[cur] = nnz++;
+	}
+
+	row_ptr = new int[matSize + 1];
+	col = new int[nnz];
+	val = new double[nnz];
+	memset(row_ptr, 0, sizeof(int) * (matSize + 1));
+	memset(val, 0, sizeof(double) * nnz);
+	for (int k = 0; k < counter; k++)
+	{
+		col[slots[k]] = ind_j[k];
+		row_ptr[ind_i[k] + 1] = std::max(row_ptr[ind_i[k] + 1], slots[k] + 1);
+	}
+	// Rows without elements
+	for (int i = 0; i < matSize; i++)
+		if (row_ptr[i + 1] < row_ptr[i])
+			row_ptr[i + 1] = row_ptr[i];
+
+	// Mat takes the ownership of arrays
+	Mat.SetDataPtrCSR(&row_ptr, &col, &val, "A", nnz, matSize, matSize);
+}
+
+const int* ParSolver::getSlots() const
+{
+	return slots;
+}
 
+double* ParSolver::beginAssemble()
+{
+	if (blockMat != NULL)
+	{
+		double* values = blockMat->getValues();
+		memset(values, 0, sizeof(double) * blockMat->getValuesNum());
+		return values;
+	}
+
+	Mat.LeaveDataPtrCSR(&row_ptr, &col, &val);
+	memset(val, 0, sizeof(double) * nnz);
+
+	return val;
+}
+
+void ParSolver::Assemble(const double* rhs)
+{
+	if (blockMat == NULL)
+	{
+		Mat.SetDataPtrCSR(&row_ptr, &col, &val, "A", nnz, matSize, matSize);
 		Mat.MoveToAccelerator();
-		Rhs.MoveToAccelerator();
-		x.MoveToAccelerator();
-	}	
+	}
+
+	Rhs.MoveToHost();
+	Rhs.CopyFromData(rhs);
+	x.Zeros();
+
+	Rhs.MoveToAccelerator();
+	x.MoveToAccelerator();
+	isRecycleStale = true;
+}
+
+void ParSolver::AssembleRhs(const double* rhs)
+{
+	Rhs.MoveToHost();
+	Rhs.CopyFromData(rhs);
+	x.Zeros();
+
+	Rhs.MoveToAccelerator();
+	x.MoveToAccelerator();
 }
 
 const paralution::LocalVector<double>& ParSolver::getSolution()
@@ -51,79 +540,796 @@ const paralution::LocalVector<double>& ParSolver::getSolution()
 	return x;
 }
 
+void ParSolver::setNewTimeStep(const double stepRatio)
+{
+	guessScale = stepRatio;
+	if (config.isVerbose && stepStats.solvesNum > 0)
+		stepStats.print("Linear solver step");
+	stepStats.reset();
+	stepSolvesNum = 0;
+	isNewTimeStep = true;
+	newtonRes = newtonEta = 0.0;
+}
+
+void ParSolver::setNewPeriod()
+{
+	// Previous updates are not relevant for the new well conditions
+	isGuessStored = false;
+	isNewPeriod = true;
+}
+
+void ParSolver::setNewNewtonLoop()
+{
+	newtonRes = newtonEta = 0.0;
+}
+
+void ParSolver::setInexactNewton(const bool isOn)
+{
+	config.isInexactNewton = isOn;
+}
+
+void ParSolver::setWarmStart(const bool isOn)
+{
+	config.isWarmStart = isOn;
+}
+
+double ParSolver::setInitialGuess(const double rhsNorm)
+{
+	bool isZero = true;
+	if (config.isWarmStart && isGuessStored && stepSolvesNum == 0)
+	{
+		guess.MoveToAccelerator();
+		x.CopyFrom(guess);
+		x.Scale(guessScale);
+		isZero = false;
+	}
+	if (isZero)
+		return rhsNorm;
+
+	// r = b - A x0
+	r.MoveToAccelerator();
+	applyOperator(x, &r);
+	r.ScaleAdd(-1.0, Rhs);
+
+	return r.Norm();
+}
+
+void ParSolver::storeSolution()
+{
+	if (config.isWarmStart && stepSolvesNum == 0)
+	{
+		guess.MoveToAccelerator();
+		guess.CopyFrom(x);
+		isGuessStored = true;
+	}
+	stepSolvesNum++;
+}
+
+double ParSolver::getForcingTerm(const double res)
+{
+	double eta;
+	if (newtonRes > 0.0)
+	{
+		eta = config.ewGamma * pow(res / newtonRes, config.ewAlpha);
+		// Safeguard against the too fast decrease while the previous term was large
+		const double etaSafe = config.ewGamma * pow(newtonEta, config.ewAlpha);
+		if (etaSafe > 0.1)
+			eta = std::max(eta, etaSafe);
+	} else
+		eta = config.ewEta0;
+	eta = std::max(std::min(eta, config.ewEtaMax), config.relTol);
+
+	newtonRes = res;
+	newtonEta = eta;
+	return eta;
+}
+
+void ParSolver::setPrecondPolicy(const int rebuildFreq, const double blowUpRatio)
+{
+	config.rebuildFreq = rebuildFreq;
+	config.blowUpRatio = blowUpRatio;
+}
+
+bool ParSolver::setPrecond(const int type, const int blockSize)
+{
+	ParSolverConfig conf = config;
+	conf.precond = type;
+	conf.blockSize = blockSize;
+	return setConfig(conf);
+}
+
+bool ParSolver::setConfig(const ParSolverConfig& _config)
+{
+	if (!_config.check())
+		return false;
+	// Operator storage is chosen by setPattern
+	const bool isBlock = (_config.precond == PRECOND_BILU0);
+	if (slots != NULL && (isBlock != (blockMat != NULL) || (isBlock && _config.blockSize != blockMat->getBlockSize())))
+	{
+		cout << "Error: operator storage cannot be changed after the pattern is built" << endl;
+		return false;
+	}
+
+	// Built solver is cleared before the method can be switched
+	if (isPrecondBuilt)
+	{
+		getKrylov().Clear();
+		isPrecondBuilt = false;
+	}
+	if (_config.recycleSize != config.recycleSize)
+		recNum = 0;
+	config = _config;
+	isNewPeriod = true;
+
+	return true;
+}
+
+const ParSolverConfig& ParSolver::getConfig() const
+{
+	return config;
+}
+
+Solver<LocalMatrix<double>, LocalVector<double>, double>& ParSolver::getPrecond()
+{
+	if (config.precond == PRECOND_CPR)
+		return cpr;
+	else if (config.precond == PRECOND_AMG)
+		return amg;
+	else if (config.precision == PRECISION_SINGLE_PRECOND)
+		return floatIlut;
+	else
+		return p;
+}
+
+bool ParSolver::isMixedPrecision() const
+{
+	return config.precond == PRECOND_ILUT && config.precision == PRECISION_SINGLE_KRYLOV;
+}
+
+void ParSolver::applyPrecond(const double* rhs, double* sol)
+{
+	if (blockMat != NULL)
+	{
+		blockMat->solveILU0(rhs, sol);
+		return;
+	}
+
+	r.MoveToHost();
+	r.CopyFromData(rhs);
+	z.MoveToAccelerator();
+	r.MoveToAccelerator();
+	z.Zeros();
+	getPrecond().Solve(r, &z);
+	z.MoveToHost();
+	z.CopyToData(sol);
+}
+
+IterativeLinearSolver<LocalMatrix<double>, LocalVector<double>, double>& ParSolver::getKrylov()
+{
+	if (isMixedPrecision())
+		return mixed;
+	else if (config.method == SOLVER_BICGSTAB)
+		return bicgstab;
+	else
+		return gmres;
+}
+
+bool ParSolver::isPrecondStale()
+{
+	if (!isPrecondBuilt || isNewPeriod)
+		return true;
+	if (config.precond != PRECOND_AMG && (isNewTimeStep || solvesSinceBuild >= config.rebuildFreq))
+		return true;
+	if (solvesSinceBuild > 1 && (double)(iterNum) > config.blowUpRatio * (double)(buildIterNum > 0 ? buildIterNum : 1))
+		return true;
+
+	return false;
+}
+
+void ParSolver::applyOperator(const LocalVector<double>& in, LocalVector<double>* out)
+{
+	if (blockMat == NULL)
+	{
+		Mat.Apply(in, out);
+		return;
+	}
+
+	in.CopyToData(&opIn[0]);
+	blockMat->Apply(&opIn[0], &opOut[0]);
+	out->CopyFromData(&opOut[0]);
+}
+
+void ParSolver::buildPrecond()
+{
+	if (blockMat != NULL)
+	{
+		// Factors are kept apart from the values updated in place
+		blockMat->factorILU0();
+		isPrecondBuilt = true;
+		isNewTimeStep = false;
+		isNewPeriod = false;
+		solvesSinceBuild = 0;
+		return;
+	}
+
+	IterativeLinearSolver<LocalMatrix<double>, LocalVector<double>, double>& ls = getKrylov();
+	if (isPrecondBuilt)
+		ls.Clear();
+
+	ls.SetOperator(Mat);
+	if (config.method == SOLVER_GMRES)
+		gmres.SetBasisSize(config.restart);
+
+	if (config.precond == PRECOND_CPR)
+	{
+		cpr.Set(config.blockSize, config.cprPres, 1, config.fillLevel);
+		ls.SetPreconditioner(cpr);
+	}
+	else if (config.precond == PRECOND_AMG)
+	{
+		amg.SetInterpolation(paralution::SmoothedAggregation);
+		amg.SetCoarsestLevel(AMG_COARSEST_SIZE);
+		// One V-cycle per application
+		amg.InitMaxIter(1);
+		amg.Verbose(0);
+		ls.SetPreconditioner(amg);
+	}
+	else if (isMixedPrecision())
+	{
+		// Outer iterations are the double precision defect correction
+		pFloat.Set((float)config.ilutTol, config.ilutMaxRow);
+		gmresFloat.SetPreconditioner(pFloat);
+		gmresFloat.SetBasisSize(config.restart);
+		gmresFloat.Init(0.0, (float)config.innerRelTol, 1E+8, config.innerMaxIter);
+		gmresFloat.Verbose(0);
+		mixed.Set(gmresFloat);
+		mixed.Init(config.absTol, config.relTol, config.divTol, config.maxIter);
+	}
+	else if (config.precision == PRECISION_SINGLE_PRECOND)
+	{
+		floatIlut.Set(config.ilutTol, config.ilutMaxRow);
+		ls.SetPreconditioner(floatIlut);
+	} else {
+		p.Set(config.ilutTol, config.ilutMaxRow);
+		ls.SetPreconditioner(p);
+	}
+	ls.Build();
+
+	isPrecondBuilt = true;
+	isNewTimeStep = false;
+	isNewPeriod = false;
+	solvesSinceBuild = 0;
+}
+
 void ParSolver::Solve()
 {
-	SolveGMRES();
-	//SolveBiCGStab();
+	SolveKrylov();
 		
 	x.MoveToHost();
 }
 
-void ParSolver::SolveBiCGStab()
+void ParSolver::SolveKrylov()
 {
-	bicgstab.SetOperator(Mat);
-	p.Set(1);
-	bicgstab.SetPreconditioner(p);
-	bicgstab.Build();
+
+	// Preconditioner is kept while matrix values are updated in place,
+	// so the solver iterates with the actual matrix and the lagged preconditioner
+	Clock::time_point start = Clock::now();
+	const bool isBuilt = isPrecondStale();
+	if (isBuilt)
+		buildPrecond();
+	setupTime = getSeconds(start);
 	isAssembled = true;
 
-	bicgstab.Init(1.E-15, 1.E-10, 1E+4, 5000);
-	Mat.info();
+	// Right hand side norm is the Newton residual
+	const double rhsNorm = Rhs.Norm();
+	const double relTol = (config.isInexactNewton ? getForcingTerm(rhsNorm) : config.relTol);
 
-	//bicgstab.RecordResidualHistory();
-	bicgstab.Solve(Rhs, &x);
-	//bicgstab.RecordHistory(resHistoryFile);
+	start = Clock::now();
+	initRes = setInitialGuess(rhsNorm);
+	// Tolerance stays relative to the right hand side as for zero initial guess
+	if (initRes > relTol * rhsNorm && blockMat != NULL)
+	{
+		BlockMatrixOperator op(*blockMat);
+		SolveFGMRES(op, std::max(relTol * rhsNorm, config.absTol));
+	}
+	else if (initRes > relTol * rhsNorm && config.recycleSize > 0)
+	{
+		CSRMatrixOperator op(Mat, matSize);
+		SolveFGMRES(op, std::max(relTol * rhsNorm, config.absTol));
+	}
+	else if (initRes > relTol * rhsNorm)
+	{
+		IterativeLinearSolver<LocalMatrix<double>, LocalVector<double>, double>& ls = getKrylov();
+		ls.Init(config.absTol, relTol * rhsNorm / initRes, config.divTol, config.maxIter);
+		if (config.isVerbose)
+			Mat.info();
 
-	//getResiduals();
-	//cout << "Initial residual: " << initRes << endl;
-	//cout << "Final residual: " << finalRes << endl;
-	//cout << "Number of iterations: " << iterNum << endl << endl;
+		ls.Solve(Rhs, &x);
+		iterNum = ls.GetIterationCount();
+		finalRes = ls.GetCurrentResidual();
+	} else {
+		iterNum = 0;
+		finalRes = initRes;
+	}
+	solveTime = getSeconds(start);
+	//writeSystem();
+
+	if (solvesSinceBuild++ == 0)
+		buildIterNum = iterNum;
 
-	bicgstab.Clear();
+	storeSolution();
+	updateStats(isBuilt);
 }
 
-void ParSolver::SolveGMRES()
+bool ParSolver::needsJacobian()
 {
-	gmres.SetOperator(Mat);
-	p.Set(1.E-10, 1000);
-	gmres.SetPreconditioner(p);
-	gmres.Build();
-	isAssembled = true;
+	return isPrecondStale();
+}
 
-	gmres.Init(1.E-15, 1.E-10, 1E+4, 5000);
-	Mat.info();
+static double getDot(const double* a, const double* b, const int n)
+{
+	double sum = 0.0;
+	for (int i = 0; i < n; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
 
-	//gmres.RecordResidualHistory();
-	gmres.Solve(Rhs, &x);
-	//gmres.RecordHistory(resHistoryFile);
-	//writeSystem();
+static double getNorm(const vector<double>& v)
+{
+	return sqrt(getDot(&v[0], &v[0], (int)v.size()));
+}
 
+void ParSolver::SolveMatrixFree(JacobianOperator& op)
+{
+	Clock::time_point start = Clock::now();
+	setupTime = 0.0;
 
-	//getResiduals();
-	//cout << "Initial residual: " << initRes << endl;
-	//cout << "Final residual: " << finalRes << endl;
-	//cout << "Number of iterations: " << iterNum << endl << endl;
+	// Right hand side norm is the Newton residual, initial guess is zero
+	const double rhsNorm = Rhs.Norm();
+	const double relTol = (config.isInexactNewton ? getForcingTerm(rhsNorm) : config.relTol);
 
-	gmres.Clear();
+	initRes = rhsNorm;
+	x.Zeros();
+	// Jacobian changes with the Newton state
+	isRecycleStale = true;
+	SolveFGMRES(op, std::max(relTol * rhsNorm, config.absTol));
+	solveTime = getSeconds(start);
+
+	solvesSinceBuild++;
+	updateStats(false);
 }
 
-void ParSolver::getResiduals()
+void ParSolver::SolveFGMRES(JacobianOperator& op, const double target)
 {
-	double tmp;
-	int i = 0;
+	const int n = matSize;
+	const int m = std::max(config.restart, 1);
 
-	ifstream file;
-	file.open(resHistoryFile, ifstream::in);
+	vector<double> b(n), sol(n), w(n);
+	Rhs.MoveToHost();
+	Rhs.CopyToData(&b[0]);
+	Rhs.MoveToAccelerator();
+	x.MoveToHost();
+	x.CopyToData(&sol[0]);
+
+	// Krylov basis V, preconditioned directions Z, Hessenberg matrix H stored by columns.
+	// Hraw keeps H before Givens rotations, B = C^T A Z is the coupling with the recycled subspace
+	if (recNum > 0 && isRecycleStale)
+		updateRecycled(op);
+	vector<double> V((m + 1) * n), Z(m * n), H((m + 1) * m), cs(m), sn(m), g(m + 1), y(m);
+	vector<double> Hraw((m + 1) * m), B;
 
-	file >> initRes;
-	while ( !file.eof() )
+	// Zero initial guess saves an operator application, it is costly in matrix-free mode
+	bool isZero = true;
+	for (int i = 0; i < n && isZero; i++)
+		isZero = (sol[i] == 0.0);
+	if (isZero)
+		w = b;
+	else
 	{
-		file >> tmp;
-		i++;
+		op.applyJacobian(&sol[0], &w[0]);
+		for (int i = 0; i < n; i++)
+			w[i] = b[i] - w[i];
 	}
-	finalRes = tmp;
-	iterNum = i;
 
-	file.close();
+	iterNum = 0;
+	double beta = deflateResidual(&sol[0], &w[0]);
+	while (beta > target && beta < config.divTol * initRes && iterNum < config.maxIter)
+	{
+		for (int i = 0; i < n; i++)
+			V[i] = w[i] / beta;
+		std::fill(g.begin(), g.end(), 0.0);
+		g[0] = beta;
+		B.resize(m * std::max(recNum, 1));
+
+		int k = 0;
+		while (k < m && iterNum < config.maxIter)
+		{
+			double* h = &H[k * (m + 1)];
+			applyPrecond(&V[k * n], &Z[k * n]);
+			op.applyJacobian(&Z[k * n], &w[0]);
+
+			// Arnoldi process is kept orthogonal to the recycled C
+			for (int j = 0; j < recNum; j++)
+			{
+				const double* c = &recC[j * n];
+				const double dot = getDot(c, &w[0], n);
+				B[k * recNum + j] = dot;
+				for (int i = 0; i < n; i++)
+					w[i] -= dot * c[i];
+			}
 
-}
\ No newline at end of file
+			// Modified Gram-Schmidt
+			for (int j = 0; j <= k; j++)
+			{
+				const double* v = &V[j * n];
+				const double dot = getDot(v, &w[0], n);
+				h[j] = dot;
+				for (int i = 0; i < n; i++)
+					w[i] -= dot * v[i];
+			}
+			h[k + 1] = getNorm(w);
+			if (h[k + 1] > 0.0)
+				for (int i = 0; i < n; i++)
+					V[(k + 1) * n + i] = w[i] / h[k + 1];
+			std::copy(h, h + k + 2, &Hraw[k * (m + 1)]);
+
+			// Givens rotations keep H upper triangular
+			for (int j = 0; j < k; j++)
+			{
+				const double tmp = cs[j] * h[j] + sn[j] * h[j + 1];
+				h[j + 1] = -sn[j] * h[j] + cs[j] * h[j + 1];
+				h[j] = tmp;
+			}
+			const double rad = sqrt(h[k] * h[k] + h[k + 1] * h[k + 1]);
+			cs[k] = (rad > 0.0 ? h[k] / rad : 1.0);
+			sn[k] = (rad > 0.0 ? h[k + 1] / rad : 0.0);
+			h[k] = rad;
+			h[k + 1] = 0.0;
+			g[k + 1] = -sn[k] * g[k];
+			g[k] = cs[k] * g[k];
+
+			k++;
+			iterNum++;
+			if (fabs(g[k]) <= target || rad == 0.0)
+				break;
+		}
+
+		// Back substitution & update with preconditioned directions, x += Z y - U B y
+		for (int j = k - 1; j >= 0; j--)
+		{
+			double sum = g[j];
+			for (int l = j + 1; l < k; l++)
+				sum -= H[l * (m + 1) + j] * y[l];
+			y[j] = (H[j * (m + 1) + j] != 0.0 ? sum / H[j * (m + 1) + j] : 0.0);
+		}
+		for (int j = 0; j < k; j++)
+			for (int i = 0; i < n; i++)
+				sol[i] += y[j] * Z[j * n + i];
+		for (int j = 0; j < recNum; j++)
+		{
+			double sum = 0.0;
+			for (int l = 0; l < k; l++)
+				sum += B[l * recNum + j] * y[l];
+			for (int i = 0; i < n; i++)
+				sol[i] -= sum * recU[j * n + i];
+		}
+		// Subspace is refined by every cycle & carried to the next solve
+		if (config.recycleSize > 0 && k > 0)
+			setRecycled(Z, V, B, Hraw, k);
+
+		// True residual for restart & stopping
+		op.applyJacobian(&sol[0], &w[0]);
+		for (int i = 0; i < n; i++)
+			w[i] = b[i] - w[i];
+		beta = deflateResidual(&sol[0], &w[0]);
+		if (k == 0)
+			break;
+	}
+	finalRes = beta;
+
+	x.CopyFromData(&sol[0]);
+}
+
+void ParSolver::updateRecycled(JacobianOperator& op)
+{
+	const int n = matSize;
+	int num = 0;
+	for (int j = 0; j < recNum; j++)
+	{
+		double* u = &recU[num * n];
+		double* c = &recC[num * n];
+		if (num != j)
+			std::copy(&recU[j * n], &recU[j * n] + n, u);
+		op.applyJacobian(u, c);
+
+		// C = A U is orthonormalized, U follows it
+		const double norm0 = sqrt(getDot(c, c, n));
+		for (int l = 0; l < num; l++)
+		{
+			const double h = getDot(&recC[l * n], c, n);
+			for (int i = 0; i < n; i++)
+			{
+				c[i] -= h * recC[l * n + i];
+				u[i] -= h * recU[l * n + i];
+			}
+		}
+		const double norm = sqrt(getDot(c, c, n));
+		// Nearly dependent vectors are dropped
+		if (norm <= 1.E-10 * norm0)
+			continue;
+		for (int i = 0; i < n; i++)
+		{
+			c[i] /= norm;
+			u[i] /= norm;
+		}
+		num++;
+	}
+
+	recNum = num;
+	isRecycleStale = false;
+}
+
+double ParSolver::deflateResidual(double* sol, double* res)
+{
+	const int n = matSize;
+	for (int j = 0; j < recNum; j++)
+	{
+		const double alpha = getDot(&recC[j * n], res, n);
+		for (int i = 0; i < n; i++)
+		{
+			sol[i] += alpha * recU[j * n + i];
+			res[i] -= alpha * recC[j * n + i];
+		}
+	}
+
+	return sqrt(getDot(res, res, n));
+}
+
+// Solves a * x = b for symmetric positive definite a, x replaces b. Matrices are row-major
+static bool choleskySolve(vector<double>& a, vector<double>& b, const int size, const int rhsNum)
+{
+	for (int j = 0; j < size; j++)
+	{
+		double d = a[j * size + j];
+		for (int l = 0; l < j; l++)
+			d -= a[j * size + l] * a[j * size + l];
+		if (d <= 0.0)
+			return false;
+		d = sqrt(d);
+		a[j * size + j] = d;
+		for (int i = j + 1; i < size; i++)
+		{
+			double sum = a[i * size + j];
+			for (int l = 0; l < j; l++)
+				sum -= a[i * size + l] * a[j * size + l];
+			a[i * size + j] = sum / d;
+		}
+	}
+
+	for (int r = 0; r < rhsNum; r++)
+	{
+		for (int i = 0; i < size; i++)
+		{
+			double sum = b[i * rhsNum + r];
+			for (int l = 0; l < i; l++)
+				sum -= a[i * size + l] * b[l * rhsNum + r];
+			b[i * rhsNum + r] = sum / a[i * size + i];
+		}
+		for (int i = size - 1; i >= 0; i--)
+		{
+			double sum = b[i * rhsNum + r];
+			for (int l = i + 1; l < size; l++)
+				sum -= a[l * size + i] * b[l * rhsNum + r];
+			b[i * rhsNum + r] = sum / a[i * size + i];
+		}
+	}
+
+	return true;
+}
+
+void ParSolver::setRecycled(const vector<double>& Z, const vector<double>& V, const vector<double>& B,
+	const vector<double>& Hraw, const int k)
+{
+	const int n = matSize;
+	const int m = std::max(config.restart, 1);
+	const int s = recNum + k;
+
+	// Columns of [U Z] & [C V]
+	vector<const double*> Wh(s), W(s + 1);
+	for (int j = 0; j <= s; j++)
+	{
+		if (j < s)
+			Wh[j] = (j < recNum ? &recU[j * n] : &Z[(j - recNum) * n]);
+		W[j] = (j < recNum ? &recC[j * n] : &V[(j - recNum) * n]);
+	}
+
+	// G is (s + 1) x s by columns
+	vector<double> G((s + 1) * s, 0.0);
+	for (int j = 0; j < s; j++)
+	{
+		double* gc = &G[j * (s + 1)];
+		if (j < recNum)
+			gc[j] = 1.0;
+		else
+		{
+			const int l = j - recNum;
+			for (int i = 0; i < recNum; i++)
+				gc[i] = B[l * recNum + i];
+			for (int i = 0; i <= l + 1; i++)
+				gc[recNum + i] = Hraw[l * (m + 1) + i];
+		}
+	}
+
+	// Harmonic Ritz problem G^T G p = theta G^T W^T Wh p is solved as (G^T G)^-1 G^T W^T Wh p = p / theta,
+	// the largest 1 / theta are the smallest harmonic Ritz values that slow down the convergence
+	vector<double> WtWh((s + 1) * s);
+	for (int j = 0; j < s; j++)
+		for (int i = 0; i <= s; i++)
+			WtWh[j * (s + 1) + i] = getDot(W[i], Wh[j], n);
+	vector<double> GtG(s * s), K(s * s);
+	for (int i = 0; i < s; i++)
+		for (int j = 0; j < s; j++)
+		{
+			GtG[i * s + j] = getDot(&G[i * (s + 1)], &G[j * (s + 1)], s + 1);
+			K[i * s + j] = getDot(&G[i * (s + 1)], &WtWh[j * (s + 1)], s + 1);
+		}
+	if (!choleskySolve(GtG, K, s, s))
+		return;
+
+	MCMatrix mat(s, s);
+	for (int i = 0; i < s; i++)
+		for (int j = 0; j < s; j++)
+			mat[i][j] = K[i * s + j];
+	MC_Eigenvalue eig(mat);
+	eig.EigenDecomposition();
+
+	vector<int> order(s);
+	vector<double> absVal(s);
+	for (int i = 0; i < s; i++)
+	{
+		order[i] = i;
+		absVal[i] = sqrt(eig.Eigendouble[i] * eig.Eigendouble[i] + eig.EigenImg[i] * eig.EigenImg[i]);
+	}
+	std::sort(order.begin(), order.end(), [&](const int l, const int r) { return absVal[l] > absVal[r]; });
+
+	// Complex pair is taken as its real & imaginary parts in the adjacent columns
+	const int kMax = std::min(config.recycleSize, s);
+	vector<int> cols;
+	vector<bool> isTaken(s, false);
+	for (int l = 0; l < s && (int)cols.size() < kMax; l++)
+	{
+		const int i = order[l];
+		if (isTaken[i])
+			continue;
+		if (eig.EigenImg[i] == 0.0)
+		{
+			cols.push_back(i);
+			isTaken[i] = true;
+		}
+		else if ((int)cols.size() + 2 <= kMax)
+		{
+			const int pair = (eig.EigenImg[i] > 0.0 ? i + 1 : i - 1);
+			cols.push_back(std::min(i, pair));
+			cols.push_back(std::max(i, pair));
+			isTaken[i] = isTaken[pair] = true;
+		}
+	}
+
+	// G P = Q R by modified Gram-Schmidt, then C = W Q & U = Wh P R^-1 keep A U = C
+	const int num = (int)cols.size();
+	vector<double> P(s * num), Q((s + 1) * num), R(num * num, 0.0);
+	int kept = 0;
+	for (int t = 0; t < num; t++)
+	{
+		double* p = &P[kept * s];
+		double* q = &Q[kept * (s + 1)];
+		for (int i = 0; i < s; i++)
+			p[i] = eig.EigenMatrix[i][cols[t]];
+		for (int i = 0; i <= s; i++)
+		{
+			q[i] = 0.0;
+			for (int j = 0; j < s; j++)
+				q[i] += G[j * (s + 1) + i] * p[j];
+		}
+		const double norm0 = sqrt(getDot(q, q, s + 1));
+		for (int l = 0; l < kept; l++)
+		{
+			const double h = getDot(&Q[l * (s + 1)], q, s + 1);
+			R[l * num + kept] = h;
+			for (int i = 0; i <= s; i++)
+				q[i] -= h * Q[l * (s + 1) + i];
+		}
+		const double norm = sqrt(getDot(q, q, s + 1));
+		if (norm <= 1.E-10 * norm0)
+			continue;
+		R[kept * num + kept] = norm;
+		for (int i = 0; i <= s; i++)
+			q[i] /= norm;
+		kept++;
+	}
+
+	vector<double> newU(kept * n, 0.0), newC(kept * n, 0.0);
+	for (int t = 0; t < kept; t++)
+	{
+		double* u = &newU[t * n];
+		double* c = &newC[t * n];
+		for (int j = 0; j < s; j++)
+		{
+			const double pj = P[t * s + j];
+			for (int i = 0; i < n; i++)
+				u[i] += pj * Wh[j][i];
+		}
+		for (int l = 0; l < t; l++)
+		{
+			const double rl = R[l * num + t];
+			for (int i = 0; i < n; i++)
+				u[i] -= rl * newU[l * n + i];
+		}
+		for (int i = 0; i < n; i++)
+			u[i] /= R[t * num + t];
+		for (int j = 0; j <= s; j++)
+		{
+			const double qj = Q[t * (s + 1) + j];
+			for (int i = 0; i < n; i++)
+				c[i] += qj * W[j][i];
+		}
+	}
+
+	recU.swap(newU);
+	recC.swap(newC);
+	recNum = kept;
+	isRecycleStale = false;
+}
+
+void ParSolver::updateStats(const bool isBuilt)
+{
+	ParSolverStats* stats[] = { &stepStats, &runStats };
+	for (int i = 0; i < 2; i++)
+	{
+		ParSolverStats& s = *stats[i];
+		s.solvesNum++;
+		if (isBuilt)
+			s.buildsNum++;
+		s.iterNum += iterNum;
+		s.maxIterNum = std::max(s.maxIterNum, iterNum);
+		s.initRes = initRes;
+		s.finalRes = finalRes;
+		s.setupTime += setupTime;
+		s.solveTime += solveTime;
+	}
+}
+
+int ParSolver::getIterNum() const
+{
+	return iterNum;
+}
+
+double ParSolver::getInitRes() const
+{
+	return initRes;
+}
+
+double ParSolver::getFinalRes() const
+{
+	return finalRes;
+}
+
+double ParSolver::getSetupTime() const
+{
+	return setupTime;
+}
+
+double ParSolver::getSolveTime() const
+{
+	return solveTime;
+}
+
+const ParSolverStats& ParSolver::getStepStats() const
+{
+	return stepStats;
+}
+
+const ParSolverStats& ParSolver::getRunStats() const
+{
+	return runStats;
+}
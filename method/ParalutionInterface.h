@@ -2,8 +2,117 @@
 #define PARALUTIONINTERFACE_H_
 
 #include <string>
+#include <vector>
 
 #include "paralution.hpp"
+#include "method/CPRPreconditioner.h"
+#include "method/FloatILUTPreconditioner.h"
+#include "method/BlockMatrix.h"
+
+#define PRECOND_ILUT 0
+#define PRECOND_CPR 1
+#define PRECOND_BILU0 2
+#define PRECOND_AMG 3
+
+// Coarsest level size of AMG hierarchy
+#define AMG_COARSEST_SIZE 300
+
+#define SOLVER_GMRES 0
+#define SOLVER_BICGSTAB 1
+
+// Precision of ILUT preconditioned solves
+#define PRECISION_DOUBLE 0
+// Single precision ILUT factors inside the double precision Krylov solver
+#define PRECISION_SINGLE_PRECOND 1
+// Double precision defect correction around single precision GMRES with ILUT
+#define PRECISION_SINGLE_KRYLOV 2
+
+// Linear solver settings, defaults reproduce the former hard-coded ones
+struct ParSolverConfig
+{
+	// Krylov method & GMRES restart length
+	int method;
+	int restart;
+	// Stopping criteria
+	double absTol;
+	double relTol;
+	double divTol;
+	int maxIter;
+
+	// Preconditioner type & point block size for CPR and block ILU(0).
+	// With block ILU(0) the stencils assemble the block CSR operator directly, it is solved by FGMRES
+	int precond;
+	int blockSize;
+	// ILUT drop tolerance & maximal number of entries per row
+	double ilutTol;
+	int ilutMaxRow;
+	// ILUT precision, inner single precision GMRES settings for PRECISION_SINGLE_KRYLOV
+	int precision;
+	double innerRelTol;
+	int innerMaxIter;
+	// CPR pressure stage: CPR_PRES_AMG or CPR_PRES_ILU with fillLevel
+	int cprPres;
+	int fillLevel;
+
+	// Preconditioner lifecycle, see ParSolver::isPrecondStale
+	int rebuildFreq;
+	double blowUpRatio;
+
+	// Inexact Newton: relative tolerance is chosen by Eisenstat-Walker choice 2
+	// eta_k = gamma * (|F_k| / |F_k-1|)^alpha, bounded by [relTol, etaMax], eta0 at the first iteration
+	bool isInexactNewton;
+	double ewGamma;
+	double ewAlpha;
+	double ewEta0;
+	double ewEtaMax;
+
+	// Initial guess of the first solve in time step is the previous step one scaled by time steps ratio
+	bool isWarmStart;
+	// Krylov subspace recycling (GCRO-DR): number of harmonic Ritz vectors carried between solves, 0 turns it off.
+	// Recycling solves run in the own FGMRES with the Arnoldi process deflated by the recycled subspace
+	int recycleSize;
+
+	// Jacobian-free Newton-Krylov: matrix is assembled only to rebuild the preconditioner,
+	// Jacobian products are supplied by the model solver in between. Used by the solvers supporting it
+	bool isJFNK;
+
+	// Prints matrix info at every solve
+	bool isVerbose;
+
+	ParSolverConfig();
+	ParSolverConfig(const int _precond, const int _blockSize = 1);
+	// Reads "name value" lines over the current settings, '#' starts a comment.
+	// Returns false & keeps the settings if file is not opened, has unknown names, malformed or unsupported values
+	bool load(const std::string& fileName);
+	// Prints an error & returns false for out of range values & unsupported combinations of settings
+	bool check() const;
+};
+
+// Linear solver telemetry accumulated in memory
+struct ParSolverStats
+{
+	int solvesNum;
+	int buildsNum;
+	int iterNum;
+	int maxIterNum;
+	// Residual norms of the last solve
+	double initRes;
+	double finalRes;
+	// Wall time in seconds
+	double setupTime;
+	double solveTime;
+
+	ParSolverStats();
+	void reset();
+	void print(const std::string& title) const;
+};
+
+// Jacobian-vector product y = J * v supplied by a model solver for matrix-free solves
+class JacobianOperator
+{
+public:
+	virtual void applyJacobian(const double* v, double* y) = 0;
+};
 
 class ParSolver
 {
@@ -12,15 +121,84 @@ protected:
 	paralution::LocalVector<double> Rhs;
 	paralution::LocalMatrix<double> Mat;
 	paralution::BiCGStab<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double > bicgstab;
-	void SolveBiCGStab();
 	paralution::GMRES<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double > gmres;
-	void SolveGMRES();
+	// Krylov solver chosen by config.method
+	paralution::IterativeLinearSolver<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double>& getKrylov();
+	void SolveKrylov();
+	// Preconditioner chosen by config.precond & config.precision, the own FGMRES applies it alone
+	paralution::Solver<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double>& getPrecond();
+	void applyPrecond(const double* rhs, double* sol);
 	paralution::ILUT<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double> p;
+	CPRPreconditioner cpr;
+	FloatILUTPreconditioner floatIlut;
+	paralution::MixedPrecisionDC<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double,
+		paralution::LocalMatrix<float>, paralution::LocalVector<float>, float> mixed;
+	paralution::GMRES<paralution::LocalMatrix<float>, paralution::LocalVector<float>, float> gmresFloat;
+	paralution::ILUT<paralution::LocalMatrix<float>, paralution::LocalVector<float>, float> pFloat;
+	bool isMixedPrecision() const;
+	// Smoothed aggregation AMG for scalar elliptic systems
+	paralution::AMG<paralution::LocalMatrix<double>, paralution::LocalVector<double>, double> amg;
+	ParSolverConfig config;
 
 	bool isAssembled;
 	bool isPrecondBuilt;
 	int matSize;
 
+	// CSR storage owned by Mat between assemblies
+	int* row_ptr;
+	int* col;
+	double* val;
+	int nnz;
+	// CSR value position of each element in stencils filling order
+	int* slots;
+
+	// Block CSR operator replacing Mat for block ILU(0), slots point to its blocks
+	BaseBlockMatrix* blockMat;
+	// Host copies of vectors for block SpMV
+	std::vector<double> opIn, opOut;
+	// out = A * in for both operator storages
+	void applyOperator(const paralution::LocalVector<double>& in, paralution::LocalVector<double>* out);
+	// Right preconditioned restarted FGMRES from the initial guess in x until |b - A x| <= target
+	void SolveFGMRES(JacobianOperator& op, const double target);
+
+	// Preconditioner lifecycle
+	// Rebuild after config.rebuildFreq reusing solves
+	// or if iterations number exceeds config.blowUpRatio of the number just after rebuild
+	int solvesSinceBuild;
+	int buildIterNum;
+	bool isNewTimeStep;
+	bool isNewPeriod;
+	bool isPrecondStale();
+	void buildPrecond();
+
+	// Nonlinear residual norm & forcing term of the previous Newton iteration, zero at the loop start
+	double newtonRes;
+	double newtonEta;
+	double getForcingTerm(const double res);
+
+	// Warm start, solves are counted from the time step beginning
+	paralution::LocalVector<double> guess;
+	double guessScale;
+	bool isGuessStored;
+	int stepSolvesNum;
+	paralution::LocalVector<double> r;
+	paralution::LocalVector<double> z;
+	void storeSolution();
+	// Recycled subspace: A U = C with orthonormal C, recNum columns of matSize values each.
+	// C is recomputed with the new operator if it has changed since the previous solve
+	std::vector<double> recU, recC;
+	int recNum;
+	bool isRecycleStale;
+	void updateRecycled(JacobianOperator& op);
+	// x += U C^T r, r -= C C^T r, returns the new residual norm
+	double deflateResidual(double* sol, double* res);
+	// Harmonic Ritz vectors of the last FGMRES cycle over span [U Z] become the new U & C.
+	// A [U Z] = [C V] G, B is C^T A Z & Hraw is unrotated Hessenberg matrix of k Arnoldi steps
+	void setRecycled(const std::vector<double>& Z, const std::vector<double>& V, const std::vector<double>& B,
+		const std::vector<double>& Hraw, const int k);
+	// Sets x0 & returns the norm of its residual
+	double setInitialGuess(const double rhsNorm);
+
 	inline void writeSystem()
 	{
 		Mat.WriteFileMTX("snaps/mat.mtx");
@@ -28,18 +206,59 @@ protected:
 		x.WriteFileASCII("snaps/x.dat");
 	};
 
+	// Last solve
 	double initRes, finalRes;
 	int iterNum;
-	const std::string resHistoryFile;
-	void getResiduals();
+	double setupTime, solveTime;
+	// Aggregated over the current time step & the whole run
+	ParSolverStats stepStats;
+	ParSolverStats runStats;
+	void updateStats(const bool isBuilt);
 
 public:
 	void Init(int vecSize);
-	void Assemble(const int* ind_i, const int* ind_j, const double* a, const int counter, const int* ind_rhs, const double* rhs);
+	// Symbolic phase: builds CSR or block CSR pattern from the filling order of the elements
+	void setPattern(const int* ind_i, const int* ind_j, const int counter);
+	const int* getSlots() const;
+	// Returns zeroed CSR values, elements are accumulated there as val[slots[k]] += a_k
+	double* beginAssemble();
+	void Assemble(const double* rhs);
 	void Solve();
+	// Matrix-free mode: true if the matrix has to be assembled for the preconditioner rebuilding
+	bool needsJacobian();
+	// Sets the right hand side only, the assembled matrix is kept for the preconditioner
+	void AssembleRhs(const double* rhs);
+	// Right preconditioned flexible GMRES with Jacobian products from op & the lagged preconditioner
+	void SolveMatrixFree(JacobianOperator& op);
+
+	// Forces preconditioner rebuilding at the next solve, starts the new step statistics & warm start.
+	// stepRatio is the new to the previous time step ratio used by warm start
+	void setNewTimeStep(const double stepRatio = 1.0);
+	// Forces rebuilding at the next solve for every preconditioner, AMG hierarchy is kept through the period
+	void setNewPeriod();
+	// Starts the new sequence of inexact Newton forcing terms
+	void setNewNewtonLoop();
+	void setInexactNewton(const bool isOn);
+	void setWarmStart(const bool isOn);
+	void setPrecondPolicy(const int rebuildFreq, const double blowUpRatio);
+	// CPR and block ILU(0) work with point blocks of blockSize variables
+	bool setPrecond(const int type, const int blockSize = 1);
+	// Replaces all the settings, preconditioner is rebuilt at the next solve.
+	// Config failed ParSolverConfig::check or changing the operator storage after setPattern is rejected
+	bool setConfig(const ParSolverConfig& _config);
+	const ParSolverConfig& getConfig() const;
 
 	const paralution::LocalVector<double>& getSolution();
 
+	int getIterNum() const;
+	double getInitRes() const;
+	double getFinalRes() const;
+	double getSetupTime() const;
+	double getSolveTime() const;
+	// Step statistics are reset by setNewTimeStep
+	const ParSolverStats& getStepStats() const;
+	const ParSolverStats& getRunStats() const;
+
 	ParSolver();
 	~ParSolver();
 };
@@ -0,0 +1,68 @@
+#include "method/SparseSweep.h"
+
+using std::map;
+
+SparseSweep::SparseSweep() : BandSweep()
+{
+}
+
+SparseSweep::~SparseSweep()
+{
+	map<int, SweepSystem*>::iterator it;
+	for (it = systems.begin(); it != systems.end(); ++it)
+		delete it->second;
+}
+
+SparseSweep::SweepSystem* SparseSweep::getSystem(const int size, const int key)
+{
+	map<int, SweepSystem*>::iterator it = systems.find(key);
+	if (it != systems.end() && it->second->size == size)
+		return it->second;
+
+	if (it != systems.end())
+		delete it->second;
+
+	SweepSystem* sys = new SweepSystem;
+	sys->size = size;
+	sys->solver.Init(size);
+	systems[key] = sys;
+
+	return sys;
+}
+
+bool SparseSweep::isPatternChanged(const SweepSystem* sys) const
+{
+	if (sys->pattern_i.size() != ind_i.size())
+		return true;
+
+	for (int k = 0; k < (int)ind_i.size(); k++)
+		if (sys->pattern_i[k] != ind_i[k] || sys->pattern_j[k] != ind_j[k])
+			return true;
+
+	return false;
+}
+
+void SparseSweep::Solve(int NZ, int MZ, int key)
+{
+	assemble(NZ, MZ, key);
+
+	SweepSystem* sys = getSystem((NZ + 1) * MZ, key);
+	if (isPatternChanged(sys))
+	{
+		sys->solver.setPattern(&ind_i[0], &ind_j[0], (int)ind_i.size());
+		sys->pattern_i = ind_i;
+		sys->pattern_j = ind_j;
+	}
+
+	const int* slots = sys->solver.getSlots();
+	double* val = sys->solver.beginAssemble();
+	for (int k = 0; k < (int)a.size(); k++)
+		val[slots[k]] += a[k];
+	sys->solver.Assemble(&rhs[0]);
+	sys->solver.Solve();
+
+	const paralution::LocalVector<double>& sol = sys->solver.getSolution();
+	for (int n = 0; n <= NZ; n++)
+		for (int e = 0; e < MZ; e++)
+			fz[n][e + 1] = sol[n * MZ + e];
+}
@@ -0,0 +1,35 @@
+#ifndef SPARSESWEEP_H_
+#define SPARSESWEEP_H_
+
+#include <map>
+
+#include "method/BandSweep.h"
+#include "method/ParalutionInterface.h"
+
+// Sweep that passes the assembled system to the preconditioned GMRES of ParSolver.
+// Used where the blocks are too wide for any direct elimination, e.g. (z, phi) slabs of 3D grids.
+// Unknowns keep (node, eq) numbering, the CSR pattern is rebuilt only if the non-zeros change.
+class SparseSweep : public BandSweep
+{
+protected:
+	// Separate system for each key as they differ in size and pattern
+	struct SweepSystem
+	{
+		ParSolver solver;
+		int size;
+		std::vector<int> pattern_i;
+		std::vector<int> pattern_j;
+	};
+	std::map<int, SweepSystem*> systems;
+
+	SweepSystem* getSystem(const int size, const int key);
+	bool isPatternChanged(const SweepSystem* sys) const;
+
+public:
+	SparseSweep();
+	~SparseSweep();
+
+	void Solve(int NZ, int MZ, int key);
+};
+
+#endif /* SPARSESWEEP_H_ */
@@ -1,58 +1,42 @@
 #include "method/sweep.h"
 
-double ** auxAlloc2Darray (int ni, int nj)
+#include <stdint.h>
+
+// Workspace rows are aligned to cache line
+#define SWEEP_ALIGN 64
+#define SWEEP_ALIGN_NUM (SWEEP_ALIGN / sizeof(double))
+
+// Leading dimension padded to aligned row
+int auxAlignedLd (int n)
 {
-  int _ni = ni+1;
-  int _nj = nj+1;
-  double ** ptArray = (double **) calloc (_ni,sizeof(double *));
-  for (int i=0; i<_ni; i++) {
-    ptArray[i]= (double *)calloc (_nj,sizeof(double));
-  }
-  return ptArray;
+  return (int)(((n + SWEEP_ALIGN_NUM - 1) / SWEEP_ALIGN_NUM) * SWEEP_ALIGN_NUM);
 }
 
-void auxFree2Darray (double ** ptArray, int ni, int /*nj*/)
+// Zeroed contiguous storage, raw is the pointer to be freed
+double * auxAllocAligned (size_t num, void ** raw)
 {
-  int _ni = ni +1;
-  //int _nj = nj +1;
-
-  for (int i=0;i<_ni;i++){
-    free (ptArray[i]);
-  }
-  free (ptArray);
+  *raw = calloc (num + SWEEP_ALIGN_NUM, sizeof(double));
+  if (*raw == NULL)  return NULL;
+  return (double *) (((uintptr_t) *raw + SWEEP_ALIGN - 1) & ~(uintptr_t)(SWEEP_ALIGN - 1));
 }
 
-
-double *** auxAlloc3Darray (int ni,int nj)
+// Array of row pointers into one contiguous (ni+1) x ld block
+double ** auxAlloc2Darray (int ni, int nj, void ** raw)
 {
-  int i,j;
-  int _ni = ni +1;
-  int _nj = nj +1;
-  double *** ptArray = (double ***) calloc(_ni,sizeof(double **));
-  if (ptArray == NULL)  return NULL;
-
-  for(i=0; i<_ni;i++) {
-    ptArray[i] = (double **) calloc(_nj,sizeof(double*));
-    if (ptArray[i] == NULL) return NULL;
-    for(j=0;j<_nj;j++)  {
-      ptArray[i][j] = (double *) calloc(_nj,sizeof(double));
-      if (ptArray[i][j] == NULL) return NULL;
-    }
+  int _ni = ni+1;
+  int ld = auxAlignedLd (nj+1);
+  double * data = auxAllocAligned ((size_t)_ni * ld, raw);
+  double ** ptArray = (double **) malloc (_ni * sizeof(double *));
+  for (int i=0; i<_ni; i++) {
+    ptArray[i] = data + (size_t)i * ld;
   }
   return ptArray;
 }
 
-void auxFree3Darray (double *** ptArray, int ni, int nj)
+void auxFree2Darray (double ** ptArray, void * raw)
 {
-  int _ni = ni +1;
-  int _nj = nj +1;
-
-  for (int i=0; i<_ni; i++)  {
-    for(int j=0; j<_nj; j++)
-      free (ptArray[i][j]);
-    free (ptArray[i]);
-  }
   free (ptArray);
+  free (raw);
 }
 
 
@@ -64,25 +48,20 @@ Sweep :: Sweep ()
 {
   bz = NULL;
   fz = NULL;
+  bzRaw = fzRaw = pqRaw = NULL;
+  pz = qz = NULL;
+  workspaceSize = 0;
 }
 
 Sweep :: Sweep (int PointNum, int EqNum)
 {
+  bz = NULL;
+  fz = NULL;
+  bzRaw = fzRaw = pqRaw = NULL;
+  pz = qz = NULL;
+  workspaceSize = 0;
 
-   BZ_I_DIM = 2*EqNum; 
-   BZ_J_DIM = 1+ 3*EqNum;
-
-   bz = auxAlloc2Darray (BZ_I_DIM, BZ_J_DIM);
-   fz = auxAlloc2Darray (PointNum, EqNum);
-
-   A.Initialize(EqNum,EqNum);
-   B.Initialize(EqNum,EqNum);
-   C.Initialize(EqNum,EqNum);
-   RightSide.Initialize(EqNum,1);
-
- 
-   MZ = EqNum;
-   NX = PointNum;
+  Initialize (PointNum, EqNum);
 }
 
 Sweep :: ~Sweep ()
@@ -92,21 +71,27 @@ Sweep :: ~Sweep ()
 
 void Sweep :: Clear ()
 {
-  if (bz) auxFree2Darray (bz, BZ_I_DIM, BZ_J_DIM);
-  if (fz) auxFree2Darray (fz, NX, MZ);
+  if (bz) auxFree2Darray (bz, bzRaw);
+  if (fz) auxFree2Darray (fz, fzRaw);
+  if (pqRaw) free (pqRaw);
+  bz = fz = NULL;
+  bzRaw = fzRaw = pqRaw = NULL;
+  pz = qz = NULL;
+  workspaceSize = 0;
 }
 
 
 void Sweep :: Initialize (int PointNum, int EqNum)
 {
+   Clear ();
+
    MZ = EqNum;
    NX = PointNum;
 
    BZ_I_DIM = 2*EqNum; 
    BZ_J_DIM = 1+ 3*EqNum;
 
-   bz = auxAlloc2Darray (BZ_I_DIM, BZ_J_DIM);
-   fz = auxAlloc2Darray (NX, MZ);
+   fz = auxAlloc2Darray (NX, MZ, &fzRaw);
 
    A.Initialize(EqNum,EqNum);
    B.Initialize(EqNum,EqNum);
@@ -115,6 +100,25 @@ void Sweep :: Initialize (int PointNum, int EqNum)
 
 
 }
+
+// Elimination factors pz & qz are MZ x MZ row-major blocks for each of NX+1 nodes of fz,
+// so every Solve with NZ <= NX works in the same storage.
+// Allocated by the first dense Solve only: sweeps over the assembled system never touch bz, pz & qz
+void Sweep :: InitWorkspace ()
+{
+  if (pqRaw)  return;
+
+  bz = auxAlloc2Darray (BZ_I_DIM, BZ_J_DIM, &bzRaw);
+
+  PQ_LD = auxAlignedLd (MZ);
+  const size_t pqSize = (size_t)(NX+1) * MZ * PQ_LD;
+
+  pz = auxAllocAligned (2 * pqSize, &pqRaw);
+  qz = pz + pqSize;
+
+  workspaceSize = ((size_t)(BZ_I_DIM+1) * auxAlignedLd (BZ_J_DIM+1) + 2 * pqSize) * sizeof(double);
+}
+
 void Sweep :: LeftBoundAppr (int /*EqNum*/,int )
 {
 }
@@ -126,128 +130,203 @@ void Sweep :: MiddleAppr (int /*m*/, int /*EqNum*/,int )
 }
 
 
-void Sweep :: Solve(int NZ,int MZ, int key)
+// Vectorization hint for independent inner loops
+#if defined(_MSC_VER)
+#define SWEEP_SIMD __pragma(loop(ivdep))
+#elif defined(_OPENMP)
+#define SWEEP_SIMD _Pragma("omp simd")
+#else
+#define SWEEP_SIMD
+#endif
+
+// Block kernels of the sweep. Rows of bz are 1-based: [node n | n-1 | n-2 | rhs] of width 3*mz+1.
+// M > 0 gives compile-time block size for small systems, M == 0 takes it from mz.
+
+// Gauss-Jordan elimination of the first mz columns over rows 1..rows with partial pivoting.
+// Top mz rows turn into [I | alpha | beta | f], the rest become the next block without the node n
+template <int M>
+static void eliminateBlock (double ** bz, const int mz_, const int rows)
 {
-  int i,j,k,l,m,n;
-  double cz[3];
+  const int mz = (M > 0 ? M : mz_);
+  const int cols = 3*mz+1;
+  int i,j,k,l;
+  double piv, c, tmp;
+  double *bl, *bk, *bi;
 
-  double  ***pz;
-  double  ***qz;
-  pz = NULL;
-  qz = NULL;
-  pz = auxAlloc3Darray(NZ,MZ);
-  qz = auxAlloc3Darray(NZ,MZ);
+  for (l=1;l<= mz;l++) {
+    // Maximum searching
+    k = l;
+    piv = bz[l][l];
+    for (i=l+1;i<= rows;i++)
+      if (fabs(bz[i][l]) > fabs(piv)) {
+        k = i;
+        piv = bz[i][l];
+      }
 
-  for (i=1;i<= MZ;i++) {
-    for (j=1;j<= 3*MZ+1;j++) {
-      bz[i][j] = 0.0;
+    // Maximum dividing & swapping
+    bl = bz[l];
+    bk = bz[k];
+    if (k != l) {
+      SWEEP_SIMD
+      for (j=l;j<= cols;j++) {
+        tmp = bk[j];
+        bk[j] = bl[j];
+        bl[j] = tmp;
+      }
+    }
+    SWEEP_SIMD
+    for (j=l;j<= cols;j++)
+      bl[j] = bl[j]/piv;
+
+    for (i=1;i<= rows;i++) {
+      if (i == l)  continue;
+      bi = bz[i];
+      c = bi[l];
+      if (c == 0.0)  continue;
+      SWEEP_SIMD
+      for (j=l+1;j<= cols;j++)
+        bi[j] = bi[j]-bl[j]*c;
     }
   }
+}
+
+// Left boundary rows couple nodes 2, 1 & 0: node 2 is substituted by x2 = f2 - alpha2 x1 - beta2 x0
+template <int M>
+static void substituteBlock (double ** bz, const int mz_, const double * pz2, const double * qz2, const double * fz2, const int ld)
+{
+  const int mz = (M > 0 ? M : mz_);
+  int i,j,k;
+  double c;
+  const double *pr, *qr;
+  double *bj;
+
+  for (k=1;k<= mz;k++) {
+    pr = pz2 + (k-1) * ld - 1;
+    qr = qz2 + (k-1) * ld - 1;
+    for (j=mz+1;j<= 2*mz;j++) {
+      bj = bz[j];
+      c = bj[k];
+      if (c == 0.0)  continue;
+      SWEEP_SIMD
+      for (i=1;i<= mz;i++) {
+        bj[i+mz] = bj[i+mz]-pr[i]*c;
+        bj[i+2*mz] = bj[i+2*mz]-qr[i]*c;
+      }
+      bj[3*mz+1] = bj[3*mz+1]-fz2[k]*c;
+    }
+  }
+
+  for (j=mz+1;j<= 2*mz;j++) {
+    bj = bz[j];
+    SWEEP_SIMD
+    for (i=1;i<= mz;i++) {
+      bj[i] = bj[i+mz];
+      bj[i+mz] = bj[i+2*mz];
+      bj[i+2*mz] = 0.0;
+    }
+  }
+}
+
+// x_n = f_n - alpha_n x_(n-1) - beta_n x_(n-2), beta is skipped for n == 1
+template <int M>
+static void backSubstBlock (double * x, const double * x1, const double * x2, const double * pn, const double * qn, const int mz_, const int ld)
+{
+  const int mz = (M > 0 ? M : mz_);
+  int i,j;
+  double sum;
+  const double *pr, *qr;
+
+  for (j=1;j<= mz;j++) {
+    pr = pn + (j-1) * ld - 1;
+    sum = x[j];
+    if (x2 == NULL) {
+      for (i=1;i<= mz;i++)
+        sum = sum-pr[i]*x1[i];
+    } else {
+      qr = qn + (j-1) * ld - 1;
+      for (i=1;i<= mz;i++)
+        sum = sum-pr[i]*x1[i]-qr[i]*x2[i];
+    }
+    x[j] = sum;
+  }
+}
+
+// Dispatch to unrolled kernels for small blocks of 1D & NIT solvers
+#define SWEEP_DISPATCH(kernel, mz, args) \
+  switch (mz) { \
+    case 1:  kernel<1> args;  break; \
+    case 2:  kernel<2> args;  break; \
+    case 3:  kernel<3> args;  break; \
+    case 4:  kernel<4> args;  break; \
+    default: kernel<0> args;  break; \
+  }
+
+void Sweep :: Solve(int NZ,int MZ, int key)
+{
+  int i,j,n;
+  double *pr, *qr, *bi, *bg;
+
+  InitWorkspace ();
+  const size_t pqStep = (size_t)MZ * PQ_LD;
+
+  // Top floor starts with the right boundary rows
+  for (i=1;i<= MZ;i++)
+    for (j=1;j<= 3*MZ+1;j++)
+      bz[i][j] = 0.0;
   RightBoundAppr(MZ,key);
-  goto Pr102;
-Pr102:
+
   for (n=NZ;n>=0;n--)
   {
-   if (n==1)  goto Pr104;
-   if (n==0)
-    {
-   for (i=1+MZ;i<= 2*MZ;i++)
-   for (j=1;j<= 3*MZ+1;j++)
-    bz[i][j] = 0.0;
-    goto Pr101;
-     }
-   m = n-1;
-   goto Pr105;
+    // Ground floor gets rows of node n-1
+    for (i=MZ+1;i<= 2*MZ;i++)
+      for (j=1;j<= 3*MZ+1;j++)
+        bz[i][j] = 0.0;
+    if (n > 1) {
+      MiddleAppr(n-1,MZ,key);
+    } else if (n == 1) {
+      LeftBoundAppr(MZ,key);
+      SWEEP_DISPATCH(substituteBlock, MZ, (bz, MZ, pz + 2 * pqStep, qz + 2 * pqStep, fz[2], PQ_LD));
+    }
 
-Pr104:    for (i=MZ+1;i<= 2*MZ;i++)
-    for (j=1;j<= 3*MZ+1;j++)
-    bz[i][j] = 0.0;
-   LeftBoundAppr(MZ,key);
-  for (k=1;k<= MZ;k++)
-  for (j=MZ+1;j<= 2*MZ;j++)
-  {
-   if ( bz[j][k] != 0.0)
-   {
-     for (i=1;i<= MZ;i++)
-     {
-       bz[j][i+MZ] = bz[j][i+MZ]-pz[2][k][i]*bz[j][k];
-       bz[j][i+2*MZ] = bz[j][i+2*MZ]-qz[2][k][i]*bz[j][k];
+    SWEEP_DISPATCH(eliminateBlock, MZ, (bz, MZ, (n > 0 ? 2*MZ : MZ)));
+
+    // Storing factors of node n
+    for (i=1;i<= MZ;i++) {
+      bi = bz[i];
+      fz[n][i] = bi[3*MZ+1];
+      if (n == 0)  continue;
+      pr = pz + n * pqStep + (i-1) * PQ_LD - 1;
+      qr = qz + n * pqStep + (i-1) * PQ_LD - 1;
+      SWEEP_SIMD
+      for (j=1;j<= MZ;j++)
+        pr[j] = bi[j+MZ];
+      if (n != 1) {
+        SWEEP_SIMD
+        for (j=1;j<= MZ;j++)
+          qr[j] = bi[j+2*MZ];
       }
-       bz[j][3*MZ+1] = bz[j][3*MZ+1]-(fz[2][k])*bz[j][k];
     }
-   }
-   for (i=1;i<=MZ;i++)
-   for (j=MZ+1;j<= 2*MZ;j++)
-     {
-     bz[j][i] = bz[j][i+MZ];
-     bz[j][i+MZ] = bz[j][i+2*MZ];
-     bz[j][i+2*MZ] = 0.0;
+    if (n == 0)  break;
+
+    // Remaining rows shifted to the top floor for the next node
+    for (i=1;i<= MZ;i++) {
+      bi = bz[i];
+      bg = bz[i+MZ];
+      bi[3*MZ+1] = bg[3*MZ+1];
+      SWEEP_SIMD
+      for (j=1;j<= 2*MZ;j++)
+        bi[j] = bg[j+MZ];
+      SWEEP_SIMD
+      for (j=2*MZ+1;j<= 3*MZ;j++)
+        bi[j] = 0.0;
     }
-     goto Pr101;
-Pr105:   for (i=MZ+1;i<= 2*MZ;i++)
-   for (j=1;j<= 3*MZ+1;j++)
-     bz[i][j] = 0.0;
-     MiddleAppr(m,MZ,key);
-       goto Pr101;
-
-Pr101:   for (l=1;l<= MZ;l++)
-    {
-       cz[1] = 0.0;
-      // Maximum searching
-	   for (i=l;i<= 2*MZ;i++)
-		   if ( fabs(bz[i][l])>fabs(cz[1]))
-     {
-       k = i;
-        cz[1] = bz[i][l];
-      }
-   // Maximum dividing & swapping
-        for (j=l;j<= 3*MZ+1;j++)
-    {
-      bz[k][j] = bz[k][j]/cz[1];
-        if (k != l)
-          { cz[2] = bz[k][j];
-      bz[k][j] = bz[l][j];
-      bz[l][j] = cz[2];
-           }
-     }
-       for (i=1;i<= 2*MZ;i++)
-   { if (i != l)
-     { cz[1] = bz[i][l];
-        for (j=l+1;j<= 3*MZ+1;j++)
-        bz[i][j] = bz[i][j]-bz[l][j]*cz[1];
-      }
-	}
-	}
-    for (i=1;i<= MZ;i++)
-  { (fz[n][i]) = bz[i][3*MZ+1];
-    if (n != 0)
-    { for (j=1;j<= MZ;j++)
-      { pz[n][i][j] = bz[i][j+MZ] ;
-        if (n != 1)
-      qz[n][i][j] = bz[i][j+2*MZ];
-       }
-     }
-   }
-    if (n==0)  goto Pr106;
-    for (i=1;i<= MZ;i++)
-    { bz[i][3*MZ+1] = bz[i+MZ][3*MZ+1];
-      for (j=1;j<= 2*MZ;j++)  bz[i][j] = bz[i+MZ][j+MZ];
-      for (j=2*MZ+1;j<= 3*MZ;j++)  bz[i][j] = 0.0;
-     }
-    }
-Pr106:
-     for (j=1;j<=MZ;j++)
-     for (i=1;i<=MZ;i++)
-     fz[1][j] = fz[1][j]-pz[1][j][i]*(fz[0][i]);
-     for (k=2;k<=NZ;k++)
-     for (j=1;j<=MZ;j++)
-     for (i=1;i<=MZ;i++)
-     fz[k][j] = fz[k][j]-pz[k][j][i]*(fz[k-1][i])-qz[k][j][i]*(fz[k-2][i]);
-
-   
-    
-   auxFree3Darray (pz,NZ,MZ);
-   auxFree3Darray (qz,NZ,MZ);
+  }
+
+  // Back substitution
+  if (NZ >= 1)
+    SWEEP_DISPATCH(backSubstBlock, MZ, (fz[1], fz[0], NULL, pz + pqStep, NULL, MZ, PQ_LD));
+  for (n=2;n<=NZ;n++)
+    SWEEP_DISPATCH(backSubstBlock, MZ, (fz[n], fz[n-1], fz[n-2], pz + n * pqStep, qz + n * pqStep, MZ, PQ_LD));
 }
 
 #define top_floor 1
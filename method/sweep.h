@@ -11,6 +11,18 @@ private:
   int BZ_I_DIM;
   int BZ_J_DIM; 
 
+  // Contiguous workspace: storage of bz & fz rows and elimination factors
+  void * bzRaw;
+  void * fzRaw;
+  void * pqRaw;
+  double * pz;
+  double * qz;
+  int PQ_LD;                               // aligned row length of pz, qz blocks
+  size_t workspaceSize;                     // bytes held by bz, pz & qz
+
+protected:
+  void InitWorkspace ();
+
 public:
   MCMatrix A;                 // Block matrices
   MCMatrix B;
@@ -25,12 +37,13 @@ public:
 
   void Initialize (int PointNum, int EqNum);
   virtual void Solve   (int, int, int );                               
-  void construction_bz(int num_eq, int flag);
+  virtual void construction_bz(int num_eq, int flag);
   void construction_from_fz(int N, int m,int key);
+  size_t getWorkspaceSize () const { return workspaceSize; }
 
  
   // array for results
-private:
+protected:
   virtual void LeftBoundAppr  (int,int);         // left boundary approximation
   virtual void MiddleAppr     (int, int,int);   // approximation in the middle node
   virtual void RightBoundAppr (int,int);        // right boundary approximation
@@ -6,12 +6,12 @@
 #include <map>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/SparseSweep.h"
 #include "model/3D/GasOil_3D/GasOil_3D.h"
 
 namespace gasOil_3d
 {
-	class GasOil3DSolver : public AbstractSolver<GasOil_3D>, public Sweep
+	class GasOil3DSolver : public AbstractSolver<GasOil_3D>, public SparseSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
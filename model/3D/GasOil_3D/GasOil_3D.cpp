@@ -4,114 +4,22 @@
 #include <cassert>
 
 using namespace std;
-using namespace std::placeholders;
 using namespace gasOil_3d;
 
 
 GasOil_3D::GasOil_3D()
 {
 	isWriteSnaps = false;
-
-	// Middle
-	middleFoo.mat.resize(2);
-
-	middleFoo.rhs.push_back(bind(&GasOil_3D::solve_eq1, this, _1));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1_ds_beta, this, _1, _2));
-
-	middleFoo.rhs.push_back(bind(&GasOil_3D::solve_eq2, this, _1));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2_ds_beta, this, _1, _2));
-
-	// Left
-	leftFoo.mat.resize(2);
-
-	leftFoo.rhs.push_back(bind(&GasOil_3D::solve_eq1Left, this, _1));
-	leftFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Left_dp, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Left_ds, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Left_dp_beta, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Left_ds_beta, this, _1, _2));
-
-	leftFoo.rhs.push_back(bind(&GasOil_3D::solve_eq2Left, this, _1));
-	leftFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Left_dp, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Left_ds, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Left_dp_beta, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Left_ds_beta, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Left_dp_beta, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Left_ds_beta, this, _1, _2));
-
-	// Right
-	rightFoo.mat.resize(2);
-
-	rightFoo.rhs.push_back(bind(&GasOil_3D::solve_eq1Right, this, _1));
-	rightFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Right_dp, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Right_ds, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Right_dp_beta, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Right_ds_beta, this, _1, _2));
-
-	rightFoo.rhs.push_back(bind(&GasOil_3D::solve_eq2Right, this, _1));
-	rightFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Right_dp, this, _1, _2));
-	rightFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Right_ds, this, _1, _2));
-	rightFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Right_dp_beta, this, _1, _2));
-	rightFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Right_ds_beta, this, _1, _2));
-
-	// Top
-	topFoo.mat.resize(2);
-
-	topFoo.rhs.push_back(bind(&GasOil_3D::solve_eq1Top, this, _1));
-	topFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Top_dp, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Top_ds, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Top_dp_beta, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Top_ds_beta, this, _1, _2));
-
-	topFoo.rhs.push_back(bind(&GasOil_3D::solve_eq2Top, this, _1));
-	topFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Top_dp, this, _1, _2));
-	topFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Top_ds, this, _1, _2));
-	topFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Top_dp_beta, this, _1, _2));
-	topFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Top_ds_beta, this, _1, _2));
-
-	// Bot
-	botFoo.mat.resize(2);
-
-	botFoo.rhs.push_back(bind(&GasOil_3D::solve_eq1Bot, this, _1));
-	botFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Bot_dp, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Bot_ds, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Bot_dp_beta, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&GasOil_3D::solve_eq1Bot_ds_beta, this, _1, _2));
-
-	botFoo.rhs.push_back(bind(&GasOil_3D::solve_eq2Bot, this, _1));
-	botFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Bot_dp, this, _1, _2));
-	botFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Bot_ds, this, _1, _2));
-	botFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Bot_dp_beta, this, _1, _2));
-	botFoo.mat[1].push_back(bind(&GasOil_3D::solve_eq2Bot_ds_beta, this, _1, _2));
 }
 
 GasOil_3D::~GasOil_3D()
 {
+	releaseDataset(props_oil.kr);
+	releaseDataset(props_gas.kr);
+	releaseDataset(props_oil.b);
+	releaseDataset(props_gas.b);
+	releaseDataset(Rs);
+	releaseDataset(Prs);
 }
 
 void GasOil_3D::setProps(Properties& props)
@@ -449,6 +357,36 @@ void GasOil_3D::setPeriod(int period)
 		props_sk[i].perm_eff = props_sk[i].perms_eff[period];
 		props_sk[i].skin = props_sk[i].skins[period];
 	}
+
+	buildTrans();
+}
+
+void GasOil_3D::buildTrans()
+{
+	const int layer = (cellsNum_r + 2) * (cellsNum_z + 2);
+	int neighbor[6];
+	int r_idx, z_idx;
+
+	trans.resize(6 * cellsNum);
+	for (int i = 0; i < cellsNum; i++)
+	{
+		r_idx = (i % layer) / (cellsNum_z + 2);
+		z_idx = i % (cellsNum_z + 2);
+		neighbor[0] = (r_idx > 0 ? i - cellsNum_z - 2 : -1);
+		neighbor[1] = (r_idx < cellsNum_r + 1 ? i + cellsNum_z + 2 : -1);
+		neighbor[2] = (z_idx > 0 ? i - 1 : -1);
+		neighbor[3] = (z_idx < cellsNum_z + 1 ? i + 1 : -1);
+		neighbor[4] = (i < layer ? i + layer * (cellsNum_phi - 1) : i - layer);
+		neighbor[5] = (i < layer * (cellsNum_phi - 1) ? i + layer : i - layer * (cellsNum_phi - 1));
+
+		for (int j = 0; j < 6; j++)
+		{
+			if (neighbor[j] < 0)
+				trans[6 * i + j] = 0.0;
+			else
+				trans[6 * i + j] = calcTrans(cells[i], cells[neighbor[j]]);
+		}
+	}
 }
 
 void GasOil_3D::setRateDeviation(int num, double ratio)
@@ -491,23 +429,24 @@ double GasOil_3D::solve_eq1_dp(int cur, int beta)
 
 	Cell& cell = cells[cur];
 	Var2phase& next = cell.u_next;
-	double Boil_upwd;
-	double Boil = getB_oil(next.p, next.p_bub, next.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	double Boil, Boil_dp;
+	getB_oil(next.p, next.p_bub, next.SATUR, Boil, Boil_dp);
 	
 	double H = 0.0;
 	H = (next.s * getPoro_dp(cell) - 
-		getPoro(next.p, cell) * next.s * getB_oil_dp(next.p, next.p_bub, next.SATUR) / Boil ) / Boil;
+		getPoro(next.p, cell) * next.s * Boil_dp / Boil ) / Boil;
 
 	for(int i = 0; i < 6; i++)
 	{
 		upwind = upwindIsCur(cur, neighbor[i]);
 		Var2phase& upwd = cells[ getUpwindIdx(cur, neighbor[i]) ].u_next;
-		Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
+		getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
 		Cell& beta = cells[ neighbor[i] ];
 
 		H += ht / cell.V * getTrans(cell, beta) * 
 			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd - 
-			upwind * (next.p - beta.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) );
+			upwind * (next.p - beta.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * Boil_upwd_dp );
 	}
 	return H;
 }
@@ -543,11 +482,12 @@ double GasOil_3D::solve_eq1_dp_beta(int cur, int beta)
 
 	double upwind = upwindIsCur(cur, beta);
 	Var2phase& upwd = cells[ getUpwindIdx(cur, beta) ].u_next;
-	double Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
 
 	return -ht / cell.V * getTrans(cell, cells[beta]) * 
 			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd + 
-			(1.0 - upwind) * (cell.u_next.p - cells[beta].u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) );
+			(1.0 - upwind) * (cell.u_next.p - cells[beta].u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * Boil_upwd_dp );
 }
 
 double GasOil_3D::solve_eq1_ds_beta(int cur, int beta)
@@ -595,31 +535,34 @@ double GasOil_3D::solve_eq2_dp(int cur, int beta)
 
 	Cell& cell = cells[cur];
 	Var2phase& next = cell.u_next;
-	double Boil_upwd, Bgas_upwd, rs_upwd;
-	double Boil = getB_oil(next.p, next.p_bub, next.SATUR);
-	double Bgas = getB_gas(next.p);
-	double rs = getRs(next.p, next.p_bub, next.SATUR);
+	double Boil_upwd, Boil_upwd_dp, Bgas_upwd, Bgas_upwd_dp, rs_upwd, rs_upwd_dp;
+	double Boil, Boil_dp;
+	getB_oil(next.p, next.p_bub, next.SATUR, Boil, Boil_dp);
+	double Bgas, Bgas_dp;
+	getB_gas(next.p, Bgas, Bgas_dp);
+	double rs, rs_dp;
+	getRs(next.p, next.p_bub, next.SATUR, rs, rs_dp);
 	
 	double H = 0.0;
 	H = ( (next.s * rs / Boil + (1.0 - next.s) / Bgas) * getPoro_dp(cell) - 
-		getPoro(next.p, cell) * ( (1.0 - next.s) / Bgas / Bgas * getB_gas_dp(next.p) + 
-		next.s * rs / Boil / Boil * getB_oil_dp(next.p, next.p_bub, next.SATUR) - 
-		next.s / Boil * getRs_dp(next.p, next.p_bub, next.SATUR) ) );
+		getPoro(next.p, cell) * ( (1.0 - next.s) / Bgas / Bgas * Bgas_dp + 
+		next.s * rs / Boil / Boil * Boil_dp - 
+		next.s / Boil * rs_dp ) );
 
 	for(int i = 0; i < 6; i++)
 	{
 		upwind = upwindIsCur(cur, neighbor[i]);
 		Var2phase& upwd = cells[ getUpwindIdx(cur, neighbor[i]) ].u_next;
-		Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
-		Bgas_upwd = getB_gas(upwd.p);
-		rs_upwd = getRs(upwd.p, upwd.p_bub, upwd.SATUR);
+		getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
+		getB_gas(upwd.p, Bgas_upwd, Bgas_upwd_dp);
+		getRs(upwd.p, upwd.p_bub, upwd.SATUR, rs_upwd, rs_upwd_dp);
 		Cell& beta = cells[ neighbor[i] ];
 
 		H += ht / cell.V * getTrans(cell, beta) * 
 			( getKr_oil(upwd.s) * rs_upwd / props_oil.visc / Boil_upwd + getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd + 
 			upwind * (next.p - beta.u_next.p) * 
-			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (getRs_dp(upwd.p, upwd.p_bub, upwd.SATUR) - rs_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) / Boil_upwd) - 
-			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * getB_gas_dp(upwd.p) ));
+			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp ));
 	}
 
 	return H;
@@ -657,15 +600,18 @@ double GasOil_3D::solve_eq2_dp_beta(int cur, int beta)
 
 	double upwind = upwindIsCur(cur, beta);
 	Var2phase& upwd = cells[ getUpwindIdx(cur, beta) ].u_next;
-	double Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
-	double Bgas_upwd = getB_gas(upwd.p);
-	double rs_upwd = getRs(upwd.p, upwd.p_bub, upwd.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
+	double Bgas_upwd, Bgas_upwd_dp;
+	getB_gas(upwd.p, Bgas_upwd, Bgas_upwd_dp);
+	double rs_upwd, rs_upwd_dp;
+	getRs(upwd.p, upwd.p_bub, upwd.SATUR, rs_upwd, rs_upwd_dp);
 
 	return -ht / cell.V * getTrans(cell, cells[beta]) * 
 			( getKr_oil(upwd.s) * rs_upwd / props_oil.visc / Boil_upwd + getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd - 
 			(1.0 - upwind) * (cells[cur].u_next.p - cells[beta].u_next.p) * 
-			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (getRs_dp(upwd.p, upwd.p_bub, upwd.SATUR) - rs_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) / Boil_upwd) - 
-			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * getB_gas_dp(upwd.p) ));
+			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp ));
 }
 
 double GasOil_3D::solve_eq2_ds_beta(int cur, int beta)
@@ -680,6 +626,129 @@ double GasOil_3D::solve_eq2_ds_beta(int cur, int beta)
 		getKr_gas_ds(upwd.s) / props_gas.visc / getB_gas(upwd.p) );
 }
 
+void GasOil_3D::solve_eqMiddle(int cur, double* const res, double* const jac)
+{
+	int neighbor [6];
+	getNeighborIdx(cur, neighbor);
+
+	Cell& cell = cells[cur];
+	Var2phase& next = cell.u_next;
+	Var2phase& prev = cell.u_prev;
+
+	double* const jac1 = jac;
+	double* const jac2 = jac + 14;
+
+	// Accumulation terms, properties of the current layer are taken from the cache
+	const double poro = getPoro(next.p, cell);
+	const double poro_dp = getPoro_dp(cell);
+	const double Boil = cache.b_oil[cur];
+	const double Boil_dp = cache.b_oil_dp[cur];
+	const double Bgas = cache.b_gas[cur];
+	const double Bgas_dp = cache.b_gas_dp[cur];
+	const double rs = cache.rs[cur];
+	const double rs_dp = cache.rs_dp[cur];
+
+	res[0] = poro * next.s / Boil - 
+				getPoro(prev.p, cell) * prev.s / getB_oil(prev.p, prev.p_bub, prev.SATUR);
+	res[1] = poro * ( (1.0 - next.s) / Bgas + next.s * rs / Boil ) -
+				getPoro(prev.p, cell) * ( (1.0 - prev.s) / getB_gas(prev.p) + prev.s * getRs(prev.p, prev.p_bub, prev.SATUR) / getB_oil(prev.p, prev.p_bub, prev.SATUR) );
+
+	jac1[0] = (next.s * poro_dp - poro * next.s * Boil_dp / Boil) / Boil;
+	jac1[1] = poro / Boil;
+	jac2[0] = (next.s * rs / Boil + (1.0 - next.s) / Bgas) * poro_dp - 
+		poro * ( (1.0 - next.s) / Bgas / Bgas * Bgas_dp + next.s * rs / Boil / Boil * Boil_dp - next.s / Boil * rs_dp );
+	jac2[1] = poro * (rs / Boil - 1.0 / Bgas);
+
+	// Fluxes: face quantities are evaluated once for residuals and all derivatives
+	for(int i = 0; i < 6; i++)
+	{
+		Cell& beta = cells[ neighbor[i] ];
+		const double upwind = upwindIsCur(cur, neighbor[i]);
+		const int upwd = getUpwindIdx(cur, neighbor[i]);
+
+		const double trans = ht / cell.V * getTrans(cell, beta);
+		const double dp = next.p - beta.u_next.p;
+
+		const double Boil_upwd = cache.b_oil[upwd];
+		const double Boil_upwd_dp = cache.b_oil_dp[upwd];
+		const double Bgas_upwd = cache.b_gas[upwd];
+		const double Bgas_upwd_dp = cache.b_gas_dp[upwd];
+		const double rs_upwd = cache.rs[upwd];
+		const double rs_upwd_dp = cache.rs_dp[upwd];
+		const double kr_oil = cache.kr_oil[upwd];
+		const double kr_oil_ds = cache.kr_oil_ds[upwd];
+		const double kr_gas = cache.kr_gas[upwd];
+		const double kr_gas_ds = cache.kr_gas_ds[upwd];
+
+		// Upwind mobilities of oil and of gas component with their derivatives
+		const double mob1 = kr_oil / props_oil.visc / Boil_upwd;
+		const double mob1_dp = -mob1 / Boil_upwd * Boil_upwd_dp;
+		const double mob1_ds = kr_oil_ds / props_oil.visc / Boil_upwd;
+		const double mob2 = mob1 * rs_upwd + kr_gas / props_gas.visc / Bgas_upwd;
+		const double mob2_dp = mob1 * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			kr_gas / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp;
+		const double mob2_ds = rs_upwd * mob1_ds + kr_gas_ds / props_gas.visc / Bgas_upwd;
+
+		res[0] += trans * dp * mob1;
+		res[1] += trans * dp * mob2;
+
+		jac1[0] += trans * (mob1 + upwind * dp * mob1_dp);
+		jac1[1] += trans * upwind * dp * mob1_ds;
+		jac1[2 * i + 2] = -trans * (mob1 - (1.0 - upwind) * dp * mob1_dp);
+		jac1[2 * i + 3] = trans * (1.0 - upwind) * dp * mob1_ds;
+
+		jac2[0] += trans * (mob2 + upwind * dp * mob2_dp);
+		jac2[1] += trans * upwind * dp * mob2_ds;
+		jac2[2 * i + 2] = -trans * (mob2 - (1.0 - upwind) * dp * mob2_dp);
+		jac2[2 * i + 3] = trans * (1.0 - upwind) * dp * mob2_ds;
+	}
+}
+
+void GasOil_3D::fillProps()
+{
+	if ((int)cache.b_oil.size() != cellsNum)
+	{
+		cache.p.resize(cellsNum);			cache.p_tab.resize(cellsNum);		cache.s.resize(cellsNum);
+		cache.b_oil.resize(cellsNum);		cache.b_oil_dp.resize(cellsNum);
+		cache.b_gas.resize(cellsNum);		cache.b_gas_dp.resize(cellsNum);
+		cache.rs.resize(cellsNum);			cache.rs_dp.resize(cellsNum);
+		cache.kr_oil.resize(cellsNum);		cache.kr_oil_ds.resize(cellsNum);
+		cache.kr_gas.resize(cellsNum);		cache.kr_gas_ds.resize(cellsNum);
+	}
+
+	// Table arguments: bubble point pressure for undersaturated oil, saturation is limited by 1
+	for (int i = 0; i < cellsNum; i++)
+	{
+		const Var2phase& next = cells[i].u_next;
+		cache.p[i] = next.p;
+		cache.p_tab[i] = (next.SATUR ? next.p : next.p_bub);
+		cache.s[i] = (next.s > 1.0 ? 1.0 : next.s);
+	}
+
+	props_oil.b->Solve(&cache.p_tab[0], &cache.b_oil[0], &cache.b_oil_dp[0], cellsNum);
+	props_gas.b->Solve(&cache.p[0], &cache.b_gas[0], &cache.b_gas_dp[0], cellsNum);
+	Rs->Solve(&cache.p_tab[0], &cache.rs[0], &cache.rs_dp[0], cellsNum);
+	props_oil.kr->Solve(&cache.s[0], &cache.kr_oil[0], &cache.kr_oil_ds[0], cellsNum);
+	props_gas.kr->Solve(&cache.s[0], &cache.kr_gas[0], &cache.kr_gas_ds[0], cellsNum);
+
+	// The same branches as in getB_oil, getRs & getKr_*
+	for (int i = 0; i < cellsNum; i++)
+	{
+		const Var2phase& next = cells[i].u_next;
+		if (!next.SATUR)
+		{
+			cache.b_oil_dp[i] = -cache.b_oil[i] * props_oil.beta;
+			cache.b_oil[i] *= 1.0 + props_oil.beta * (next.p_bub - next.p);
+			cache.rs_dp[i] = 0.0;
+		}
+		if (next.s > 1.0)
+		{
+			cache.kr_oil[i] = 1.0;
+			cache.kr_gas[i] = 0.0;
+		}
+	}
+}
+
 double GasOil_3D::solveH()
 {
 	double H = 0.0;
@@ -113,18 +113,18 @@ namespace gasOil_3d
 
 		double depth_point;
 
-		// Data set (saturation, relative oil permeability)
-		std::vector< std::pair<double,double> > kr_oil;
-		// Data set (saturation, relative gas permeability)
-		std::vector< std::pair<double,double> > kr_gas;
-
-		// Data set (pressure, oil volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > B_oil;
-		// Data set (pressure, gas volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > B_gas;
-
-		// Data set (pressure, gas content in oil) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > Rs;
+		// Data set file (saturation, relative oil permeability)
+		std::string kr_oil;
+		// Data set file (saturation, relative gas permeability)
+		std::string kr_gas;
+
+		// Data set file (pressure, oil volume factor) ([Pa], [m3/m3])
+		std::string B_oil;
+		// Data set file (pressure, gas volume factor) ([Pa], [m3/m3])
+		std::string B_gas;
+
+		// Data set file (pressure, gas content in oil) ([Pa], [m3/m3])
+		std::string Rs;
 	};
 
 	class GasOil_3D : public AbstractModel<Var2phase, Properties, CylCell3D, GasOil_3D>
@@ -273,7 +273,44 @@ namespace gasOil_3d
 			const int idx = getSkeletonIdx(cell);
 			return props_sk[idx].m * props_sk[idx].beta;
 		};
-		inline double getTrans(Cell& cell, Cell& beta)
+		// trans[6 * i + j] - transmissibility of i-th cell face towards its j-th neighbour (r-, r+, z-, z+, phi-, phi+).
+		// Near-well faces take perm_eff of the current period, so setPeriod() is the only place to build them
+		std::vector<double> trans;
+		void buildTrans();
+		// Fluid properties of u_next layer in SoA form. Refreshed by fillProps() before every assembly,
+		// so the middle stencil reads contiguous arrays instead of searching tables per face
+		struct PropsCache
+		{
+			// Table arguments
+			std::vector<double> p, p_tab, s;
+
+			std::vector<double> b_oil, b_oil_dp;
+			std::vector<double> b_gas, b_gas_dp;
+			std::vector<double> rs, rs_dp;
+			std::vector<double> kr_oil, kr_oil_ds;
+			std::vector<double> kr_gas, kr_gas_ds;
+		};
+		PropsCache cache;
+		void fillProps();
+		inline int getFaceIdx(const int cur, const int beta) const
+		{
+			const int layer = (cellsNum_r + 2) * (cellsNum_z + 2);
+			const int diff = beta - cur;
+
+			if (diff == -cellsNum_z - 2)
+				return 0;
+			else if (diff == cellsNum_z + 2)
+				return 1;
+			else if (diff == -1)
+				return 2;
+			else if (diff == 1)
+				return 3;
+			else if (diff == -layer || diff == layer * (cellsNum_phi - 1))
+				return 4;
+			else
+				return 5;
+		};
+		inline double calcTrans(Cell& cell, Cell& beta)
 		{
 			double k1, k2, S;
 			const int idx1 = getSkeletonIdx(cell);
@@ -301,6 +338,10 @@ namespace gasOil_3d
 				return 2.0 * k1 * S / (beta.hr + cell.hr);
 			}
 		};
+		inline double getTrans(Cell& cell, Cell& beta)
+		{
+			return trans[6 * cell.num + getFaceIdx(cell.num, beta.num)];
+		};
 		inline double getPerm_r(const Cell& cell) const
 		{
 			const int idx = getSkeletonIdx(cell);
@@ -375,6 +416,50 @@ namespace gasOil_3d
 			else
 				return 0.0;
 		};
+		// Fused value & derivative getters, one table search per call
+		inline void getKr_oil(double sat_oil, double& kr, double& kr_ds) const
+		{
+			if(sat_oil > 1.0)
+			{
+				kr = 1.0;
+				kr_ds = props_oil.kr->DSolve(1.0);
+			} else
+				props_oil.kr->Solve(sat_oil, kr, kr_ds);
+		};
+		inline void getKr_gas(double sat_oil, double& kr, double& kr_ds) const
+		{
+			if(sat_oil > 1.0)
+			{
+				kr = 0.0;
+				kr_ds = props_gas.kr->DSolve(1.0);
+			} else
+				props_gas.kr->Solve(sat_oil, kr, kr_ds);
+		};
+		inline void getB_oil(double p, double p_bub, bool SATUR, double& b, double& b_dp) const
+		{
+			if(SATUR)
+				props_oil.b->Solve(p, b, b_dp);
+			else
+			{
+				const double b_bub = props_oil.b->Solve(p_bub);
+				b = b_bub * (1.0 + props_oil.beta * (p_bub - p));
+				b_dp = -b_bub * props_oil.beta;
+			}
+		};
+		inline void getB_gas(double p, double& b, double& b_dp) const
+		{
+			props_gas.b->Solve(p, b, b_dp);
+		};
+		inline void getRs(double p, double p_bub, bool SATUR, double& rs, double& rs_dp) const
+		{
+			if(SATUR)
+				Rs->Solve(p, rs, rs_dp);
+			else
+			{
+				rs = Rs->Solve(p_bub);
+				rs_dp = 0.0;
+			}
+		};
 		inline double getPresFromRs(double rs) const
 		{
 			return Prs->Solve(rs);
@@ -538,6 +623,11 @@ namespace gasOil_3d
 		double solve_eq2_dp_beta(int cur, int beta);
 		double solve_eq2_ds_beta(int cur, int beta);
 
+		// Both residuals and their derivatives over getStencilIdx() stencil in one pass,
+		// jac[14 * i + 2 * j] & jac[14 * i + 2 * j + 1] are d(eq_i) / dp & ds of j-th stencil cell.
+		// Expects fillProps() to be called for the current iteration
+		void solve_eqMiddle(int cur, double* const res, double* const jac);
+
 		/*-------------- Left cells ------------------*/
 
 		inline double solve_eq1Left(int cur)
@@ -821,12 +911,6 @@ namespace gasOil_3d
 		// Finds functional
 		double solveH();
 
-		FillFoo middleFoo;
-		FillFoo rightFoo;
-		FillFoo leftFoo;
-		FillFoo topFoo;
-		FillFoo botFoo;
-
 	public:
 		GasOil_3D();
 		~GasOil_3D();
@@ -5,7 +5,7 @@
 using namespace std;
 using namespace gasOil_3d;
 
-Par3DSolver::Par3DSolver(GasOil_3D* _model) : AbstractSolver<GasOil_3D>(_model)
+Par3DSolver::Par3DSolver(GasOil_3D* _model, const ParSolverConfig* config) : AbstractSolver<GasOil_3D>(_model)
 {
 	// Output streams
 	plot_Pdyn.open("snaps/P_dyn.dat", ofstream::out);
@@ -27,13 +27,22 @@ Par3DSolver::Par3DSolver(GasOil_3D* _model) : AbstractSolver<GasOil_3D>(_model)
 	// Memory allocating
 	ind_i = new int[7 * 4 * model->cellsNum];
 	ind_j = new int[7 * 4 * model->cellsNum];
-	a = new double[7 * 4 * model->cellsNum];
-	ind_rhs = new int[2 * model->cellsNum];
 	rhs = new double[2 * model->cellsNum];
 
 	// Stencils allocating
 	stencils = new UsedStencils<GasOil_3D>(model);
-	stencils->setStorages(a, ind_i, ind_j, rhs);
+	stencils->setIndexStorages(ind_i, ind_j);
+
+	// Rejected config falls back to the defaults
+	if (config == NULL || !solver.setConfig(*config))
+		solver.setConfig(getDefaultConfig());
+}
+
+ParSolverConfig Par3DSolver::getDefaultConfig()
+{
+	// Pressure-saturation point blocks
+	ParSolverConfig config(PRECOND_CPR, 2);
+	return config;
 }
 
 Par3DSolver::~Par3DSolver()
@@ -42,6 +51,12 @@ Par3DSolver::~Par3DSolver()
 	plot_Pdyn.close();
 	plot_Sdyn.close();
 	plot_qcells.close();
+
+	// Releasing buffers
+	delete stencils;
+	delete[] ind_i;
+	delete[] ind_j;
+	delete[] rhs;
 }
 
 void Par3DSolver::writeData()
@@ -69,6 +84,7 @@ void Par3DSolver::writeData()
 
 void Par3DSolver::control()
 {
+	const double ht_prev = model->ht;
 	writeData();
 
 	if (cur_t >= model->period[curTimePeriod])
@@ -76,6 +92,7 @@ void Par3DSolver::control()
 		curTimePeriod++;
 		model->ht = model->ht_min;
 		model->setPeriod(curTimePeriod);
+		solver.setNewPeriod();
 	}
 
 	if (model->ht <= model->ht_max && iterations < 6)
@@ -87,6 +104,7 @@ void Par3DSolver::control()
 		model->ht = model->period[curTimePeriod] - cur_t;
 
 	cur_t += model->ht;
+	solver.setNewTimeStep(model->ht / ht_prev);
 }
 
 void Par3DSolver::start()
@@ -94,8 +112,13 @@ void Par3DSolver::start()
 	int counter = 0;
 	iterations = 8;
 
-	fillIndices();
 	solver.Init(2 * model->cellsNum);
+	fillIndices();
+	solver.setPattern(ind_i, ind_j, elemNum);
+	delete[] ind_i;
+	delete[] ind_j;
+	ind_i = ind_j = NULL;
+	stencils->setIndexStorages(NULL, NULL);
 
 	model->setPeriod(curTimePeriod);
 	while (cur_t < Tt)
@@ -110,6 +133,7 @@ void Par3DSolver::start()
 	if (model->isWriteSnaps)
 		model->snapshot_all(counter++);
 	writeData();
+	solver.getRunStats().print("Linear solver run");
 }
 
 void Par3DSolver::doNextStep()
@@ -168,13 +192,15 @@ void Par3DSolver::solveStep()
 	double averPres, averSat;
 	double dAverPres = 1.0, dAverSat = 1.0;
 
+	solver.setNewNewtonLoop();
 	iterations = 0;
 	while (err_newton > 1.e-4 && /*(dAverSat > 1.e-8 || dAverPres > 1.e-4) &&*/ iterations < 10)
 	{
 		copyIterLayer();
 
+		a = solver.beginAssemble();
 		fill();
-		solver.Assemble(ind_i, ind_j, a, elemNum, ind_rhs, rhs);
+		solver.Assemble(rhs);
 		solver.Solve();
 		copySolution( solver.getSolution() );
 
@@ -204,6 +230,8 @@ void Par3DSolver::fillIndices()
 	Iterator it;
 	map<int, double>::iterator itPerf;
 
+	plan.clear();
+
 	// Left
 	for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
 	{
@@ -211,6 +239,7 @@ void Par3DSolver::fillIndices()
 		itPerf = model->Qcell.find(idx);
 		if (itPerf == model->Qcell.end())
 		{
+			plan.push_back({ idx, FILL_BOUND, counter });
 			nebr = idx + model->cellsNum_z + 2;
 			ind_i[counter] = 2 * idx;
 			ind_j[counter++] = 2 * idx;
@@ -237,7 +266,10 @@ void Par3DSolver::fillIndices()
 			ind_j[counter++] = 2 * nebr + 1;
 		}
 		else
+		{
+			plan.push_back({ idx, FILL_LEFT, counter });
 			stencils->left->fillIndex(idx, &counter);
+		}
 	}
 
 	// Middle
@@ -247,209 +279,84 @@ void Par3DSolver::fillIndices()
 		idx = it.getIdx();
 		res = idx % (model->cellsNum_z + 2);
 		if( res == 0 )
+		{
+			plan.push_back({ idx, FILL_TOP, counter });
 			stencils->top->fillIndex(idx, &counter);
+		}
 		else if( res == model->cellsNum_z + 1)
+		{
+			plan.push_back({ idx, FILL_BOT, counter });
 			stencils->bot->fillIndex(idx, &counter);
+		}
 		else
-			stencils->middle->fillIndex(idx, &counter);	
+		{
+			plan.push_back({ idx, FILL_MIDDLE, counter });
+			stencils->middle->fillIndex(idx, &counter);
+		}
 	}
 
 	// Right
 	for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
 	{
 		idx = it.getIdx();
+		plan.push_back({ idx, FILL_RIGHT, counter });
 		stencils->right->fillIndex(idx, &counter);
 	}
 
-	/*// Left
-	for (int i = 0; i < model->cellsNum_phi; i++)
-	{
-		idx = i * (model->cellsNum_r + 2) * (model->cellsNum_z + 2);
-		for (int j = 0; j < model->cellsNum_z + 2; j++)
-		{
-			it = model->Qcell.find(idx);
-			if (it == model->Qcell.end())
-			{
-				nebr = idx + model->cellsNum_z + 2;
-				ind_i[counter] = 2 * idx;
-				ind_j[counter++] = 2 * idx;
-
-				ind_i[counter] = 2 * idx;
-				ind_j[counter++] = 2 * idx + 1;
-
-				ind_i[counter] = 2 * idx;
-				ind_j[counter++] = 2 * nebr;
-
-				ind_i[counter] = 2 * idx;
-				ind_j[counter++] = 2 * nebr + 1;
-
-				ind_i[counter] = 2 * idx + 1;
-				ind_j[counter++] = 2 * idx;
-
-				ind_i[counter] = 2 * idx + 1;
-				ind_j[counter++] = 2 * idx + 1;
-
-				ind_i[counter] = 2 * idx + 1;
-				ind_j[counter++] = 2 * nebr;
-
-				ind_i[counter] = 2 * idx + 1;
-				ind_j[counter++] = 2 * nebr + 1;
-			}
-			else
-				stencils->left->fillIndex(idx, &counter);
-
-			idx++;
-		}
-	}
-
-	// Middle
-	for (int i = 0; i < model->cellsNum_phi; i++)
-	{
-		idx = i * (model->cellsNum_r + 2) * (model->cellsNum_z + 2) + model->cellsNum_z + 2;
-		for (int j = 1; j < model->cellsNum_r + 1; j++)
-		{
-			stencils->top->fillIndex(idx, &counter);
-			idx++;
-			for (int k = 1; k < model->cellsNum_z + 1; k++)
-			{
-				stencils->middle->fillIndex(idx, &counter);
-				idx++;
-			}
-			stencils->bot->fillIndex(idx, &counter);
-			idx++;
-		}
-	}
-
-	// Right
-	for (int i = 0; i < model->cellsNum_phi; i++)
-	{
-		idx = i * (model->cellsNum_r + 2) * (model->cellsNum_z + 2) + (model->cellsNum_r + 1) * (model->cellsNum_z + 2);
-		for (int j = 0; j < model->cellsNum_z + 2; j++)
-		{
-			stencils->right->fillIndex(idx, &counter);
-			idx++;
-		}
-	}*/
-
 	elemNum = counter;
-
-	for (int i = 0; i < 2*model->cellsNum; i++)
-		ind_rhs[i] = i;
 }
 
 void Par3DSolver::fill()
 {
-	int idx;
-	int counter = 0;
-	Iterator it;
-	map<int, double>::iterator itPerf;
-
-	// Left
-	for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
-	{
-		idx = it.getIdx();
-		itPerf = model->Qcell.find(idx);
-		if (itPerf == model->Qcell.end())
-		{
-			a[counter++] = 1.0;
-			a[counter++] = 0.0;
-			a[counter++] = -1.0;
-			a[counter++] = 0.0;
-
-			a[counter++] = 0.0;
-			a[counter++] = 1.0;
-			a[counter++] = 0.0;
-			a[counter++] = -1.0;
-
-			rhs[2 * idx] = 0.0;
-			rhs[2 * idx + 1] = 0.0;
-		}
-		else
-			stencils->left->fill(idx, &counter);
-	}
+	model->fillProps();
+	stencils->setValueStorages(a, solver.getSlots(), rhs);
 
-	// Middle
-	int res;
-	for (it = model->getMidBegin(); it != model->getMidEnd(); ++it)
+	const int cellsNum = (int)plan.size();
+	#pragma omp parallel for num_threads(fillThreads) schedule(static)
+	for (int k = 0; k < cellsNum; k++)
 	{
-		idx = it.getIdx();
-		res = idx % (model->cellsNum_z + 2);
-		if (res == 0)
-			stencils->top->fill(idx, &counter);
-		else if (res == model->cellsNum_z + 1)
-			stencils->bot->fill(idx, &counter);
-		else
-			stencils->middle->fill(idx, &counter);
+		int counter = plan[k].offset;
+		fillCell(plan[k], &counter);
 	}
+}
 
-	// Right
-	for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
-	{
-		idx = it.getIdx();
-		stencils->right->fill(idx, &counter);
-	}
-
-	/*int idx;
-	int counter = 0;
-	map<int, double>::iterator it;
-
-	// Left
-	for (int i = 0; i < model->cellsNum_phi; i++)
-	{
-		idx = i * (model->cellsNum_r + 2) * (model->cellsNum_z + 2);
-		for (int j = 0; j < model->cellsNum_z + 2; j++)
-		{
-			it = model->Qcell.find(idx);
-			if (it == model->Qcell.end())
-			{
-				a[counter++] = 1.0;
-				a[counter++] = 0.0;
-				a[counter++] = -1.0;
-				a[counter++] = 0.0;
-
-				a[counter++] = 0.0;
-				a[counter++] = 1.0;
-				a[counter++] = 0.0;
-				a[counter++] = -1.0;
-
-				rhs[2 * idx] = 0.0;
-				rhs[2 * idx + 1] = 0.0;
-			}
-			else
-				stencils->left->fill(idx, &counter);
-
-			idx++;
-		}
-	}
+void Par3DSolver::fillCell(const FillCell& cell, int* counter)
+{
+	const int idx = cell.idx;
+	const int* slots = solver.getSlots();
 
-	// Middle
-	for (int i = 0; i < model->cellsNum_phi; i++)
+	switch (cell.type)
 	{
-		idx = i * (model->cellsNum_r + 2) * (model->cellsNum_z + 2) + model->cellsNum_z + 2;
-		for (int j = 1; j < model->cellsNum_r + 1; j++)
-		{
-			stencils->top->fill(idx, &counter);
-			idx++;
-			for (int k = 1; k < model->cellsNum_z + 1; k++)
-			{	
-				stencils->middle->fill(idx, &counter);
-				idx++;
-			}
-			stencils->bot->fill(idx, &counter);
-			idx++;
-		}
+	case FILL_BOUND:
+		a[slots[(*counter)++]] += 1.0;
+		a[slots[(*counter)++]] += 0.0;
+		a[slots[(*counter)++]] += -1.0;
+		a[slots[(*counter)++]] += 0.0;
+
+		a[slots[(*counter)++]] += 0.0;
+		a[slots[(*counter)++]] += 1.0;
+		a[slots[(*counter)++]] += 0.0;
+		a[slots[(*counter)++]] += -1.0;
+
+		rhs[2 * idx] = 0.0;
+		rhs[2 * idx + 1] = 0.0;
+		break;
+	case FILL_LEFT:
+		stencils->left->fill(idx, counter);
+		break;
+	case FILL_TOP:
+		stencils->top->fill(idx, counter);
+		break;
+	case FILL_BOT:
+		stencils->bot->fill(idx, counter);
+		break;
+	case FILL_MIDDLE:
+		stencils->middle->fill(idx, counter);
+		break;
+	case FILL_RIGHT:
+		stencils->right->fill(idx, counter);
+		break;
 	}
-
-	// Right
-	for (int i = 0; i < model->cellsNum_phi; i++)
-	{
-		idx = i * (model->cellsNum_r + 2) * (model->cellsNum_z + 2) + (model->cellsNum_r + 1) * (model->cellsNum_z + 2);
-		for (int j = 0; j < model->cellsNum_z + 2; j++)
-		{
-			stencils->right->fill(idx, &counter);
-			idx++;
-		}
-	}*/
 }
 
 void Par3DSolver::fillq()
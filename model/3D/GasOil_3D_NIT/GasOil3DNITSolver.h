@@ -6,12 +6,12 @@
 #include <map>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/SparseSweep.h"
 #include "model/3D/GasOil_3D_NIT/GasOil_3D_NIT.h"
 
 namespace gasOil_3d_NIT
 {
-	class GasOil3DNITSolver : public AbstractSolver<GasOil_3D_NIT>, public Sweep
+	class GasOil3DNITSolver : public AbstractSolver<GasOil_3D_NIT>, public SparseSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
@@ -134,18 +134,18 @@ namespace gasOil_3d_NIT
 
 		double depth_point;
 
-		// Data set (saturation, relative oil permeability)
-		std::vector< std::pair<double,double> > kr_oil;
-		// Data set (saturation, relative gas permeability)
-		std::vector< std::pair<double,double> > kr_gas;
+		// Data set file (saturation, relative oil permeability)
+		std::string kr_oil;
+		// Data set file (saturation, relative gas permeability)
+		std::string kr_gas;
 
-		// Data set (pressure, oil volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > B_oil;
-		// Data set (pressure, gas volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > B_gas;
+		// Data set file (pressure, oil volume factor) ([Pa], [m3/m3])
+		std::string B_oil;
+		// Data set file (pressure, gas volume factor) ([Pa], [m3/m3])
+		std::string B_gas;
 
-		// Data set (pressure, gas content in oil) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > Rs;
+		// Data set file (pressure, gas content in oil) ([Pa], [m3/m3])
+		std::string Rs;
 
 		// Heat of phase transition [J/kg]
 		double L;
@@ -362,6 +362,50 @@ namespace gasOil_3d_NIT
 			else
 				return 0.0;
 		};
+		// Fused value & derivative getters, one table search per call
+		inline void getKr_oil(double sat_oil, double& kr, double& kr_ds) const
+		{
+			if(sat_oil > 1.0)
+			{
+				kr = 1.0;
+				kr_ds = props_oil.kr->DSolve(1.0);
+			} else
+				props_oil.kr->Solve(sat_oil, kr, kr_ds);
+		};
+		inline void getKr_gas(double sat_oil, double& kr, double& kr_ds) const
+		{
+			if(sat_oil > 1.0)
+			{
+				kr = 0.0;
+				kr_ds = props_gas.kr->DSolve(1.0);
+			} else
+				props_gas.kr->Solve(sat_oil, kr, kr_ds);
+		};
+		inline void getB_oil(double p, double p_bub, bool SATUR, double& b, double& b_dp) const
+		{
+			if(SATUR)
+				props_oil.b->Solve(p, b, b_dp);
+			else
+			{
+				const double b_bub = props_oil.b->Solve(p_bub);
+				b = b_bub * (1.0 + props_oil.beta * (p_bub - p));
+				b_dp = -b_bub * props_oil.beta;
+			}
+		};
+		inline void getB_gas(double p, double& b, double& b_dp) const
+		{
+			props_gas.b->Solve(p, b, b_dp);
+		};
+		inline void getRs(double p, double p_bub, bool SATUR, double& rs, double& rs_dp) const
+		{
+			if(SATUR)
+				Rs->Solve(p, rs, rs_dp);
+			else
+			{
+				rs = Rs->Solve(p_bub);
+				rs_dp = 0.0;
+			}
+		};
 		inline double getPresFromRs(double rs) const
 		{
 			return Prs->Solve(rs);
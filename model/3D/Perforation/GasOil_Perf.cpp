@@ -4,114 +4,22 @@
 #include <cassert>
 
 using namespace std;
-using namespace std::placeholders;
 using namespace gasOil_perf;
 
 
 GasOil_Perf::GasOil_Perf()
 {
 	isWriteSnaps = false;
-
-	// Middle
-	middleFoo.mat.resize(2);
-
-	middleFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq1, this, _1));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1_ds_beta, this, _1, _2));
-
-	middleFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq2, this, _1));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_dp_beta, this, _1, _2));
-	middleFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2_ds_beta, this, _1, _2));
-
-	// Left
-	leftFoo.mat.resize(2);
-
-	leftFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq1Left, this, _1));
-	leftFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Left_dp, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Left_ds, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Left_dp_beta, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Left_ds_beta, this, _1, _2));
-
-	leftFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq2Left, this, _1));
-	leftFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Left_dp, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Left_ds, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Left_dp_beta, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Left_ds_beta, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Left_dp_beta, this, _1, _2));
-	leftFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Left_ds_beta, this, _1, _2));
-
-	// Right
-	rightFoo.mat.resize(2);
-
-	rightFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq1Right, this, _1));
-	rightFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Right_dp, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Right_ds, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Right_dp_beta, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Right_ds_beta, this, _1, _2));
-
-	rightFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq2Right, this, _1));
-	rightFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Right_dp, this, _1, _2));
-	rightFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Right_ds, this, _1, _2));
-	rightFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Right_dp_beta, this, _1, _2));
-	rightFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Right_ds_beta, this, _1, _2));
-
-	// Top
-	topFoo.mat.resize(2);
-
-	topFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq1Top, this, _1));
-	topFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Top_dp, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Top_ds, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Top_dp_beta, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Top_ds_beta, this, _1, _2));
-
-	topFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq2Top, this, _1));
-	topFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Top_dp, this, _1, _2));
-	topFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Top_ds, this, _1, _2));
-	topFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Top_dp_beta, this, _1, _2));
-	topFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Top_ds_beta, this, _1, _2));
-
-	// Bot
-	botFoo.mat.resize(2);
-
-	botFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq1Bot, this, _1));
-	botFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Bot_dp, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Bot_ds, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Bot_dp_beta, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&GasOil_Perf::solve_eq1Bot_ds_beta, this, _1, _2));
-
-	botFoo.rhs.push_back(bind(&GasOil_Perf::solve_eq2Bot, this, _1));
-	botFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Bot_dp, this, _1, _2));
-	botFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Bot_ds, this, _1, _2));
-	botFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Bot_dp_beta, this, _1, _2));
-	botFoo.mat[1].push_back(bind(&GasOil_Perf::solve_eq2Bot_ds_beta, this, _1, _2));
 }
 
 GasOil_Perf::~GasOil_Perf()
 {
+	releaseDataset(props_oil.kr);
+	releaseDataset(props_gas.kr);
+	releaseDataset(props_oil.b);
+	releaseDataset(props_gas.b);
+	releaseDataset(Rs);
+	releaseDataset(Prs);
 }
 
 void GasOil_Perf::setProps(Properties& props)
@@ -548,6 +456,36 @@ void GasOil_Perf::setPeriod(int period)
 		props_sk[i].perm_eff = props_sk[i].perms_eff[period];
 		props_sk[i].skin = props_sk[i].skins[period];
 	}
+
+	buildTrans();
+}
+
+void GasOil_Perf::buildTrans()
+{
+	const int layer = (cellsNum_r + 2) * (cellsNum_z + 2);
+	int neighbor[6];
+	int r_idx, z_idx;
+
+	trans.resize(6 * cellsNum);
+	for (int i = 0; i < cellsNum; i++)
+	{
+		r_idx = (i % layer) / (cellsNum_z + 2);
+		z_idx = i % (cellsNum_z + 2);
+		neighbor[0] = (r_idx > 0 ? i - cellsNum_z - 2 : -1);
+		neighbor[1] = (r_idx < cellsNum_r + 1 ? i + cellsNum_z + 2 : -1);
+		neighbor[2] = (z_idx > 0 ? i - 1 : -1);
+		neighbor[3] = (z_idx < cellsNum_z + 1 ? i + 1 : -1);
+		neighbor[4] = (i < layer ? i + layer * (cellsNum_phi - 1) : i - layer);
+		neighbor[5] = (i < layer * (cellsNum_phi - 1) ? i + layer : i - layer * (cellsNum_phi - 1));
+
+		for (int j = 0; j < 6; j++)
+		{
+			if (neighbor[j] < 0 || neighbor[j] == i)
+				trans[6 * i + j] = 0.0;
+			else
+				trans[6 * i + j] = calcTrans(cells[i], cells[neighbor[j]]);
+		}
+	}
 }
 
 void GasOil_Perf::setRateDeviation(int num, double ratio)
@@ -590,23 +528,24 @@ double GasOil_Perf::solve_eq1_dp(int cur, int beta)
 	getNeighborIdx(cell, neighbor);
 
 	Var2phase& next = cell.u_next;
-	double Boil_upwd;
-	double Boil = getB_oil(next.p, next.p_bub, next.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	double Boil, Boil_dp;
+	getB_oil(next.p, next.p_bub, next.SATUR, Boil, Boil_dp);
 	
 	double H = 0.0;
 	H = (next.s * getPoro_dp(cell) - 
-		getPoro(next.p, cell) * next.s * getB_oil_dp(next.p, next.p_bub, next.SATUR) / Boil ) / Boil;
+		getPoro(next.p, cell) * next.s * Boil_dp / Boil ) / Boil;
 
 	for(int i = 0; i < 6; i++)
 	{
 		upwind = upwindIsCur(&cell, neighbor[i]);
 		const Var2phase& upwd = getUpwindIdx(&cell, neighbor[i])->u_next;
-		Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
+		getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
 		Cell& beta = *neighbor[i];
 
 		H += ht / cell.V * getTrans(cell, beta) * 
 			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd - 
-			upwind * (next.p - beta.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) );
+			upwind * (next.p - beta.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * Boil_upwd_dp );
 	}
 	return H;
 }
@@ -643,11 +582,12 @@ double GasOil_Perf::solve_eq1_dp_beta(int cur, int beta)
 
 	double upwind = upwindIsCur(&cell, &nebr);
 	const Var2phase& upwd = getUpwindIdx(&cell, &nebr)->u_next;
-	double Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
 
 	return -ht / cell.V * getTrans(cell, nebr) * 
 			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd + 
-			(1.0 - upwind) * (cell.u_next.p - nebr.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) );
+			(1.0 - upwind) * (cell.u_next.p - nebr.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * Boil_upwd_dp );
 }
 
 double GasOil_Perf::solve_eq1_ds_beta(int cur, int beta)
@@ -696,31 +636,34 @@ double GasOil_Perf::solve_eq2_dp(int cur, int beta)
 	getNeighborIdx(cell, neighbor);
 
 	Var2phase& next = cell.u_next;
-	double Boil_upwd, Bgas_upwd, rs_upwd;
-	double Boil = getB_oil(next.p, next.p_bub, next.SATUR);
-	double Bgas = getB_gas(next.p);
-	double rs = getRs(next.p, next.p_bub, next.SATUR);
+	double Boil_upwd, Boil_upwd_dp, Bgas_upwd, Bgas_upwd_dp, rs_upwd, rs_upwd_dp;
+	double Boil, Boil_dp;
+	getB_oil(next.p, next.p_bub, next.SATUR, Boil, Boil_dp);
+	double Bgas, Bgas_dp;
+	getB_gas(next.p, Bgas, Bgas_dp);
+	double rs, rs_dp;
+	getRs(next.p, next.p_bub, next.SATUR, rs, rs_dp);
 	
 	double H = 0.0;
 	H = ( (next.s * rs / Boil + (1.0 - next.s) / Bgas) * getPoro_dp(cell) - 
-		getPoro(next.p, cell) * ( (1.0 - next.s) / Bgas / Bgas * getB_gas_dp(next.p) + 
-		next.s * rs / Boil / Boil * getB_oil_dp(next.p, next.p_bub, next.SATUR) - 
-		next.s / Boil * getRs_dp(next.p, next.p_bub, next.SATUR) ) );
+		getPoro(next.p, cell) * ( (1.0 - next.s) / Bgas / Bgas * Bgas_dp + 
+		next.s * rs / Boil / Boil * Boil_dp - 
+		next.s / Boil * rs_dp ) );
 
 	for(int i = 0; i < 6; i++)
 	{
 		upwind = upwindIsCur(&cell, neighbor[i]);
 		const Var2phase& upwd = getUpwindIdx(&cell, neighbor[i])->u_next;
-		Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
-		Bgas_upwd = getB_gas(upwd.p);
-		rs_upwd = getRs(upwd.p, upwd.p_bub, upwd.SATUR);
+		getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
+		getB_gas(upwd.p, Bgas_upwd, Bgas_upwd_dp);
+		getRs(upwd.p, upwd.p_bub, upwd.SATUR, rs_upwd, rs_upwd_dp);
 		Cell& beta = *neighbor[i];
 
 		H += ht / cell.V * getTrans(cell, beta) * 
 			( getKr_oil(upwd.s) * rs_upwd / props_oil.visc / Boil_upwd + getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd + 
 			upwind * (next.p - beta.u_next.p) * 
-			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (getRs_dp(upwd.p, upwd.p_bub, upwd.SATUR) - rs_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) / Boil_upwd) - 
-			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * getB_gas_dp(upwd.p) ));
+			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp ));
 	}
 
 	return H;
@@ -759,15 +702,18 @@ double GasOil_Perf::solve_eq2_dp_beta(int cur, int beta)
 
 	double upwind = upwindIsCur(&cell, &nebr);
 	const Var2phase& upwd = getUpwindIdx(&cell, &nebr)->u_next;
-	double Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
-	double Bgas_upwd = getB_gas(upwd.p);
-	double rs_upwd = getRs(upwd.p, upwd.p_bub, upwd.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
+	double Bgas_upwd, Bgas_upwd_dp;
+	getB_gas(upwd.p, Bgas_upwd, Bgas_upwd_dp);
+	double rs_upwd, rs_upwd_dp;
+	getRs(upwd.p, upwd.p_bub, upwd.SATUR, rs_upwd, rs_upwd_dp);
 
 	return -ht / cell.V * getTrans(cell, nebr) * 
 			( getKr_oil(upwd.s) * rs_upwd / props_oil.visc / Boil_upwd + getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd - 
 			(1.0 - upwind) * (cell.u_next.p - nebr.u_next.p) * 
-			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (getRs_dp(upwd.p, upwd.p_bub, upwd.SATUR) - rs_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) / Boil_upwd) - 
-			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * getB_gas_dp(upwd.p) ));
+			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp ));
 }
 
 double GasOil_Perf::solve_eq2_ds_beta(int cur, int beta)
@@ -6,7 +6,7 @@
 using namespace std;
 using namespace oil_perf_nit;
 
-OilPerfNITSolver::OilPerfNITSolver(Oil_Perf_NIT* _model) : AbstractSolver<Oil_Perf_NIT>(_model)
+OilPerfNITSolver::OilPerfNITSolver(Oil_Perf_NIT* _model, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig) : AbstractSolver<Oil_Perf_NIT>(_model)
 {
 	// Output streams
 	plot_Tdyn.open("snaps/T_dyn.dat", ofstream::out);
@@ -29,19 +29,33 @@ OilPerfNITSolver::OilPerfNITSolver(Oil_Perf_NIT* _model) : AbstractSolver<Oil_Pe
 	// Memory allocating
 	ind_i = new int[7 * model->cellsNum];
 	ind_j = new int[7 * model->cellsNum];
-	a = new double[7 * model->cellsNum];
-	ind_rhs = new int[model->cellsNum + model->tunnelCells.size()];
 	rhs = new double[model->cellsNum + model->tunnelCells.size()];
 
 	tind_i = new int[7 * (model->cellsNum + model->tunnelCells.size())];
 	tind_j = new int[7 * (model->cellsNum + model->tunnelCells.size())];
-	ta = new double[7 * (model->cellsNum + model->tunnelCells.size())];
-	tind_rhs = new int[model->cellsNum + model->tunnelCells.size()];
 	trhs = new double[model->cellsNum + model->tunnelCells.size()];
 
 	// Stencils allocating
 	stencils = new UsedStencils<Oil_Perf_NIT>(model);
-	stencils->setStorages(a, ind_i, ind_j, rhs);
+	stencils->setIndexStorages(ind_i, ind_j);
+
+	// Rejected configs fall back to the defaults
+	if (presConfig == NULL || !pres_solver.setConfig(*presConfig))
+		pres_solver.setConfig(getPresDefaultConfig());
+	if (tempConfig == NULL || !temp_solver.setConfig(*tempConfig))
+		temp_solver.setConfig(getTempDefaultConfig());
+}
+
+ParSolverConfig OilPerfNITSolver::getPresDefaultConfig()
+{
+	// Scalar elliptic pressure system
+	ParSolverConfig config(PRECOND_AMG);
+	return config;
+}
+
+ParSolverConfig OilPerfNITSolver::getTempDefaultConfig()
+{
+	return ParSolverConfig();
 }
 
 OilPerfNITSolver::~OilPerfNITSolver()
@@ -50,6 +64,15 @@ OilPerfNITSolver::~OilPerfNITSolver()
 	plot_Tdyn.close();
 	plot_Pdyn.close();
 	plot_qcells.close();
+
+	// Releasing buffers
+	delete stencils;
+	delete[] ind_i;
+	delete[] ind_j;
+	delete[] rhs;
+	delete[] tind_i;
+	delete[] tind_j;
+	delete[] trhs;
 }
 
 void OilPerfNITSolver::writeData()
@@ -114,6 +137,7 @@ void OilPerfNITSolver::writeData()
 
 void OilPerfNITSolver::control()
 {
+	const double ht_prev = model->ht;
 	writeData();
 
 	if (cur_t >= model->period[curTimePeriod])
@@ -121,6 +145,8 @@ void OilPerfNITSolver::control()
 		curTimePeriod++;
 		model->ht = model->ht_min;
 		model->setPeriod(curTimePeriod);
+		pres_solver.setNewPeriod();
+		temp_solver.setNewPeriod();
 	}
 
 	if (model->ht <= model->ht_max && iterations < 6)
@@ -132,6 +158,8 @@ void OilPerfNITSolver::control()
 		model->ht = model->period[curTimePeriod] - cur_t;
 
 	cur_t += model->ht;
+	pres_solver.setNewTimeStep(model->ht / ht_prev);
+	temp_solver.setNewTimeStep();
 }
 
 void OilPerfNITSolver::start()
@@ -139,10 +167,18 @@ void OilPerfNITSolver::start()
 	int counter = 0;
 	iterations = 8;
 
-	fillIndices(PRES);
-	fillIndices(TEMP);
 	pres_solver.Init( model->cellsNum + model->tunnelCells.size() );
 	temp_solver.Init( model->cellsNum + model->tunnelCells.size() );
+	fillIndices(PRES);
+	fillIndices(TEMP);
+	pres_solver.setPattern(ind_i, ind_j, presElemNum);
+	temp_solver.setPattern(tind_i, tind_j, tempElemNum);
+	delete[] ind_i;
+	delete[] ind_j;
+	delete[] tind_i;
+	delete[] tind_j;
+	ind_i = ind_j = tind_i = tind_j = NULL;
+	stencils->setIndexStorages(NULL, NULL);
 
 	model->setPeriod(curTimePeriod);
 	while (cur_t < Tt)
@@ -157,6 +193,8 @@ void OilPerfNITSolver::start()
 	if (model->isWriteSnaps)
 		model->snapshot_all(counter++);
 	writeData();
+	pres_solver.getRunStats().print("Pressure solver run");
+	temp_solver.getRunStats().print("Temperature solver run");
 }
 
 void OilPerfNITSolver::doNextStep()
@@ -225,13 +263,15 @@ void OilPerfNITSolver::solveStep()
 	double averPres;
 	double dAverPres = 1.0;
 
+	pres_solver.setNewNewtonLoop();
 	iterations = 0;
 	while (err_newton > 1.e-4 && iterations < 10)
 	{
 		copyIterLayer();
 
+		a = pres_solver.beginAssemble();
 		fill(PRES);
-		pres_solver.Assemble(ind_i, ind_j, a, presElemNum, ind_rhs, rhs);
+		pres_solver.Assemble(rhs);
 		pres_solver.Solve();
 		copySolution( pres_solver.getSolution(), PRES );
 
@@ -249,8 +289,9 @@ void OilPerfNITSolver::solveStep()
 		iterations++;
 	}
 
+	ta = temp_solver.beginAssemble();
 	fill(TEMP);
-	temp_solver.Assemble(tind_i, tind_j, ta, tempElemNum, tind_rhs, trhs);
+	temp_solver.Assemble(trhs);
 	temp_solver.Solve();
 	copySolution(temp_solver.getSolution(), TEMP);
 
@@ -266,10 +307,13 @@ void OilPerfNITSolver::fillIndices(int key)
 
 	if (key == PRES)
 	{
+		presPlan.clear();
+
 		// Left
 		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
 		{
 			idx = it.getIdx();
+			presPlan.push_back({ idx, FILL_BOUND, counter });
 
 			if (it->isUsed)
 			{
@@ -293,17 +337,27 @@ void OilPerfNITSolver::fillIndices(int key)
 			idx = it.getIdx();
 			res = idx % (model->cellsNum_z + 2);
 			if (res == 0)
+			{
+				presPlan.push_back({ idx, FILL_TOP, counter });
 				stencils->top->fillIndex(idx, &counter);
+			}
 			else if (res == model->cellsNum_z + 1)
+			{
+				presPlan.push_back({ idx, FILL_BOT, counter });
 				stencils->bot->fillIndex(idx, &counter);
+			}
 			else
+			{
+				presPlan.push_back({ idx, FILL_MIDDLE, counter });
 				stencils->middle->fillIndex(idx, &counter);
+			}
 		}
 
 		// Right
 		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
 		{
 			idx = it.getIdx();
+			presPlan.push_back({ idx, FILL_RIGHT, counter });
 			stencils->right->fillIndex(idx, &counter);
 		}
 
@@ -311,20 +365,21 @@ void OilPerfNITSolver::fillIndices(int key)
 		vector<Cell>::iterator itr;
 		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
 		{
+			presPlan.push_back({ itr->num, FILL_TUNNEL, counter });
 			stencils->left->fillIndex(itr->num, &counter);
 		}
 
 		presElemNum = counter;
-
-		for (int i = 0; i < model->cellsNum + model->tunnelCells.size(); i++)
-			ind_rhs[i] = i;
 	}
 	else if (key == TEMP)
 	{
+		tempPlan.clear();
+
 		// Left
 		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
 		{
 			idx = it.getIdx();
+			tempPlan.push_back({ idx, FILL_BOUND, counter });
 
 			if (it->isUsed)
 			{
@@ -349,6 +404,7 @@ void OilPerfNITSolver::fillIndices(int key)
 			res = idx % (model->cellsNum_z + 2);
 			if (res == 0)
 			{
+				tempPlan.push_back({ idx, FILL_TOP, counter });
 				tind_i[counter] = idx;
 				tind_j[counter++] = idx;
 
@@ -357,14 +413,16 @@ void OilPerfNITSolver::fillIndices(int key)
 			}
 			else if (res == model->cellsNum_z + 1)
 			{
+				tempPlan.push_back({ idx, FILL_BOT, counter });
 				tind_i[counter] = idx;
 				tind_j[counter++] = idx;
 
 				tind_i[counter] = idx;
 				tind_j[counter++] = idx - 1;
-			} 
+			}
 			else
 			{
+				tempPlan.push_back({ idx, FILL_MIDDLE, counter });
 				Cell* nebr[7];
 				model->getStencilIdx(idx, nebr);
 
@@ -391,6 +449,7 @@ void OilPerfNITSolver::fillIndices(int key)
 		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
 		{
 			idx = it.getIdx();
+			tempPlan.push_back({ idx, FILL_RIGHT, counter });
 
 			tind_i[counter] = idx;
 			tind_j[counter++] = idx;
@@ -400,6 +459,7 @@ void OilPerfNITSolver::fillIndices(int key)
 		vector<Cell>::iterator itr;
 		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
 		{
+			tempPlan.push_back({ itr->num, FILL_TUNNEL, counter });
 			tind_i[counter] = itr->num + model->cellsNum;
 			tind_j[counter++] = itr->num + model->cellsNum;
 
@@ -411,187 +471,164 @@ void OilPerfNITSolver::fillIndices(int key)
 		}
 
 		tempElemNum = counter;
-
-		for (int i = 0; i < model->cellsNum + model->tunnelCells.size(); i++)
-			tind_rhs[i] = i;
 	}
 }
 
 void OilPerfNITSolver::fill(int key)
 {
-	int idx;
-	int counter = 0;
-	Iterator it;
-	map<int, double>::iterator itPerf;
+	if (key == PRES)
+		stencils->setValueStorages(a, pres_solver.getSlots(), rhs);
+
+	const std::vector<FillCell>& plan = (key == PRES ? presPlan : tempPlan);
+	const int cellsNum = (int)plan.size();
+	#pragma omp parallel for num_threads(fillThreads) schedule(static)
+	for (int k = 0; k < cellsNum; k++)
+	{
+		int counter = plan[k].offset;
+		fillCell(plan[k], &counter, key);
+	}
+}
+
+void OilPerfNITSolver::fillCell(const FillCell& cell, int* counter, int key)
+{
+	const int idx = cell.idx;
 
 	if (key == PRES)
 	{
-		// Left
-		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
-		{
-			idx = it.getIdx();
+		const int* slots = pres_solver.getSlots();
 
-			if (it->isUsed)
+		switch (cell.type)
+		{
+		case FILL_BOUND:
+			if (model->cells[idx].isUsed)
 			{
-				a[counter++] = 1.0;
-				a[counter++] = -1.0;
-
-				rhs[idx] = 0.0;
+				a[slots[(*counter)++]] += 1.0;
+				a[slots[(*counter)++]] += -1.0;
 			}
 			else {
-				a[counter++] = 1.0;
-
-				rhs[idx] = 0.0;
+				a[slots[(*counter)++]] += 1.0;
 			}
-		}
 
-		// Middle
-		int res;
-		for (it = model->getMidBegin(); it != model->getMidEnd(); ++it)
-		{
-			idx = it.getIdx();
-			res = idx % (model->cellsNum_z + 2);
-			if (res == 0)
-				stencils->top->fill(idx, &counter);
-			else if (res == model->cellsNum_z + 1)
-				stencils->bot->fill(idx, &counter);
-			else
-				stencils->middle->fill(idx, &counter);
-		}
-
-		// Right
-		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
-		{
-			idx = it.getIdx();
-			stencils->right->fill(idx, &counter);
-		}
-
-		// Tunnel cells
-		vector<Cell>::iterator itr;
-		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
-		{
-			stencils->left->fill(itr->num, &counter);
+			rhs[idx] = 0.0;
+			break;
+		case FILL_TOP:
+			stencils->top->fill(idx, counter);
+			break;
+		case FILL_BOT:
+			stencils->bot->fill(idx, counter);
+			break;
+		case FILL_MIDDLE:
+			stencils->middle->fill(idx, counter);
+			break;
+		case FILL_RIGHT:
+			stencils->right->fill(idx, counter);
+			break;
+		case FILL_TUNNEL:
+			stencils->left->fill(idx, counter);
+			break;
 		}
 	}
 	else if (key == TEMP)
 	{
-		// Left
-		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
-		{
-			idx = it.getIdx();
+		const int* tslots = temp_solver.getSlots();
 
-			if (it->isUsed)
+		switch (cell.type)
+		{
+		case FILL_BOUND:
+			if (model->cells[idx].isUsed)
 			{
-				ta[counter++] = 1.0;
-				ta[counter++] = -1.0;
-
-				trhs[idx] = 0.0;
+				ta[tslots[(*counter)++]] += 1.0;
+				ta[tslots[(*counter)++]] += -1.0;
 			}
 			else {
-				ta[counter++] = 1.0;
-				trhs[idx] = 0.0;
+				ta[tslots[(*counter)++]] += 1.0;
 			}
-		}
 
-		// Middle
-		int res;
-		for (it = model->getMidBegin(); it != model->getMidEnd(); ++it)
+			trhs[idx] = 0.0;
+			break;
+		case FILL_TOP:
+		case FILL_BOT:
+			ta[tslots[(*counter)++]] += 1.0;
+			ta[tslots[(*counter)++]] += -1.0;
+			trhs[idx] = 0.0;
+			break;
+		case FILL_MIDDLE:
 		{
-			idx = it.getIdx();
-			res = idx % (model->cellsNum_z + 2);
-			if (res == 0)
-			{
-				ta[counter++] = 1.0;
-				ta[counter++] = -1.0;
-				trhs[idx] = 0.0;
-			}
-			else if (res == model->cellsNum_z + 1)
+			Cell* nebr[7];
+			model->getStencilIdx(idx, nebr);
+
+			if (nebr[0]->isUsed)
 			{
-				ta[counter++] = 1.0;
-				ta[counter++] = -1.0;
-				trhs[idx] = 0.0;
+				double tcoef[7];
+				tcoef[1] = -2.0 * (max(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) +
+					model->getLambda(*nebr[0], *nebr[1]) * (nebr[0]->r - nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[1]->hr);
+				tcoef[2] = 2.0 * (min(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) -
+					model->getLambda(*nebr[0], *nebr[2]) * (nebr[0]->r + nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[2]->hr);
+				tcoef[3] = -2.0 * (max(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) +
+					model->getLambda(*nebr[0], *nebr[3]) / nebr[0]->hz) / (nebr[0]->hz + nebr[3]->hz);
+				tcoef[4] = 2.0 * (min(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) -
+					model->getLambda(*nebr[0], *nebr[4]) / nebr[0]->hz) / (nebr[0]->hz + nebr[4]->hz);
+				tcoef[5] = -2.0 * (max(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) +
+					model->getLambda(*nebr[0], *nebr[5]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[5]->hphi);
+				tcoef[6] = 2.0 * (min(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) -
+					model->getLambda(*nebr[0], *nebr[6]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[6]->hphi);
+				tcoef[0] = model->getCn(*nebr[0]) / model->ht 
+					- tcoef[1]
+					- tcoef[2]
+					- tcoef[3]
+					- tcoef[4]
+					- tcoef[5]
+					- tcoef[6];
+
+				trhs[idx] = model->getCn(*nebr[0]) * nebr[0]->u_prev.t / model->ht +
+					model->getAd(*nebr[0]) * (nebr[0]->u_next.p - nebr[0]->u_prev.p) / model->ht -
+					model->getJT(*nebr[0], NEXT, R_AXIS) * model->getNablaP(*nebr[0], NEXT, R_AXIS) -
+					model->getJT(*nebr[0], NEXT, PHI_AXIS) * model->getNablaP(*nebr[0], NEXT, PHI_AXIS) -
+					model->getJT(*nebr[0], NEXT, Z_AXIS) * model->getNablaP(*nebr[0], NEXT, Z_AXIS);
+
+				for (int j = 0; j < 7; j++)
+					ta[tslots[(*counter)++]] += tcoef[j];
 			}
 			else
 			{
-				Cell* nebr[7];
-				model->getStencilIdx(idx, nebr);
-
-				if (nebr[0]->isUsed)
-				{
-					ta[counter+1] = -2.0 * (max(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) +
-						model->getLambda(*nebr[0], *nebr[1]) * (nebr[0]->r - nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[1]->hr);
-					ta[counter+2] = 2.0 * (min(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) -
-						model->getLambda(*nebr[0], *nebr[2]) * (nebr[0]->r + nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[2]->hr);
-					ta[counter+3] = -2.0 * (max(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) +
-						model->getLambda(*nebr[0], *nebr[3]) / nebr[0]->hz) / (nebr[0]->hz + nebr[3]->hz);
-					ta[counter+4] = 2.0 * (min(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) -
-						model->getLambda(*nebr[0], *nebr[4]) / nebr[0]->hz) / (nebr[0]->hz + nebr[4]->hz);
-					ta[counter+5] = -2.0 * (max(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) +
-						model->getLambda(*nebr[0], *nebr[5]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[5]->hphi);
-					ta[counter+6] = 2.0 * (min(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) -
-						model->getLambda(*nebr[0], *nebr[6]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[6]->hphi);
-					ta[counter] = model->getCn(*nebr[0]) / model->ht 
-						- ta[counter + 1]
-						- ta[counter + 2]
-						- ta[counter + 3]
-						- ta[counter + 4]
-						- ta[counter + 5]
-						- ta[counter + 6];
-
-					trhs[idx] = model->getCn(*nebr[0]) * nebr[0]->u_prev.t / model->ht +
-						model->getAd(*nebr[0]) * (nebr[0]->u_next.p - nebr[0]->u_prev.p) / model->ht -
-						model->getJT(*nebr[0], NEXT, R_AXIS) * model->getNablaP(*nebr[0], NEXT, R_AXIS) -
-						model->getJT(*nebr[0], NEXT, PHI_AXIS) * model->getNablaP(*nebr[0], NEXT, PHI_AXIS) -
-						model->getJT(*nebr[0], NEXT, Z_AXIS) * model->getNablaP(*nebr[0], NEXT, Z_AXIS);
-
-					counter += 7;
-				}
-				else
-				{
-					ta[counter++] = 1.0;
-					trhs[idx] = 0.0;
-				}
+				ta[tslots[(*counter)++]] += 1.0;
+				trhs[idx] = 0.0;
 			}
+			break;
 		}
-
-		// Right
-		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
-		{
-			idx = it.getIdx();
-
-			ta[counter++] = 1.0;
+		case FILL_RIGHT:
+			ta[tslots[(*counter)++]] += 1.0;
 
 			trhs[idx] = model->props_sk[model->getSkeletonIdx(model->cells[idx])].t_init;
-		}
-
-		// Tunnel cells
-		vector<Cell>::iterator itr;
-		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
+			break;
+		case FILL_TUNNEL:
 		{
-			Cell& cell = *itr;
-			Cell& nebr1 = model->getCell(model->nebrMap[itr->num].first);
-			Cell& nebr2 = model->getCell(model->nebrMap[itr->num].second);
+			Cell& tunnel = model->tunnelCells[idx];
+			Cell& nebr1 = model->getCell(model->nebrMap[idx].first);
+			Cell& nebr2 = model->getCell(model->nebrMap[idx].second);
 
 			if (fabs(nebr2.r - nebr1.r) > EQUALITY_TOLERANCE)
 			{
-				ta[counter++] = 1.0 / (nebr1.r - cell.r);
-				ta[counter++] = -1.0 / (nebr2.r - nebr1.r) - 1.0 / (nebr1.r - cell.r);
-				ta[counter++] = 1.0 / (nebr2.r - nebr1.r);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr1.r - tunnel.r);
+				ta[tslots[(*counter)++]] += -1.0 / (nebr2.r - nebr1.r) - 1.0 / (nebr1.r - tunnel.r);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr2.r - nebr1.r);
 			}
 			else if (fabs(nebr2.z - nebr1.z) > EQUALITY_TOLERANCE)
 			{
-				ta[counter++] = 1.0 / (nebr1.z - cell.z);
-				ta[counter++] = -1.0 / (nebr2.z - nebr1.z) - 1.0 / (nebr1.z - cell.z);
-				ta[counter++] = 1.0 / (nebr2.z - nebr1.z);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr1.z - tunnel.z);
+				ta[tslots[(*counter)++]] += -1.0 / (nebr2.z - nebr1.z) - 1.0 / (nebr1.z - tunnel.z);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr2.z - nebr1.z);
 			}
 			else if (fabs(nebr2.phi - nebr1.phi) > EQUALITY_TOLERANCE)
 			{
-				ta[counter++] = 1.0 / (nebr1.phi - cell.phi) / nebr1.r;
-				ta[counter++] = -1.0 / (nebr2.phi - nebr1.phi) / nebr1.r - 1.0 / (nebr1.phi - cell.phi) / nebr1.r;
-				ta[counter++] = 1.0 / (nebr2.phi - nebr1.phi) / nebr1.r;
+				ta[tslots[(*counter)++]] += 1.0 / (nebr1.phi - tunnel.phi) / nebr1.r;
+				ta[tslots[(*counter)++]] += -1.0 / (nebr2.phi - nebr1.phi) / nebr1.r - 1.0 / (nebr1.phi - tunnel.phi) / nebr1.r;
+				ta[tslots[(*counter)++]] += 1.0 / (nebr2.phi - nebr1.phi) / nebr1.r;
 			}
 
-			trhs[itr->num + model->cellsNum] = 0.0;
+			trhs[idx + model->cellsNum] = 0.0;
+			break;
+		}
 		}
 	}
 }
@@ -59,6 +59,7 @@ namespace oil_perf_nit
 		};
 
 		void fill(int key);
+		void fillCell(const FillCell& cell, int* counter, int key);
 		void fillIndices(int key);
 		void copySolution(const paralution::LocalVector<double>& sol, int key);
 
@@ -69,25 +70,29 @@ namespace oil_perf_nit
 		ParSolver pres_solver;
 		ParSolver temp_solver;
 
-		// Coordinate form of sparse matrix & dense vector
+		// Coordinate form of sparse matrix pattern, CSR values & dense vector
 		int* ind_i;
 		int* ind_j;
 		double* a;
-		int* ind_rhs;
 		double* rhs;
 		//
 		int* tind_i;
 		int* tind_j;
 		double* ta;
-		int* tind_rhs;
 		double* trhs;
 
 		// Number of non-zero elements in sparse matrix
 		int presElemNum;
 		int tempElemNum;
+		// Cells in filling order
+		std::vector<FillCell> presPlan;
+		std::vector<FillCell> tempPlan;
 
 	public:
-		OilPerfNITSolver(Oil_Perf_NIT* _model);
+		OilPerfNITSolver(Oil_Perf_NIT* _model, const ParSolverConfig* presConfig = NULL, const ParSolverConfig* tempConfig = NULL);
+		// Settings used without configs, config files are loaded over them
+		static ParSolverConfig getPresDefaultConfig();
+		static ParSolverConfig getTempDefaultConfig();
 		~OilPerfNITSolver();
 
 		void start();
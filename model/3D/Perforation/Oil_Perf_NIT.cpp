@@ -4,53 +4,12 @@
 #include <cassert>
 
 using namespace std;
-using namespace std::placeholders;
 using namespace oil_perf_nit;
 
 
 Oil_Perf_NIT::Oil_Perf_NIT()
 {
 	isWriteSnaps = false;
-
-	// Middle
-	middleFoo.mat.resize(1);
-
-	middleFoo.rhs.push_back(bind(&Oil_Perf_NIT::solve_eq, this, _1));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp_beta, this, _1, _2));
-	middleFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eq_dp_beta, this, _1, _2));
-
-	// Left
-	leftFoo.mat.resize(1);
-
-	leftFoo.rhs.push_back(bind(&Oil_Perf_NIT::solve_eqLeft, this, _1));
-	leftFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqLeft_dp, this, _1, _2));
-	leftFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqLeft_dp_beta, this, _1, _2));
-
-	// Right
-	rightFoo.mat.resize(1);
-
-	rightFoo.rhs.push_back(bind(&Oil_Perf_NIT::solve_eqRight, this, _1));
-	rightFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqRight_dp, this, _1, _2));
-	rightFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqRight_dp_beta, this, _1, _2));
-
-	// Top
-	topFoo.mat.resize(1);
-
-	topFoo.rhs.push_back(bind(&Oil_Perf_NIT::solve_eqTop, this, _1));
-	topFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqTop_dp, this, _1, _2));
-	topFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqTop_dp_beta, this, _1, _2));
-
-	// Bot
-	botFoo.mat.resize(1);
-
-	botFoo.rhs.push_back(bind(&Oil_Perf_NIT::solve_eqBot, this, _1));
-	botFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqBot_dp, this, _1, _2));
-	botFoo.mat[0].push_back(bind(&Oil_Perf_NIT::solve_eqBot_dp_beta, this, _1, _2));
 }
 
 Oil_Perf_NIT::~Oil_Perf_NIT()
@@ -476,6 +435,36 @@ void Oil_Perf_NIT::setPeriod(int period)
 		props_sk[i].perm_eff = props_sk[i].perms_eff[period];
 		props_sk[i].skin = props_sk[i].skins[period];
 	}
+
+	buildTrans();
+}
+
+void Oil_Perf_NIT::buildTrans()
+{
+	const int layer = (cellsNum_r + 2) * (cellsNum_z + 2);
+	int neighbor[6];
+	int r_idx, z_idx;
+
+	trans.resize(6 * cellsNum);
+	for (int i = 0; i < cellsNum; i++)
+	{
+		r_idx = (i % layer) / (cellsNum_z + 2);
+		z_idx = i % (cellsNum_z + 2);
+		neighbor[0] = (r_idx > 0 ? i - cellsNum_z - 2 : -1);
+		neighbor[1] = (r_idx < cellsNum_r + 1 ? i + cellsNum_z + 2 : -1);
+		neighbor[2] = (z_idx > 0 ? i - 1 : -1);
+		neighbor[3] = (z_idx < cellsNum_z + 1 ? i + 1 : -1);
+		neighbor[4] = (i < layer ? i + layer * (cellsNum_phi - 1) : i - layer);
+		neighbor[5] = (i < layer * (cellsNum_phi - 1) ? i + layer : i - layer * (cellsNum_phi - 1));
+
+		for (int j = 0; j < 6; j++)
+		{
+			if (neighbor[j] < 0 || neighbor[j] == i)
+				trans[6 * i + j] = 0.0;
+			else
+				trans[6 * i + j] = calcTrans(cells[i], cells[neighbor[j]]);
+		}
+	}
 }
 
 void Oil_Perf_NIT::setRateDeviation(int num, double ratio)
@@ -332,7 +332,29 @@ namespace oil_perf_nit
 			const int idx = getSkeletonIdx(cell);
 			return props_sk[idx].m * props_sk[idx].beta;
 		};
-		inline double getTrans(Cell& cell, Cell& beta)
+		// trans[6 * i + j] - transmissibility of i-th cell face towards its j-th neighbour, tunnel faces left out.
+		// Filled by setPeriod() once perm_eff of the period is known
+		std::vector<double> trans;
+		void buildTrans();
+		inline int getFaceIdx(const int cur, const int beta) const
+		{
+			const int layer = (cellsNum_r + 2) * (cellsNum_z + 2);
+			const int diff = beta - cur;
+
+			if (diff == -cellsNum_z - 2)
+				return 0;
+			else if (diff == cellsNum_z + 2)
+				return 1;
+			else if (diff == -1)
+				return 2;
+			else if (diff == 1)
+				return 3;
+			else if (diff == -layer || diff == layer * (cellsNum_phi - 1))
+				return 4;
+			else
+				return 5;
+		};
+		inline double calcTrans(Cell& cell, Cell& beta)
 		{
 			double k1, k2, S;
 			const int idx1 = getSkeletonIdx(cell);
@@ -360,6 +382,14 @@ namespace oil_perf_nit
 				return 2.0 * k1 * S / (beta.hr + cell.hr);
 			}
 		};
+		inline double getTrans(Cell& cell, Cell& beta)
+		{
+			// Faces of tunnel cells are not cached
+			if (cell.isTunnel || beta.isTunnel)
+				return calcTrans(cell, beta);
+
+			return trans[6 * cell.num + getFaceIdx(cell.num, beta.num)];
+		};
 		inline double getPerm_r(const Cell& cell) const
 		{
 			const int idx = getSkeletonIdx(cell);
@@ -670,12 +700,6 @@ namespace oil_perf_nit
 		// Finds functional
 		double solveH();
 
-		FillFoo middleFoo;
-		FillFoo rightFoo;
-		FillFoo leftFoo;
-		FillFoo topFoo;
-		FillFoo botFoo;
-
 	public:
 		Oil_Perf_NIT();
 		~Oil_Perf_NIT();
@@ -1,12 +1,14 @@
 #include "model/3D/Perforation/ParPerfNITSolver.h"
 
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <map>
 
 using namespace std;
 using namespace gasOil_perf_nit;
 
-ParPerfNITSolver::ParPerfNITSolver(GasOil_Perf_NIT* _model) : AbstractSolver<GasOil_Perf_NIT>(_model)
+ParPerfNITSolver::ParPerfNITSolver(GasOil_Perf_NIT* _model, const ParSolverConfig* presConfig, const ParSolverConfig* tempConfig) : AbstractSolver<GasOil_Perf_NIT>(_model)
 {
 	// Output streams
 	plot_Tdyn.open("snaps/T_dyn.dat", ofstream::out);
@@ -30,19 +32,34 @@ ParPerfNITSolver::ParPerfNITSolver(GasOil_Perf_NIT* _model) : AbstractSolver<Gas
 	// Memory allocating
 	ind_i = new int[7 * 4 * model->cellsNum];
 	ind_j = new int[7 * 4 * model->cellsNum];
-	a = new double[7 * 4 * model->cellsNum];
-	ind_rhs = new int[2 * (model->cellsNum + model->tunnelCells.size())];
 	rhs = new double[2 * (model->cellsNum + model->tunnelCells.size())];
 
 	tind_i = new int[7 * (model->cellsNum + model->tunnelCells.size())];
 	tind_j = new int[7 * (model->cellsNum + model->tunnelCells.size())];
-	ta = new double[7 * (model->cellsNum + model->tunnelCells.size())];
-	tind_rhs = new int[model->cellsNum + model->tunnelCells.size()];
 	trhs = new double[model->cellsNum + model->tunnelCells.size()];
+	pertRhs.resize(2 * (model->cellsNum + model->tunnelCells.size()));
 
 	// Stencils allocating
 	stencils = new UsedStencils<GasOil_Perf_NIT>(model);
-	stencils->setStorages(a, ind_i, ind_j, rhs);
+	stencils->setIndexStorages(ind_i, ind_j);
+
+	// Rejected configs fall back to the defaults
+	if (presConfig == NULL || !pres_solver.setConfig(*presConfig))
+		pres_solver.setConfig(getPresDefaultConfig());
+	if (tempConfig == NULL || !temp_solver.setConfig(*tempConfig))
+		temp_solver.setConfig(getTempDefaultConfig());
+}
+
+ParSolverConfig ParPerfNITSolver::getPresDefaultConfig()
+{
+	// Pressure-saturation point blocks, AMG at the pressure stage
+	ParSolverConfig config(PRECOND_CPR, 2);
+	return config;
+}
+
+ParSolverConfig ParPerfNITSolver::getTempDefaultConfig()
+{
+	return ParSolverConfig();
 }
 
 ParPerfNITSolver::~ParPerfNITSolver()
@@ -52,6 +69,15 @@ ParPerfNITSolver::~ParPerfNITSolver()
 	plot_Pdyn.close();
 	plot_Sdyn.close();
 	plot_qcells.close();
+
+	// Releasing buffers
+	delete stencils;
+	delete[] ind_i;
+	delete[] ind_j;
+	delete[] rhs;
+	delete[] tind_i;
+	delete[] tind_j;
+	delete[] trhs;
 }
 
 void ParPerfNITSolver::writeData()
@@ -126,6 +152,7 @@ void ParPerfNITSolver::writeData()
 
 void ParPerfNITSolver::control()
 {
+	const double ht_prev = model->ht;
 	writeData();
 
 	if (cur_t >= model->period[curTimePeriod])
@@ -133,6 +160,8 @@ void ParPerfNITSolver::control()
 		curTimePeriod++;
 		model->ht = model->ht_min;
 		model->setPeriod(curTimePeriod);
+		pres_solver.setNewPeriod();
+		temp_solver.setNewPeriod();
 	}
 
 	if (model->ht <= model->ht_max && iterations < 6)
@@ -144,6 +173,8 @@ void ParPerfNITSolver::control()
 		model->ht = model->period[curTimePeriod] - cur_t;
 
 	cur_t += model->ht;
+	pres_solver.setNewTimeStep(model->ht / ht_prev);
+	temp_solver.setNewTimeStep();
 }
 
 void ParPerfNITSolver::start()
@@ -151,10 +182,18 @@ void ParPerfNITSolver::start()
 	int counter = 0;
 	iterations = 8;
 
-	fillIndices(PRES);
-	fillIndices(TEMP);
 	pres_solver.Init( 2 * (model->cellsNum + model->tunnelCells.size()) );
 	temp_solver.Init( model->cellsNum + model->tunnelCells.size() );
+	fillIndices(PRES);
+	fillIndices(TEMP);
+	pres_solver.setPattern(ind_i, ind_j, presElemNum);
+	temp_solver.setPattern(tind_i, tind_j, tempElemNum);
+	delete[] ind_i;
+	delete[] ind_j;
+	delete[] tind_i;
+	delete[] tind_j;
+	ind_i = ind_j = tind_i = tind_j = NULL;
+	stencils->setIndexStorages(NULL, NULL);
 
 	model->setPeriod(curTimePeriod);
 	while (cur_t < Tt)
@@ -169,6 +208,8 @@ void ParPerfNITSolver::start()
 	if (model->isWriteSnaps)
 		model->snapshot_all(counter++);
 	writeData();
+	pres_solver.getRunStats().print("Pressure solver run");
+	temp_solver.getRunStats().print("Temperature solver run");
 }
 
 void ParPerfNITSolver::doNextStep()
@@ -244,14 +285,24 @@ void ParPerfNITSolver::solveStep()
 	double averPres, averSat;
 	double dAverPres = 1.0, dAverSat = 1.0;
 
+	pres_solver.setNewNewtonLoop();
 	iterations = 0;
 	while (err_newton > 1.e-4 && /*(dAverSat > 1.e-8 || dAverPres > 1.e-4) &&*/ iterations < 10)
 	{
 		copyIterLayer();
 
-		fill(PRES);
-		pres_solver.Assemble(ind_i, ind_j, a, presElemNum, ind_rhs, rhs);
-		pres_solver.Solve();
+		if (pres_solver.getConfig().isJFNK && !pres_solver.needsJacobian())
+		{
+			// Lagged matrix is kept for the preconditioner
+			fillResidual(rhs);
+			pres_solver.AssembleRhs(rhs);
+			pres_solver.SolveMatrixFree(*this);
+		} else {
+			a = pres_solver.beginAssemble();
+			fill(PRES);
+			pres_solver.Assemble(rhs);
+			pres_solver.Solve();
+		}
 		copySolution( pres_solver.getSolution(), PRES );
 
 		model->solveP_bub();
@@ -270,8 +321,9 @@ void ParPerfNITSolver::solveStep()
 		iterations++;
 	}
 
+	ta = temp_solver.beginAssemble();
 	fill(TEMP);
-	temp_solver.Assemble(tind_i, tind_j, ta, tempElemNum, tind_rhs, trhs);
+	temp_solver.Assemble(trhs);
 	temp_solver.Solve();
 	copySolution(temp_solver.getSolution(), TEMP);
 
@@ -287,10 +339,13 @@ void ParPerfNITSolver::fillIndices(int key)
 
 	if (key == PRES)
 	{
+		presPlan.clear();
+
 		// Left
 		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
 		{
 			idx = it.getIdx();
+			presPlan.push_back({ idx, FILL_BOUND, counter });
 
 			if (it->isUsed)
 			{
@@ -335,17 +390,27 @@ void ParPerfNITSolver::fillIndices(int key)
 			idx = it.getIdx();
 			res = idx % (model->cellsNum_z + 2);
 			if (res == 0)
+			{
+				presPlan.push_back({ idx, FILL_TOP, counter });
 				stencils->top->fillIndex(idx, &counter);
+			}
 			else if (res == model->cellsNum_z + 1)
+			{
+				presPlan.push_back({ idx, FILL_BOT, counter });
 				stencils->bot->fillIndex(idx, &counter);
+			}
 			else
+			{
+				presPlan.push_back({ idx, FILL_MIDDLE, counter });
 				stencils->middle->fillIndex(idx, &counter);
+			}
 		}
 
 		// Right
 		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
 		{
 			idx = it.getIdx();
+			presPlan.push_back({ idx, FILL_RIGHT, counter });
 			stencils->right->fillIndex(idx, &counter);
 		}
 
@@ -353,20 +418,21 @@ void ParPerfNITSolver::fillIndices(int key)
 		vector<Cell>::iterator itr;
 		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
 		{
+			presPlan.push_back({ itr->num, FILL_TUNNEL, counter });
 			stencils->left->fillIndex(itr->num, &counter);
 		}
 
 		presElemNum = counter;
-
-		for (int i = 0; i < 2 * (model->cellsNum + model->tunnelCells.size()); i++)
-			ind_rhs[i] = i;
 	}
 	else if (key == TEMP)
 	{
+		tempPlan.clear();
+
 		// Left
 		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
 		{
 			idx = it.getIdx();
+			tempPlan.push_back({ idx, FILL_BOUND, counter });
 
 			if (it->isUsed)
 			{
@@ -391,6 +457,7 @@ void ParPerfNITSolver::fillIndices(int key)
 			res = idx % (model->cellsNum_z + 2);
 			if (res == 0)
 			{
+				tempPlan.push_back({ idx, FILL_TOP, counter });
 				tind_i[counter] = idx;
 				tind_j[counter++] = idx;
 
@@ -399,14 +466,16 @@ void ParPerfNITSolver::fillIndices(int key)
 			}
 			else if (res == model->cellsNum_z + 1)
 			{
+				tempPlan.push_back({ idx, FILL_BOT, counter });
 				tind_i[counter] = idx;
 				tind_j[counter++] = idx;
 
 				tind_i[counter] = idx;
 				tind_j[counter++] = idx - 1;
-			} 
+			}
 			else
 			{
+				tempPlan.push_back({ idx, FILL_MIDDLE, counter });
 				Cell* nebr[7];
 				model->getStencilIdx(idx, nebr);
 
@@ -433,6 +502,7 @@ void ParPerfNITSolver::fillIndices(int key)
 		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
 		{
 			idx = it.getIdx();
+			tempPlan.push_back({ idx, FILL_RIGHT, counter });
 
 			tind_i[counter] = idx;
 			tind_j[counter++] = idx;
@@ -442,6 +512,7 @@ void ParPerfNITSolver::fillIndices(int key)
 		vector<Cell>::iterator itr;
 		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
 		{
+			tempPlan.push_back({ itr->num, FILL_TUNNEL, counter });
 			tind_i[counter] = itr->num + model->cellsNum;
 			tind_j[counter++] = itr->num + model->cellsNum;
 
@@ -453,198 +524,282 @@ void ParPerfNITSolver::fillIndices(int key)
 		}
 
 		tempElemNum = counter;
-
-		for (int i = 0; i < model->cellsNum + model->tunnelCells.size(); i++)
-			tind_rhs[i] = i;
 	}
 }
 
 void ParPerfNITSolver::fill(int key)
 {
-	int idx;
-	int counter = 0;
-	Iterator it;
-	map<int, double>::iterator itPerf;
-
 	if (key == PRES)
+		stencils->setValueStorages(a, pres_solver.getSlots(), rhs);
+
+	const std::vector<FillCell>& plan = (key == PRES ? presPlan : tempPlan);
+	const int cellsNum = (int)plan.size();
+	#pragma omp parallel for num_threads(fillThreads) schedule(static)
+	for (int k = 0; k < cellsNum; k++)
 	{
-		// Left
-		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
-		{
-			idx = it.getIdx();
+		int counter = plan[k].offset;
+		fillCell(plan[k], &counter, key);
+	}
+}
 
-			if (it->isUsed)
-			{
-				a[counter++] = 1.0;
-				a[counter++] = 0.0;
-				a[counter++] = -1.0;
-				a[counter++] = 0.0;
-
-				a[counter++] = 0.0;
-				a[counter++] = 1.0;
-				a[counter++] = 0.0;
-				a[counter++] = -1.0;
-
-				rhs[2 * idx] = 0.0;
-				rhs[2 * idx + 1] = 0.0;
-			}
-			else {
-				a[counter++] = 1.0;
-				a[counter++] = 1.0;
+void ParPerfNITSolver::fillResidual(double* res)
+{
+	// Matrix values are owned by the solver between assemblies
+	stencils->setValueStorages(NULL, NULL, res);
 
-				rhs[2 * idx] = 0.0;
-				rhs[2 * idx + 1] = 0.0;
-			}
-		}
+	const int cellsNum = (int)presPlan.size();
+	#pragma omp parallel for num_threads(fillThreads) schedule(static)
+	for (int k = 0; k < cellsNum; k++)
+		fillCellRhs(presPlan[k], res);
+}
 
-		// Middle
-		int res;
-		for (it = model->getMidBegin(); it != model->getMidEnd(); ++it)
-		{
-			idx = it.getIdx();
-			res = idx % (model->cellsNum_z + 2);
-			if (res == 0)
-				stencils->top->fill(idx, &counter);
-			else if (res == model->cellsNum_z + 1)
-				stencils->bot->fill(idx, &counter);
-			else
-				stencils->middle->fill(idx, &counter);
-		}
+void ParPerfNITSolver::fillCellRhs(const FillCell& cell, double* res)
+{
+	const int idx = cell.idx;
 
-		// Right
-		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
+	switch (cell.type)
+	{
+	case FILL_BOUND:
+	{
+		// Linear rows are relative to the iteration layer, so residual is zero as in fillCell()
+		const Cell& cur = model->cells[idx];
+		if (cur.isUsed)
 		{
-			idx = it.getIdx();
-			stencils->right->fill(idx, &counter);
+			const Cell& nebr = model->cells[idx + model->cellsNum_z + 2];
+			res[2 * idx] = -(cur.u_next.p - nebr.u_next.p - cur.u_iter.p + nebr.u_iter.p);
+			res[2 * idx + 1] = -(cur.u_next.s - nebr.u_next.s - cur.u_iter.s + nebr.u_iter.s);
 		}
-
-		// Tunnel cells
-		vector<Cell>::iterator itr;
-		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
-		{
-			stencils->left->fill(itr->num, &counter);
+		else {
+			res[2 * idx] = -(cur.u_next.p - cur.u_iter.p);
+			res[2 * idx + 1] = -(cur.u_next.s - cur.u_iter.s);
 		}
+		break;
 	}
-	else if (key == TEMP)
+	case FILL_TOP:
+		stencils->top->fillRhs(idx);
+		break;
+	case FILL_BOT:
+		stencils->bot->fillRhs(idx);
+		break;
+	case FILL_MIDDLE:
+		stencils->middle->fillRhs(idx);
+		break;
+	case FILL_RIGHT:
+		stencils->right->fillRhs(idx);
+		break;
+	case FILL_TUNNEL:
+		stencils->left->fillRhs(idx);
+		break;
+	}
+}
+
+void ParPerfNITSolver::perturbCell(Cell& cell, const double* v, const double eps)
+{
+	Var2phaseNIT& next = cell.u_next;
+	const Var2phaseNIT& iter = cell.u_iter;
+
+	next.p = iter.p + eps * v[0];
+	next.s = iter.s + eps * v[1];
+	// Bubble point follows pressure in saturated cells and is the frozen state otherwise, as solveP_bub() updates it after the solve
+	next.SATUR = iter.SATUR;
+	next.p_bub = (iter.SATUR ? next.p : iter.p_bub);
+}
+
+void ParPerfNITSolver::perturb(const double* v, const double eps)
+{
+	for (int i = 0; i < model->cellsNum; i++)
+		perturbCell(model->cells[i], v + 2 * i, eps);
+
+	for (int i = 0; i < model->tunnelCells.size(); i++)
+		perturbCell(model->tunnelCells[i], v + 2 * (i + model->cellsNum), eps);
+}
+
+void ParPerfNITSolver::applyJacobian(const double* v, double* y)
+{
+	const int size = (int)pertRhs.size();
+	double vNorm = 0.0, uNorm = 0.0;
+	for (int i = 0; i < size; i++)
+		vNorm += v[i] * v[i];
+	// Norm over all the unknowns including tunnel cells
+	for (int i = 0; i < model->cellsNum; i++)
 	{
-		// Left
-		for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
-		{
-			idx = it.getIdx();
+		const Var2phaseNIT& iter = model->cells[i].u_iter;
+		uNorm += iter.p * iter.p + iter.s * iter.s;
+	}
+	for (int i = 0; i < model->tunnelCells.size(); i++)
+	{
+		const Var2phaseNIT& iter = model->tunnelCells[i].u_iter;
+		uNorm += iter.p * iter.p + iter.s * iter.s;
+	}
+	vNorm = sqrt(vNorm);
+	uNorm = sqrt(uNorm);
 
-			if (it->isUsed)
-			{
-				ta[counter++] = 1.0;
-				ta[counter++] = -1.0;
+	if (vNorm == 0.0)
+	{
+		std::fill(y, y + size, 0.0);
+		return;
+	}
 
-				trhs[idx] = 0.0;
+	const double eps = sqrt(DBL_EPSILON) * (1.0 + uNorm) / vNorm;
+	perturb(v, eps);
+	fillResidual(&pertRhs[0]);
+	perturb(v, 0.0);
+
+	// rhs keeps -F(u_iter)
+	for (int i = 0; i < size; i++)
+		y[i] = (rhs[i] - pertRhs[i]) / eps;
+}
+
+void ParPerfNITSolver::fillCell(const FillCell& cell, int* counter, int key)
+{
+	const int idx = cell.idx;
+
+	if (key == PRES)
+	{
+		const int* slots = pres_solver.getSlots();
+
+		switch (cell.type)
+		{
+		case FILL_BOUND:
+			if (model->cells[idx].isUsed)
+			{
+				a[slots[(*counter)++]] += 1.0;
+				a[slots[(*counter)++]] += 0.0;
+				a[slots[(*counter)++]] += -1.0;
+				a[slots[(*counter)++]] += 0.0;
+
+				a[slots[(*counter)++]] += 0.0;
+				a[slots[(*counter)++]] += 1.0;
+				a[slots[(*counter)++]] += 0.0;
+				a[slots[(*counter)++]] += -1.0;
 			}
 			else {
-				ta[counter++] = 1.0;
-				trhs[idx] = 0.0;
+				a[slots[(*counter)++]] += 1.0;
+				a[slots[(*counter)++]] += 1.0;
 			}
+
+			rhs[2 * idx] = 0.0;
+			rhs[2 * idx + 1] = 0.0;
+			break;
+		case FILL_TOP:
+			stencils->top->fill(idx, counter);
+			break;
+		case FILL_BOT:
+			stencils->bot->fill(idx, counter);
+			break;
+		case FILL_MIDDLE:
+			stencils->middle->fill(idx, counter);
+			break;
+		case FILL_RIGHT:
+			stencils->right->fill(idx, counter);
+			break;
+		case FILL_TUNNEL:
+			stencils->left->fill(idx, counter);
+			break;
 		}
+	}
+	else if (key == TEMP)
+	{
+		const int* tslots = temp_solver.getSlots();
 
-		// Middle
-		int res;
-		for (it = model->getMidBegin(); it != model->getMidEnd(); ++it)
+		switch (cell.type)
 		{
-			idx = it.getIdx();
-			res = idx % (model->cellsNum_z + 2);
-			if (res == 0)
+		case FILL_BOUND:
+			if (model->cells[idx].isUsed)
 			{
-				ta[counter++] = 1.0;
-				ta[counter++] = -1.0;
-				trhs[idx] = 0.0;
+				ta[tslots[(*counter)++]] += 1.0;
+				ta[tslots[(*counter)++]] += -1.0;
 			}
-			else if (res == model->cellsNum_z + 1)
+			else {
+				ta[tslots[(*counter)++]] += 1.0;
+			}
+
+			trhs[idx] = 0.0;
+			break;
+		case FILL_TOP:
+		case FILL_BOT:
+			ta[tslots[(*counter)++]] += 1.0;
+			ta[tslots[(*counter)++]] += -1.0;
+			trhs[idx] = 0.0;
+			break;
+		case FILL_MIDDLE:
+		{
+			Cell* nebr[7];
+			model->getStencilIdx(idx, nebr);
+
+			if (nebr[0]->isUsed)
 			{
-				ta[counter++] = 1.0;
-				ta[counter++] = -1.0;
-				trhs[idx] = 0.0;
+				double tcoef[7];
+				tcoef[1] = -2.0 * (max(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) +
+					model->getLambda(*nebr[0], *nebr[1]) * (nebr[0]->r - nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[1]->hr);
+				tcoef[2] = 2.0 * (min(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) -
+					model->getLambda(*nebr[0], *nebr[2]) * (nebr[0]->r + nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[2]->hr);
+				tcoef[3] = -2.0 * (max(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) +
+					model->getLambda(*nebr[0], *nebr[3]) / nebr[0]->hz) / (nebr[0]->hz + nebr[3]->hz);
+				tcoef[4] = 2.0 * (min(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) -
+					model->getLambda(*nebr[0], *nebr[4]) / nebr[0]->hz) / (nebr[0]->hz + nebr[4]->hz);
+				tcoef[5] = -2.0 * (max(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) +
+					model->getLambda(*nebr[0], *nebr[5]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[5]->hphi);
+				tcoef[6] = 2.0 * (min(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) -
+					model->getLambda(*nebr[0], *nebr[6]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[6]->hphi);
+				tcoef[0] = model->getCn(*nebr[0]) / model->ht 
+					- tcoef[1]
+					- tcoef[2]
+					- tcoef[3]
+					- tcoef[4]
+					- tcoef[5]
+					- tcoef[6];
+
+				trhs[idx] = model->getCn(*nebr[0]) * nebr[0]->u_prev.t / model->ht +
+					model->getAd(*nebr[0]) * (nebr[0]->u_next.p - nebr[0]->u_prev.p) / model->ht -
+					model->getJT(*nebr[0], NEXT, R_AXIS) * model->getNablaP(*nebr[0], NEXT, R_AXIS) -
+					model->getJT(*nebr[0], NEXT, PHI_AXIS) * model->getNablaP(*nebr[0], NEXT, PHI_AXIS) -
+					model->getJT(*nebr[0], NEXT, Z_AXIS) * model->getNablaP(*nebr[0], NEXT, Z_AXIS) -
+					model->solve_PhaseTrans(idx) * model->L;
+
+				for (int j = 0; j < 7; j++)
+					ta[tslots[(*counter)++]] += tcoef[j];
 			}
 			else
 			{
-				Cell* nebr[7];
-				model->getStencilIdx(idx, nebr);
-
-				if (nebr[0]->isUsed)
-				{
-					ta[counter+1] = -2.0 * (max(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) +
-						model->getLambda(*nebr[0], *nebr[1]) * (nebr[0]->r - nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[1]->hr);
-					ta[counter+2] = 2.0 * (min(model->getA(*nebr[0], NEXT, R_AXIS), 0.0) -
-						model->getLambda(*nebr[0], *nebr[2]) * (nebr[0]->r + nebr[0]->hr / 2.0) / nebr[0]->r / nebr[0]->hr) / (nebr[0]->hr + nebr[2]->hr);
-					ta[counter+3] = -2.0 * (max(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) +
-						model->getLambda(*nebr[0], *nebr[3]) / nebr[0]->hz) / (nebr[0]->hz + nebr[3]->hz);
-					ta[counter+4] = 2.0 * (min(model->getA(*nebr[0], NEXT, Z_AXIS), 0.0) -
-						model->getLambda(*nebr[0], *nebr[4]) / nebr[0]->hz) / (nebr[0]->hz + nebr[4]->hz);
-					ta[counter+5] = -2.0 * (max(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) +
-						model->getLambda(*nebr[0], *nebr[5]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[5]->hphi);
-					ta[counter+6] = 2.0 * (min(model->getA(*nebr[0], NEXT, PHI_AXIS), 0.0) -
-						model->getLambda(*nebr[0], *nebr[6]) / nebr[0]->r / nebr[0]->hphi) / nebr[0]->r / (nebr[0]->hphi + nebr[6]->hphi);
-					ta[counter] = model->getCn(*nebr[0]) / model->ht 
-						- ta[counter + 1]
-						- ta[counter + 2]
-						- ta[counter + 3]
-						- ta[counter + 4]
-						- ta[counter + 5]
-						- ta[counter + 6];
-
-					trhs[idx] = model->getCn(*nebr[0]) * nebr[0]->u_prev.t / model->ht +
-						model->getAd(*nebr[0]) * (nebr[0]->u_next.p - nebr[0]->u_prev.p) / model->ht -
-						model->getJT(*nebr[0], NEXT, R_AXIS) * model->getNablaP(*nebr[0], NEXT, R_AXIS) -
-						model->getJT(*nebr[0], NEXT, PHI_AXIS) * model->getNablaP(*nebr[0], NEXT, PHI_AXIS) -
-						model->getJT(*nebr[0], NEXT, Z_AXIS) * model->getNablaP(*nebr[0], NEXT, Z_AXIS) -
-						model->solve_PhaseTrans(idx) * model->L;
-
-					counter += 7;
-				}
-				else
-				{
-					ta[counter++] = 1.0;
-					trhs[idx] = 0.0;
-				}
+				ta[tslots[(*counter)++]] += 1.0;
+				trhs[idx] = 0.0;
 			}
+			break;
 		}
+		case FILL_RIGHT:
+			ta[tslots[(*counter)++]] += 1.0;
 
-		// Right
-		for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
+			trhs[idx] = model->props_sk[model->getSkeletonIdx(model->cells[idx])].t_init;
+			break;
+		case FILL_TUNNEL:
 		{
-			idx = it.getIdx();
-
-			ta[counter++] = 1.0;
-
-			trhs[idx] = model->props_sk[model->getSkeletonIdx(model->cells[idx])].t_init;;
-		}
-
-		// Tunnel cells
-		vector<Cell>::iterator itr;
-		for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
-		{
-			Cell& cell = *itr;
-			Cell& nebr1 = model->getCell(model->nebrMap[itr->num].first);
-			Cell& nebr2 = model->getCell(model->nebrMap[itr->num].second);
+			Cell& tunnel = model->tunnelCells[idx];
+			Cell& nebr1 = model->getCell(model->nebrMap[idx].first);
+			Cell& nebr2 = model->getCell(model->nebrMap[idx].second);
 
 			if (fabs(nebr2.r - nebr1.r) > EQUALITY_TOLERANCE)
 			{
-				ta[counter++] = 1.0 / (nebr1.r - cell.r);
-				ta[counter++] = -1.0 / (nebr2.r - nebr1.r) - 1.0 / (nebr1.r - cell.r);
-				ta[counter++] = 1.0 / (nebr2.r - nebr1.r);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr1.r - tunnel.r);
+				ta[tslots[(*counter)++]] += -1.0 / (nebr2.r - nebr1.r) - 1.0 / (nebr1.r - tunnel.r);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr2.r - nebr1.r);
 			}
 			else if (fabs(nebr2.z - nebr1.z) > EQUALITY_TOLERANCE)
 			{
-				ta[counter++] = 1.0 / (nebr1.z - cell.z);
-				ta[counter++] = -1.0 / (nebr2.z - nebr1.z) - 1.0 / (nebr1.z - cell.z);
-				ta[counter++] = 1.0 / (nebr2.z - nebr1.z);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr1.z - tunnel.z);
+				ta[tslots[(*counter)++]] += -1.0 / (nebr2.z - nebr1.z) - 1.0 / (nebr1.z - tunnel.z);
+				ta[tslots[(*counter)++]] += 1.0 / (nebr2.z - nebr1.z);
 			}
 			else if (fabs(nebr2.phi - nebr1.phi) > EQUALITY_TOLERANCE)
 			{
-				ta[counter++] = 1.0 / (nebr1.phi - cell.phi) / nebr1.r;
-				ta[counter++] = -1.0 / (nebr2.phi - nebr1.phi) / nebr1.r - 1.0 / (nebr1.phi - cell.phi) / nebr1.r;
-				ta[counter++] = 1.0 / (nebr2.phi - nebr1.phi) / nebr1.r;
+				ta[tslots[(*counter)++]] += 1.0 / (nebr1.phi - tunnel.phi) / nebr1.r;
+				ta[tslots[(*counter)++]] += -1.0 / (nebr2.phi - nebr1.phi) / nebr1.r - 1.0 / (nebr1.phi - tunnel.phi) / nebr1.r;
+				ta[tslots[(*counter)++]] += 1.0 / (nebr2.phi - nebr1.phi) / nebr1.r;
 			}
 
-			trhs[itr->num + model->cellsNum] = 0.0;
+			trhs[idx + model->cellsNum] = 0.0;
+			break;
+		}
 		}
 	}
 }
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <map>
+#include <vector>
 
 #include "model/cells/stencils/Stencil.h"
 #include "model/AbstractSolver.hpp"
@@ -14,7 +15,7 @@
 
 namespace gasOil_perf_nit
 {
-	class ParPerfNITSolver : public AbstractSolver<GasOil_Perf_NIT>
+	class ParPerfNITSolver : public AbstractSolver<GasOil_Perf_NIT>, public JacobianOperator
 	{
 	protected:
 		std::ofstream plot_Tdyn;
@@ -60,6 +61,7 @@ namespace gasOil_perf_nit
 		};
 
 		void fill(int key);
+		void fillCell(const FillCell& cell, int* counter, int key);
 		void fillIndices(int key);
 		void copySolution(const paralution::LocalVector<double>& sol, int key);
 
@@ -70,25 +72,40 @@ namespace gasOil_perf_nit
 		ParSolver pres_solver;
 		ParSolver temp_solver;
 
-		// Coordinate form of sparse matrix & dense vector
+		// Coordinate form of sparse matrix pattern, CSR values & dense vector
 		int* ind_i;
 		int* ind_j;
 		double* a;
-		int* ind_rhs;
 		double* rhs;
 		//
 		int* tind_i;
 		int* tind_j;
 		double* ta;
-		int* tind_rhs;
 		double* trhs;
 
 		// Number of non-zero elements in sparse matrix
 		int presElemNum;
 		int tempElemNum;
+		// Cells in filling order
+		std::vector<FillCell> presPlan;
+		std::vector<FillCell> tempPlan;
+
+		// Jacobian-free Newton-Krylov for the pressure-saturation system
+		std::vector<double> pertRhs;
+		// Residual of pressure-saturation system without the matrix
+		void fillResidual(double* res);
+		void fillCellRhs(const FillCell& cell, double* res);
+		// Sets u_next = u_iter + eps * v for pressure & saturation, bubble point pressure is kept consistent with SATUR
+		void perturb(const double* v, const double eps);
+		void perturbCell(Cell& cell, const double* v, const double eps);
+		// Forward difference of the residual
+		void applyJacobian(const double* v, double* y);
 
 	public:
-		ParPerfNITSolver(GasOil_Perf_NIT* _model);
+		ParPerfNITSolver(GasOil_Perf_NIT* _model, const ParSolverConfig* presConfig = NULL, const ParSolverConfig* tempConfig = NULL);
+		// Settings used without configs, config files are loaded over them
+		static ParSolverConfig getPresDefaultConfig();
+		static ParSolverConfig getTempDefaultConfig();
 		~ParPerfNITSolver();
 
 		void start();
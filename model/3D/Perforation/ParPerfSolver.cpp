@@ -6,7 +6,7 @@
 using namespace std;
 using namespace gasOil_perf;
 
-ParPerfSolver::ParPerfSolver(GasOil_Perf* _model) : AbstractSolver<GasOil_Perf>(_model)
+ParPerfSolver::ParPerfSolver(GasOil_Perf* _model, const ParSolverConfig* config) : AbstractSolver<GasOil_Perf>(_model)
 {
 	// Output streams
 	plot_Pdyn.open("snaps/P_dyn.dat", ofstream::out);
@@ -28,13 +28,22 @@ ParPerfSolver::ParPerfSolver(GasOil_Perf* _model) : AbstractSolver<GasOil_Perf>(
 	// Memory allocating
 	ind_i = new int[7 * 4 * model->cellsNum];
 	ind_j = new int[7 * 4 * model->cellsNum];
-	a = new double[7 * 4 * model->cellsNum];
-	ind_rhs = new int[2 * (model->cellsNum + model->tunnelCells.size())];
 	rhs = new double[2 * (model->cellsNum + model->tunnelCells.size())];
 
 	// Stencils allocating
 	stencils = new UsedStencils<GasOil_Perf>(model);
-	stencils->setStorages(a, ind_i, ind_j, rhs);
+	stencils->setIndexStorages(ind_i, ind_j);
+
+	// Rejected config falls back to the defaults
+	if (config == NULL || !solver.setConfig(*config))
+		solver.setConfig(getDefaultConfig());
+}
+
+ParSolverConfig ParPerfSolver::getDefaultConfig()
+{
+	// Pressure-saturation point blocks
+	ParSolverConfig config(PRECOND_CPR, 2);
+	return config;
 }
 
 ParPerfSolver::~ParPerfSolver()
@@ -43,6 +52,12 @@ ParPerfSolver::~ParPerfSolver()
 	plot_Pdyn.close();
 	plot_Sdyn.close();
 	plot_qcells.close();
+
+	// Releasing buffers
+	delete stencils;
+	delete[] ind_i;
+	delete[] ind_j;
+	delete[] rhs;
 }
 
 void ParPerfSolver::writeData()
@@ -76,6 +91,7 @@ void ParPerfSolver::writeData()
 
 void ParPerfSolver::control()
 {
+	const double ht_prev = model->ht;
 	writeData();
 
 	if (cur_t >= model->period[curTimePeriod])
@@ -83,6 +99,7 @@ void ParPerfSolver::control()
 		curTimePeriod++;
 		model->ht = model->ht_min;
 		model->setPeriod(curTimePeriod);
+		solver.setNewPeriod();
 	}
 
 	if (model->ht <= model->ht_max && iterations < 6)
@@ -94,6 +111,7 @@ void ParPerfSolver::control()
 		model->ht = model->period[curTimePeriod] - cur_t;
 
 	cur_t += model->ht;
+	solver.setNewTimeStep(model->ht / ht_prev);
 }
 
 void ParPerfSolver::start()
@@ -101,8 +119,13 @@ void ParPerfSolver::start()
 	int counter = 0;
 	iterations = 8;
 
-	fillIndices();
 	solver.Init(2 * (model->cellsNum + model->tunnelCells.size()));
+	fillIndices();
+	solver.setPattern(ind_i, ind_j, elemNum);
+	delete[] ind_i;
+	delete[] ind_j;
+	ind_i = ind_j = NULL;
+	stencils->setIndexStorages(NULL, NULL);
 
 	model->setPeriod(curTimePeriod);
 	while (cur_t < Tt)
@@ -117,6 +140,7 @@ void ParPerfSolver::start()
 	if (model->isWriteSnaps)
 		model->snapshot_all(counter++);
 	writeData();
+	solver.getRunStats().print("Linear solver run");
 }
 
 void ParPerfSolver::doNextStep()
@@ -181,13 +205,15 @@ void ParPerfSolver::solveStep()
 	double averPres, averSat;
 	double dAverPres = 1.0, dAverSat = 1.0;
 
+	solver.setNewNewtonLoop();
 	iterations = 0;
 	while (err_newton > 1.e-4 /*&& (dAverSat > 1.e-9 || dAverPres > 1.e-7)*/ && iterations < 10)
 	{
 		copyIterLayer();
 
+		a = solver.beginAssemble();
 		fill();
-		solver.Assemble(ind_i, ind_j, a, elemNum, ind_rhs, rhs);
+		solver.Assemble(rhs);
 		solver.Solve();
 		copySolution( solver.getSolution() );
 
@@ -217,10 +243,13 @@ void ParPerfSolver::fillIndices()
 	Iterator it;
 	map<int, double>::iterator itPerf;
 
+	plan.clear();
+
 	// Left
 	for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
 	{
 		idx = it.getIdx();
+		plan.push_back({ idx, FILL_BOUND, counter });
 
 		if (it->isUsed)
 		{
@@ -264,18 +293,28 @@ void ParPerfSolver::fillIndices()
 	{
 		idx = it.getIdx();
 		res = idx % (model->cellsNum_z + 2);
-		if( res == 0 )
+		if (res == 0)
+		{
+			plan.push_back({ idx, FILL_TOP, counter });
 			stencils->top->fillIndex(idx, &counter);
-		else if( res == model->cellsNum_z + 1)
+		}
+		else if (res == model->cellsNum_z + 1)
+		{
+			plan.push_back({ idx, FILL_BOT, counter });
 			stencils->bot->fillIndex(idx, &counter);
+		}
 		else
-			stencils->middle->fillIndex(idx, &counter);	
+		{
+			plan.push_back({ idx, FILL_MIDDLE, counter });
+			stencils->middle->fillIndex(idx, &counter);
+		}
 	}
 
 	// Right
 	for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
 	{
 		idx = it.getIdx();
+		plan.push_back({ idx, FILL_RIGHT, counter });
 		stencils->right->fillIndex(idx, &counter);
 	}
 
@@ -283,77 +322,69 @@ void ParPerfSolver::fillIndices()
 	vector<Cell>::iterator itr;
 	for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
 	{
+		plan.push_back({ itr->num, FILL_TUNNEL, counter });
 		stencils->left->fillIndex(itr->num, &counter);
 	}
 
 	elemNum = counter;
-
-	for (int i = 0; i < 2*(model->cellsNum + model->tunnelCells.size()); i++)
-		ind_rhs[i] = i;
 }
 
 void ParPerfSolver::fill()
 {
-	int idx;
-	int counter = 0;
-	Iterator it;
-	map<int, double>::iterator itPerf;
+	stencils->setValueStorages(a, solver.getSlots(), rhs);
 
-	// Left
-	for (it = model->getLeftBegin(); it != model->getLeftEnd(); ++it)
+	const int cellsNum = (int)plan.size();
+	#pragma omp parallel for num_threads(fillThreads) schedule(static)
+	for (int k = 0; k < cellsNum; k++)
 	{
-		idx = it.getIdx();
+		int counter = plan[k].offset;
+		fillCell(plan[k], &counter);
+	}
+}
 
-		if (it->isUsed)
+void ParPerfSolver::fillCell(const FillCell& cell, int* counter)
+{
+	const int idx = cell.idx;
+	const int* slots = solver.getSlots();
+
+	switch (cell.type)
+	{
+	case FILL_BOUND:
+		if (model->cells[idx].isUsed)
 		{
-			a[counter++] = 1.0;
-			a[counter++] = 0.0;
-			a[counter++] = -1.0;
-			a[counter++] = 0.0;
-
-			a[counter++] = 0.0;
-			a[counter++] = 1.0;
-			a[counter++] = 0.0;
-			a[counter++] = -1.0;
-
-			rhs[2 * idx] = 0.0;
-			rhs[2 * idx + 1] = 0.0;
+			a[slots[(*counter)++]] += 1.0;
+			a[slots[(*counter)++]] += 0.0;
+			a[slots[(*counter)++]] += -1.0;
+			a[slots[(*counter)++]] += 0.0;
+
+			a[slots[(*counter)++]] += 0.0;
+			a[slots[(*counter)++]] += 1.0;
+			a[slots[(*counter)++]] += 0.0;
+			a[slots[(*counter)++]] += -1.0;
 		}
 		else {
-			a[counter++] = 1.0;
-			a[counter++] = 1.0;
-
-			rhs[2 * idx] = 0.0;
-			rhs[2 * idx + 1] = 0.0;
+			a[slots[(*counter)++]] += 1.0;
+			a[slots[(*counter)++]] += 1.0;
 		}
-	}
-
-	// Middle
-	int res;
-	for (it = model->getMidBegin(); it != model->getMidEnd(); ++it)
-	{
-		idx = it.getIdx();
-		res = idx % (model->cellsNum_z + 2);
-		if (res == 0)
-			stencils->top->fill(idx, &counter);
-		else if (res == model->cellsNum_z + 1)
-			stencils->bot->fill(idx, &counter);
-		else
-			stencils->middle->fill(idx, &counter);
-	}
 
-	// Right
-	for (it = model->getRightBegin(); it != model->getRightEnd(); ++it)
-	{
-		idx = it.getIdx();
-		stencils->right->fill(idx, &counter);
-	}
-
-	// Tunnel cells
-	vector<Cell>::iterator itr;
-	for (itr = model->tunnelCells.begin(); itr != model->tunnelCells.end(); ++itr)
-	{
-		stencils->left->fill(itr->num, &counter);
+		rhs[2 * idx] = 0.0;
+		rhs[2 * idx + 1] = 0.0;
+		break;
+	case FILL_TOP:
+		stencils->top->fill(idx, counter);
+		break;
+	case FILL_BOT:
+		stencils->bot->fill(idx, counter);
+		break;
+	case FILL_MIDDLE:
+		stencils->middle->fill(idx, counter);
+		break;
+	case FILL_RIGHT:
+		stencils->right->fill(idx, counter);
+		break;
+	case FILL_TUNNEL:
+		stencils->left->fill(idx, counter);
+		break;
 	}
 }
 
@@ -57,6 +57,7 @@ namespace gasOil_perf
 		};
 
 		void fill();
+		void fillCell(const FillCell& cell, int* counter);
 		void fillIndices();
 		void copySolution(const paralution::LocalVector<double>& sol);
 
@@ -66,17 +67,20 @@ namespace gasOil_perf
 		// Sparse matrix solver
 		ParSolver solver;
 
-		// Coordinate form of sparse matrix & dense vector
+		// Coordinate form of sparse matrix pattern, CSR values & dense vector
 		int* ind_i;
 		int* ind_j;
 		double* a;
-		int* ind_rhs;
 		double* rhs;
 		// Number of non-zero elements in sparse matrix
 		int elemNum;
+		// Cells in filling order
+		std::vector<FillCell> plan;
 
 	public:
-		ParPerfSolver(GasOil_Perf* _model);
+		ParPerfSolver(GasOil_Perf* _model, const ParSolverConfig* config = NULL);
+		// Settings used without config, config files are loaded over them
+		static ParSolverConfig getDefaultConfig();
 		~ParPerfSolver();
 
 		void start();
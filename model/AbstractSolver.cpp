@@ -19,12 +19,26 @@
 
 #include <iomanip>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
+static int getMaxThreads()
+{
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
 template <class modelType>
 AbstractSolver<modelType>::AbstractSolver(modelType* _model) : model(_model), size(_model->getCellsNum()), Tt(model->period[model->period.size()-1])
 {
 	newton_step = 1.0;
+	fillThreads = getMaxThreads();
 	isWellboreAffect = false;
 	cur_t = cur_t_log = 0.0;
 	curTimePeriod = 0;
@@ -39,6 +53,7 @@ template <>
 AbstractSolver<gasOil_perf::GasOil_Perf>::AbstractSolver(gasOil_perf::GasOil_Perf* _model) : model(_model), size(_model->getCellsNum()), Tt(model->period[model->period.size() - 1])
 {
 	newton_step = 1.0;
+	fillThreads = getMaxThreads();
 	cur_t = cur_t_log = 0.0;
 	curTimePeriod = 0;
 
@@ -49,6 +64,7 @@ template <>
 AbstractSolver<oil_perf_nit::Oil_Perf_NIT>::AbstractSolver(oil_perf_nit::Oil_Perf_NIT* _model) : model(_model), size(_model->getCellsNum()), Tt(model->period[model->period.size() - 1])
 {
 	newton_step = 1.0;
+	fillThreads = getMaxThreads();
 	isWellboreAffect = false;
 	cur_t = cur_t_log = 0.0;
 	curTimePeriod = 0;
@@ -60,6 +76,7 @@ template <>
 AbstractSolver<gasOil_perf_nit::GasOil_Perf_NIT>::AbstractSolver(gasOil_perf_nit::GasOil_Perf_NIT* _model) : model(_model), size(_model->getCellsNum()), Tt(model->period[model->period.size() - 1])
 {
 	newton_step = 1.0;
+	fillThreads = getMaxThreads();
 	isWellboreAffect = false;
 	cur_t = cur_t_log = 0.0;
 	curTimePeriod = 0;
@@ -73,6 +90,12 @@ AbstractSolver<modelType>::~AbstractSolver()
 {
 }
 
+template <class modelType>
+void AbstractSolver<modelType>::setFillThreads(const int threads)
+{
+	fillThreads = (threads > 0 ? threads : 1);
+}
+
 template <class modelType>
 void AbstractSolver<modelType>::start()
 {
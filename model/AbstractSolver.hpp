@@ -44,12 +44,17 @@ class AbstractSolver {
 
 		double newton_step;
 
+		// Number of threads for matrix filling
+		int fillThreads;
+
 	public:
 		AbstractSolver(modelType* _model);
 		virtual ~AbstractSolver();
 		
 		virtual void fill();
 		virtual void start();
+
+		void setFillThreads(const int threads);
 	
 };
 
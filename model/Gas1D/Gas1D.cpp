@@ -16,6 +16,8 @@ Gas1D::Gas1D()
 
 Gas1D::~Gas1D()
 {
+	releaseDataset(props_gas.visc_table);
+	releaseDataset(props_gas.z);
 }
 
 void Gas1D::setProps(Properties& props)
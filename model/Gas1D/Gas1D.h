@@ -2,6 +2,7 @@
 #define GAS1D_H_
 
 #include <vector>
+#include <string>
 #include <map>
 
 #include "util/utils.h"
@@ -99,9 +100,9 @@ namespace gas1D
 
 		double depth_point;
 
-		// Data set (saturation, relative oil permeability)
-		std::vector< std::pair<double,double> > z_factor;
-		std::vector< std::pair<double,double> > visc_gas;
+		// Data set file (saturation, relative oil permeability)
+		std::string z_factor;
+		std::string visc_gas;
 	};
 
 	class Gas1D : public AbstractModel<Var1phase, Properties, RadialCell, Gas1D>
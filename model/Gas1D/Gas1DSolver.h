@@ -6,7 +6,7 @@
 #include <map>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/CyclicSweep.h"
 
 namespace gas1D
 {
@@ -14,7 +14,7 @@ namespace gas1D
 	class Gas1D_simple;
 
 	template <class modelType>
-	class Gas1DSolver : public AbstractSolver<modelType>, public Sweep
+	class Gas1DSolver : public AbstractSolver<modelType>, public CyclicSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
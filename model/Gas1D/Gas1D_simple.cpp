@@ -16,6 +16,7 @@ Gas1D_simple::Gas1D_simple()
 
 Gas1D_simple::~Gas1D_simple()
 {
+	releaseDataset(props_gas.z);
 }
 
 void Gas1D_simple::setProps(Properties& props)
@@ -6,12 +6,12 @@
 #include <map>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/BandSweep.h"
 #include "model/GasOil_RZ/GasOil_RZ.h"
 
 namespace gasOil_rz
 {
-	class GasOil2DSolver : public AbstractSolver<GasOil_RZ>, public Sweep
+	class GasOil2DSolver : public AbstractSolver<GasOil_RZ>, public BandSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
@@ -12,6 +12,12 @@ GasOil_RZ::GasOil_RZ()
 
 GasOil_RZ::~GasOil_RZ()
 {
+	releaseDataset(props_oil.kr);
+	releaseDataset(props_gas.kr);
+	releaseDataset(props_oil.b);
+	releaseDataset(props_gas.b);
+	releaseDataset(Rs);
+	releaseDataset(Prs);
 }
 
 void GasOil_RZ::setProps(Properties& props)
@@ -313,6 +319,33 @@ void GasOil_RZ::setPeriod(int period)
 		props_sk[i].perm_eff = props_sk[i].perms_eff[period];
 		props_sk[i].skin = props_sk[i].skins[period];
 	}
+
+	buildTrans();
+}
+
+void GasOil_RZ::buildTrans()
+{
+	int neighbor[4];
+	int r_idx, z_idx;
+
+	trans.resize(4 * cellsNum);
+	for (int i = 0; i < cellsNum; i++)
+	{
+		r_idx = i / (cellsNum_z + 2);
+		z_idx = i % (cellsNum_z + 2);
+		neighbor[0] = (r_idx > 0 ? i - cellsNum_z - 2 : -1);
+		neighbor[1] = (r_idx < cellsNum_r + 1 ? i + cellsNum_z + 2 : -1);
+		neighbor[2] = (z_idx > 0 ? i - 1 : -1);
+		neighbor[3] = (z_idx < cellsNum_z + 1 ? i + 1 : -1);
+
+		for (int j = 0; j < 4; j++)
+		{
+			if (neighbor[j] < 0)
+				trans[4 * i + j] = 0.0;
+			else
+				trans[4 * i + j] = calcTrans(cells[i], cells[neighbor[j]]);
+		}
+	}
 }
 
 void GasOil_RZ::setRateDeviation(int num, double ratio)
@@ -353,23 +386,24 @@ double GasOil_RZ::solve_eq1_dp(int cur)
 
 	Cell& cell = cells[cur];
 	Var2phase& next = cell.u_next;
-	double Boil_upwd;
-	double Boil = getB_oil(next.p, next.p_bub, next.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	double Boil, Boil_dp;
+	getB_oil(next.p, next.p_bub, next.SATUR, Boil, Boil_dp);
 	
 	double H = 0.0;
 	H = (next.s * getPoro_dp(cell) - 
-		getPoro(next.p, cell) * next.s * getB_oil_dp(next.p, next.p_bub, next.SATUR) / Boil ) / Boil;
+		getPoro(next.p, cell) * next.s * Boil_dp / Boil ) / Boil;
 
 	for(int i = 0; i < 4; i++)
 	{
 		upwind = upwindIsCur(cur, neighbor[i]);
 		Var2phase& upwd = cells[ getUpwindIdx(cur, neighbor[i]) ].u_next;
-		Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
+		getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
 		Cell& beta = cells[ neighbor[i] ];
 
 		H += ht / cell.V * getTrans(cell, beta) * 
 			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd - 
-			upwind * (next.p - beta.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) );
+			upwind * (next.p - beta.u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * Boil_upwd_dp );
 	}
 	return H;
 }
@@ -405,11 +439,12 @@ double GasOil_RZ::solve_eq1_dp_beta(int cur, int beta)
 
 	double upwind = upwindIsCur(cur, beta);
 	Var2phase& upwd = cells[ getUpwindIdx(cur, beta) ].u_next;
-	double Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
 
 	return -ht / cell.V * getTrans(cell, cells[beta]) * 
 			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd + 
-			(1.0 - upwind) * (cell.u_next.p - cells[beta].u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) );
+			(1.0 - upwind) * (cell.u_next.p - cells[beta].u_next.p) * getKr_oil(upwd.s) / props_oil.visc / Boil_upwd / Boil_upwd * Boil_upwd_dp );
 }
 
 double GasOil_RZ::solve_eq1_ds_beta(int cur, int beta)
@@ -457,31 +492,34 @@ double GasOil_RZ::solve_eq2_dp(int cur)
 
 	Cell& cell = cells[cur];
 	Var2phase& next = cell.u_next;
-	double Boil_upwd, Bgas_upwd, rs_upwd;
-	double Boil = getB_oil(next.p, next.p_bub, next.SATUR);
-	double Bgas = getB_gas(next.p);
-	double rs = getRs(next.p, next.p_bub, next.SATUR);
+	double Boil_upwd, Boil_upwd_dp, Bgas_upwd, Bgas_upwd_dp, rs_upwd, rs_upwd_dp;
+	double Boil, Boil_dp;
+	getB_oil(next.p, next.p_bub, next.SATUR, Boil, Boil_dp);
+	double Bgas, Bgas_dp;
+	getB_gas(next.p, Bgas, Bgas_dp);
+	double rs, rs_dp;
+	getRs(next.p, next.p_bub, next.SATUR, rs, rs_dp);
 	
 	double H = 0.0;
 	H = ( (next.s * rs / Boil + (1.0 - next.s) / Bgas) * getPoro_dp(cell) - 
-		getPoro(next.p, cell) * ( (1.0 - next.s) / Bgas / Bgas * getB_gas_dp(next.p) + 
-		next.s * rs / Boil / Boil * getB_oil_dp(next.p, next.p_bub, next.SATUR) - 
-		next.s / Boil * getRs_dp(next.p, next.p_bub, next.SATUR) ) );
+		getPoro(next.p, cell) * ( (1.0 - next.s) / Bgas / Bgas * Bgas_dp + 
+		next.s * rs / Boil / Boil * Boil_dp - 
+		next.s / Boil * rs_dp ) );
 
 	for(int i = 0; i < 4; i++)
 	{
 		upwind = upwindIsCur(cur, neighbor[i]);
 		Var2phase& upwd = cells[ getUpwindIdx(cur, neighbor[i]) ].u_next;
-		Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
-		Bgas_upwd = getB_gas(upwd.p);
-		rs_upwd = getRs(upwd.p, upwd.p_bub, upwd.SATUR);
+		getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
+		getB_gas(upwd.p, Bgas_upwd, Bgas_upwd_dp);
+		getRs(upwd.p, upwd.p_bub, upwd.SATUR, rs_upwd, rs_upwd_dp);
 		Cell& beta = cells[ neighbor[i] ];
 
 		H += ht / cell.V * getTrans(cell, beta) * 
 			( getKr_oil(upwd.s) * rs_upwd / props_oil.visc / Boil_upwd + getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd + 
 			upwind * (next.p - beta.u_next.p) * 
-			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (getRs_dp(upwd.p, upwd.p_bub, upwd.SATUR) - rs_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) / Boil_upwd) - 
-			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * getB_gas_dp(upwd.p) ));
+			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp ));
 	}
 
 	return H;
@@ -519,15 +557,18 @@ double GasOil_RZ::solve_eq2_dp_beta(int cur, int beta)
 
 	double upwind = upwindIsCur(cur, beta);
 	Var2phase& upwd = cells[ getUpwindIdx(cur, beta) ].u_next;
-	double Boil_upwd = getB_oil(upwd.p, upwd.p_bub, upwd.SATUR);
-	double Bgas_upwd = getB_gas(upwd.p);
-	double rs_upwd = getRs(upwd.p, upwd.p_bub, upwd.SATUR);
+	double Boil_upwd, Boil_upwd_dp;
+	getB_oil(upwd.p, upwd.p_bub, upwd.SATUR, Boil_upwd, Boil_upwd_dp);
+	double Bgas_upwd, Bgas_upwd_dp;
+	getB_gas(upwd.p, Bgas_upwd, Bgas_upwd_dp);
+	double rs_upwd, rs_upwd_dp;
+	getRs(upwd.p, upwd.p_bub, upwd.SATUR, rs_upwd, rs_upwd_dp);
 
 	return -ht / cell.V * getTrans(cell, cells[beta]) * 
 			( getKr_oil(upwd.s) * rs_upwd / props_oil.visc / Boil_upwd + getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd - 
 			(1.0 - upwind) * (cells[cur].u_next.p - cells[beta].u_next.p) * 
-			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (getRs_dp(upwd.p, upwd.p_bub, upwd.SATUR) - rs_upwd * getB_oil_dp(upwd.p, upwd.p_bub, upwd.SATUR) / Boil_upwd) - 
-			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * getB_gas_dp(upwd.p) ));
+			( getKr_oil(upwd.s) / props_oil.visc / Boil_upwd * (rs_upwd_dp - rs_upwd * Boil_upwd_dp / Boil_upwd) - 
+			getKr_gas(upwd.s) / props_gas.visc / Bgas_upwd / Bgas_upwd * Bgas_upwd_dp ));
 }
 
 double GasOil_RZ::solve_eq2_ds_beta(int cur, int beta)
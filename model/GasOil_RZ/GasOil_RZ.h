@@ -109,18 +109,18 @@ namespace gasOil_rz
 
 		double depth_point;
 
-		// Data set (saturation, relative oil permeability)
-		std::vector< std::pair<double,double> > kr_oil;
-		// Data set (saturation, relative gas permeability)
-		std::vector< std::pair<double,double> > kr_gas;
-
-		// Data set (pressure, oil volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > B_oil;
-		// Data set (pressure, gas volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > B_gas;
-
-		// Data set (pressure, gas content in oil) ([Pa], [m3/m3])
-		std::vector< std::pair<double,double> > Rs;
+		// Data set file (saturation, relative oil permeability)
+		std::string kr_oil;
+		// Data set file (saturation, relative gas permeability)
+		std::string kr_gas;
+
+		// Data set file (pressure, oil volume factor) ([Pa], [m3/m3])
+		std::string B_oil;
+		// Data set file (pressure, gas volume factor) ([Pa], [m3/m3])
+		std::string B_gas;
+
+		// Data set file (pressure, gas content in oil) ([Pa], [m3/m3])
+		std::string Rs;
 	};
 
 	class GasOil_RZ : public AbstractModel<Var2phase, Properties, CylCell2D, GasOil_RZ>
@@ -211,7 +211,24 @@ namespace gasOil_rz
 			const int idx = getSkeletonIdx(cell);
 			return props_sk[idx].m * props_sk[idx].beta;
 		};
-		inline double getTrans(Cell& cell, Cell& beta)
+		// trans[4 * i + j] - transmissibility of i-th cell face towards its j-th neighbour (r-, r+, z-, z+).
+		// Valid only after setPeriod(), which sets perm_eff and then rebuilds the array
+		std::vector<double> trans;
+		void buildTrans();
+		inline int getFaceIdx(const int cur, const int beta) const
+		{
+			const int diff = beta - cur;
+
+			if (diff == -cellsNum_z - 2)
+				return 0;
+			else if (diff == cellsNum_z + 2)
+				return 1;
+			else if (diff == -1)
+				return 2;
+			else
+				return 3;
+		};
+		inline double calcTrans(Cell& cell, Cell& beta)
 		{
 			double k1, k2, S;
 			const int idx1 = getSkeletonIdx(cell);
@@ -233,6 +250,10 @@ namespace gasOil_rz
 				return 2.0 * k1 * k2 * S / (k1 * beta.hr + k2 * cell.hr);
 			}
 		};
+		inline double getTrans(Cell& cell, Cell& beta)
+		{
+			return trans[4 * cell.num + getFaceIdx(cell.num, beta.num)];
+		};
 		inline double getPerm_r(const Cell& cell) const
 		{
 			const int idx = getSkeletonIdx(cell);
@@ -307,6 +328,50 @@ namespace gasOil_rz
 			else
 				return 0.0;
 		};
+		// Fused value & derivative getters, one table search per call
+		inline void getKr_oil(double sat_oil, double& kr, double& kr_ds) const
+		{
+			if(sat_oil > 1.0)
+			{
+				kr = 1.0;
+				kr_ds = props_oil.kr->DSolve(1.0);
+			} else
+				props_oil.kr->Solve(sat_oil, kr, kr_ds);
+		};
+		inline void getKr_gas(double sat_oil, double& kr, double& kr_ds) const
+		{
+			if(sat_oil > 1.0)
+			{
+				kr = 0.0;
+				kr_ds = props_gas.kr->DSolve(1.0);
+			} else
+				props_gas.kr->Solve(sat_oil, kr, kr_ds);
+		};
+		inline void getB_oil(double p, double p_bub, bool SATUR, double& b, double& b_dp) const
+		{
+			if(SATUR)
+				props_oil.b->Solve(p, b, b_dp);
+			else
+			{
+				const double b_bub = props_oil.b->Solve(p_bub);
+				b = b_bub * (1.0 + props_oil.beta * (p_bub - p));
+				b_dp = -b_bub * props_oil.beta;
+			}
+		};
+		inline void getB_gas(double p, double& b, double& b_dp) const
+		{
+			props_gas.b->Solve(p, b, b_dp);
+		};
+		inline void getRs(double p, double p_bub, bool SATUR, double& rs, double& rs_dp) const
+		{
+			if(SATUR)
+				Rs->Solve(p, rs, rs_dp);
+			else
+			{
+				rs = Rs->Solve(p_bub);
+				rs_dp = 0.0;
+			}
+		};
 		inline double getPresFromRs(double rs) const
 		{
 			return Prs->Solve(rs);
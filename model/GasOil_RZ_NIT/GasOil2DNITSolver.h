@@ -4,12 +4,12 @@
 #include <iostream>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/BandSweep.h"
 #include "model/GasOil_RZ_NIT/GasOil_RZ_NIT.h"
 
 namespace gasOil_rz_NIT
 {
-	class GasOil2DNITSolver : public AbstractSolver<GasOil_RZ_NIT>, public Sweep
+	class GasOil2DNITSolver : public AbstractSolver<GasOil_RZ_NIT>, public BandSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
@@ -2,12 +2,12 @@
 #define OIL1DSOLVER_H_
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/CyclicSweep.h"
 #include "model/Oil1D/Oil1D.h"
 
 namespace oil1D
 {
-	class Oil1DSolver : public AbstractSolver<Oil1D>, public Sweep
+	class Oil1DSolver : public AbstractSolver<Oil1D>, public CyclicSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
@@ -2,12 +2,12 @@
 #define OIL1DNITSOLVER_H_
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/CyclicSweep.h"
 #include "model/Oil1D_NIT/Oil1D_NIT.h"
 
 namespace oil1D_NIT
 {
-	class Oil1DNITSolver : public AbstractSolver<Oil1D_NIT>, public Sweep
+	class Oil1DNITSolver : public AbstractSolver<Oil1D_NIT>, public CyclicSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
@@ -6,12 +6,12 @@
 #include <map>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/CyclicSweep.h"
 #include "model/Oil_RZ/Oil_RZ.h"
 
 namespace oil_rz
 {
-	class OilRZSolver : public AbstractSolver<Oil_RZ>, public Sweep
+	class OilRZSolver : public AbstractSolver<Oil_RZ>, public CyclicSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
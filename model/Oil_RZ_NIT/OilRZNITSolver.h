@@ -6,12 +6,12 @@
 #include <map>
 
 #include "model/AbstractSolver.hpp"
-#include "method/sweep.h"
+#include "method/CyclicSweep.h"
 #include "model/Oil_RZ_NIT/Oil_RZ_NIT.h"
 
 namespace oil_rz_nit
 {
-	class OilRZNITSolver : public AbstractSolver<Oil_RZ_NIT>, public Sweep
+	class OilRZNITSolver : public AbstractSolver<Oil_RZ_NIT>, public CyclicSweep
 	{
 	private:
 		void MiddleAppr(int current, int MZ, int key);
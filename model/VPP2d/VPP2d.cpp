@@ -11,7 +11,13 @@ VPP2d::VPP2d()
 {}
 
 VPP2d::~VPP2d()
-{}
+{
+	releaseDataset(props_o.kr);
+	releaseDataset(props_w.kr);
+	releaseDataset(props_o.b);
+	releaseDataset(props_w.b);
+	releaseDataset(a);
+}
 
 void VPP2d::setProps(Properties& props)
 {
@@ -304,6 +310,33 @@ void VPP2d::setPeriod(int period)
 		props_sk[i].perm_eff = props_sk[i].perms_eff[period];
 		props_sk[i].skin = props_sk[i].skins[period];
 	}
+
+	buildTrans();
+}
+
+void VPP2d::buildTrans()
+{
+	int neighbor[4];
+	int r_idx, z_idx;
+
+	trans.resize(4 * cellsNum);
+	for (int i = 0; i < cellsNum; i++)
+	{
+		r_idx = i / (cellsNum_z + 2);
+		z_idx = i % (cellsNum_z + 2);
+		neighbor[0] = (r_idx > 0 ? i - cellsNum_z - 2 : -1);
+		neighbor[1] = (r_idx < cellsNum_r + 1 ? i + cellsNum_z + 2 : -1);
+		neighbor[2] = (z_idx > 0 ? i - 1 : -1);
+		neighbor[3] = (z_idx < cellsNum_z + 1 ? i + 1 : -1);
+
+		for (int j = 0; j < 4; j++)
+		{
+			if (neighbor[j] < 0)
+				trans[4 * i + j] = 0.0;
+			else
+				trans[4 * i + j] = calcTrans(cells[i], cells[neighbor[j]]);
+		}
+	}
 }
 
 void VPP2d::setRateDeviation(int num, double ratio)
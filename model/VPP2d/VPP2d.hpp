@@ -2,6 +2,7 @@
 #define VPP2D_HPP_
 
 #include <vector>
+#include <string>
 
 #include "model/cells/Variables.hpp"
 #include "model/cells/CylCell2D.h"
@@ -217,23 +218,23 @@ namespace vpp2d
 
 		double depth_point;
 
-		// Data set (saturation, relative oil permeability)
-		std::vector< std::pair<double, double> > kr_o;
-		// Data set (saturation, relative gas permeability)
-		std::vector< std::pair<double, double> > kr_w;
+		// Data set file (saturation, relative oil permeability)
+		std::string kr_o;
+		// Data set file (saturation, relative gas permeability)
+		std::string kr_w;
 
-		// Data set (pressure, oil volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double, double> > B_o;
-		// Data set (pressure, gas volume factor) ([Pa], [m3/m3])
-		std::vector< std::pair<double, double> > B_w;
+		// Data set file (pressure, oil volume factor) ([Pa], [m3/m3])
+		std::string B_o;
+		// Data set file (pressure, gas volume factor) ([Pa], [m3/m3])
+		std::string B_w;
 
 		// Data set (pressure, oil volume factor) ([Pa], [cP])
 		std::vector< std::pair<double, double> > visc_o;
 		// Data set (pressure, gas volume factor) ([Pa], [cP])
 		std::vector< std::pair<double, double> > visc_w;
 
-		// Data set (pressure, gas volume factor) ([Pa], [1])
-		std::vector< std::pair<double, double> > a;
+		// Data set file (pressure, gas volume factor) ([Pa], [1])
+		std::string a;
 	};
 
 	typedef VarSimpleVPP Variable;
@@ -312,7 +313,24 @@ namespace vpp2d
 			neighbor[3] = cur + 1;
 		};
 
-		inline double getTrans(Cell& cell, Cell& beta)
+		// trans[4 * i + j] - transmissibility of i-th cell face towards its j-th neighbour (r-, r+, z-, z+).
+		// Reads perm_eff through cell.props, hence rebuilt by setPeriod() only
+		std::vector<double> trans;
+		void buildTrans();
+		inline int getFaceIdx(const int cur, const int beta) const
+		{
+			const int diff = beta - cur;
+
+			if (diff == -cellsNum_z - 2)
+				return 0;
+			else if (diff == cellsNum_z + 2)
+				return 1;
+			else if (diff == -1)
+				return 2;
+			else
+				return 3;
+		};
+		inline double calcTrans(Cell& cell, Cell& beta)
 		{
 			double k1, k2, S;
 
@@ -331,6 +349,10 @@ namespace vpp2d
 				return 2.0 * k1 * k2 * S / (k1 * beta.hr + k2 * cell.hr);
 			}
 		};
+		inline double getTrans(Cell& cell, Cell& beta)
+		{
+			return trans[4 * cell.num + getFaceIdx(cell.num, beta.num)];
+		};
 		inline double getPerm_r(const Cell& cell) const
 		{
 			return (cell.r > cell.props->radius_eff ? cell.props->perm_r : cell.props->perm_eff);
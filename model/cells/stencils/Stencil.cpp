@@ -10,7 +10,7 @@ using namespace std;
 /*--------------------MidStencil--------------------*/
 
 template <class modelType>
-MidStencil<modelType>::MidStencil(modelType* _model, FillFoo _foo) : model(_model), foo(_foo)
+MidStencil<modelType>::MidStencil(modelType* _model) : model(_model)
 {
 }
 
@@ -20,11 +20,17 @@ MidStencil<modelType>::~MidStencil()
 }
 
 template <class modelType>
-void MidStencil<modelType>::setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs)
+void MidStencil<modelType>::setIndexStorage(int* _ind_i, int* _ind_j)
 {
-	matrix = _matrix;
 	ind_i = _ind_i;
 	ind_j = _ind_j;
+}
+
+template <class modelType>
+void MidStencil<modelType>::setValueStorage(double* _matrix, const int* _slots, double* _rhs)
+{
+	matrix = _matrix;
+	slots = _slots;
 	rhs = _rhs;
 }
 
@@ -38,25 +44,26 @@ void MidStencil<modelType>::fillIndex(int cellIdx, int *counter)
 {
 }
 
+template <class modelType>
+void MidStencil<modelType>::fillRhs(int cellIdx)
+{
+}
+
 template <>
 void MidStencil<gasOil_3d::GasOil_3D>::fill(int cellIdx, int *counter)
 {
-	int nebr [7];
-	model->getStencilIdx(cellIdx, nebr);
+	double res[2];
+	double jac[28];
+	model->solve_eqMiddle(cellIdx, res, jac);
 
 	for (int i = 0; i < 2; i++)
 	{
-		for (int j = 0; j < 7; j++)
-		{
-			// dP
-			matrix[(*counter)++] = foo.mat[i][2 * j](cellIdx, nebr[j]);
+		// dP, dS over the cell and its neighbours
+		for (int j = 0; j < 14; j++)
+			matrix[slots[(*counter)++]] += jac[14 * i + j];
 
-			// dS
-			matrix[(*counter)++] = foo.mat[i][2 * j + 1](cellIdx, nebr[j]);
-		}
-
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}		
+		rhs[2 * cellIdx + i] = -res[i];
+	}
 }
 
 template <>
@@ -86,21 +93,32 @@ void MidStencil<gasOil_perf::GasOil_Perf>::fill(int cellIdx, int *counter)
 
 	if (nebr[0]->isUsed)
 	{
-		for (int i = 0; i < 2; i++)
+		// First equation
+		matrix[slots[(*counter)++]] += model->solve_eq1_dp(cellIdx, nebr[0]->num);
+		matrix[slots[(*counter)++]] += model->solve_eq1_ds(cellIdx, nebr[0]->num);
+		for (int j = 1; j < 7; j++)
 		{
-			for (int j = 0; j < 7; j++)
-			{
-				matrix[(*counter)++] = foo.mat[i][2 * j](cellIdx, nebr[j]->num);
-				matrix[(*counter)++] = foo.mat[i][2 * j + 1](cellIdx, nebr[j]->num);
-			}
+			matrix[slots[(*counter)++]] += model->solve_eq1_dp_beta(cellIdx, nebr[j]->num);
+			matrix[slots[(*counter)++]] += model->solve_eq1_ds_beta(cellIdx, nebr[j]->num);
+		}
+
+		rhs[2 * cellIdx] = -model->solve_eq1(cellIdx);
 
-			rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
+		// Second equation
+		matrix[slots[(*counter)++]] += model->solve_eq2_dp(cellIdx, nebr[0]->num);
+		matrix[slots[(*counter)++]] += model->solve_eq2_ds(cellIdx, nebr[0]->num);
+		for (int j = 1; j < 7; j++)
+		{
+			matrix[slots[(*counter)++]] += model->solve_eq2_dp_beta(cellIdx, nebr[j]->num);
+			matrix[slots[(*counter)++]] += model->solve_eq2_ds_beta(cellIdx, nebr[j]->num);
 		}
+
+		rhs[2 * cellIdx + 1] = -model->solve_eq2(cellIdx);
 	}
 	else
 	{
-		matrix[(*counter)++] = 1.0;
-		matrix[(*counter)++] = 1.0;
+		matrix[slots[(*counter)++]] += 1.0;
+		matrix[slots[(*counter)++]] += 1.0;
 
 		rhs[2 * cellIdx] = 0.0;
 		rhs[2 * cellIdx + 1] = 0.0;
@@ -149,27 +167,57 @@ void MidStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fill(int cellIdx, int *counte
 
 	if (nebr[0]->isUsed)
 	{
-		for (int i = 0; i < 2; i++)
+		// First equation
+		matrix[slots[(*counter)++]] += model->solve_eq1_dp(cellIdx, nebr[0]->num);
+		matrix[slots[(*counter)++]] += model->solve_eq1_ds(cellIdx, nebr[0]->num);
+		for (int j = 1; j < 7; j++)
 		{
-			for (int j = 0; j < 7; j++)
-			{
-				matrix[(*counter)++] = foo.mat[i][2 * j](cellIdx, nebr[j]->num);
-				matrix[(*counter)++] = foo.mat[i][2 * j + 1](cellIdx, nebr[j]->num);
-			}
+			matrix[slots[(*counter)++]] += model->solve_eq1_dp_beta(cellIdx, nebr[j]->num);
+			matrix[slots[(*counter)++]] += model->solve_eq1_ds_beta(cellIdx, nebr[j]->num);
+		}
+
+		rhs[2 * cellIdx] = -model->solve_eq1(cellIdx);
 
-			rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
+		// Second equation
+		matrix[slots[(*counter)++]] += model->solve_eq2_dp(cellIdx, nebr[0]->num);
+		matrix[slots[(*counter)++]] += model->solve_eq2_ds(cellIdx, nebr[0]->num);
+		for (int j = 1; j < 7; j++)
+		{
+			matrix[slots[(*counter)++]] += model->solve_eq2_dp_beta(cellIdx, nebr[j]->num);
+			matrix[slots[(*counter)++]] += model->solve_eq2_ds_beta(cellIdx, nebr[j]->num);
 		}
+
+		rhs[2 * cellIdx + 1] = -model->solve_eq2(cellIdx);
 	}
 	else
 	{
-		matrix[(*counter)++] = 1.0;
-		matrix[(*counter)++] = 1.0;
+		matrix[slots[(*counter)++]] += 1.0;
+		matrix[slots[(*counter)++]] += 1.0;
 
 		rhs[2 * cellIdx] = 0.0;
 		rhs[2 * cellIdx + 1] = 0.0;
 	}
 }
 
+template <>
+void MidStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fillRhs(int cellIdx)
+{
+	gasOil_perf_nit::Cell* nebr[7];
+	model->getStencilIdx(cellIdx, nebr);
+
+	if (nebr[0]->isUsed)
+	{
+		rhs[2 * cellIdx] = -model->solve_eq1(cellIdx);
+		rhs[2 * cellIdx + 1] = -model->solve_eq2(cellIdx);
+	}
+	else
+	{
+		// Identity rows are relative to the iteration layer, so residual is zero as in fill()
+		rhs[2 * cellIdx] = -(nebr[0]->u_next.p - nebr[0]->u_iter.p);
+		rhs[2 * cellIdx + 1] = -(nebr[0]->u_next.s - nebr[0]->u_iter.s);
+	}
+}
+
 template <>
 void MidStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fillIndex(int cellIdx, int *counter)
 {
@@ -212,14 +260,15 @@ void MidStencil<oil_perf_nit::Oil_Perf_NIT>::fill(int cellIdx, int *counter)
 
 	if (nebr[0]->isUsed)
 	{
-		for (int j = 0; j < 7; j++)
-			matrix[(*counter)++] = foo.mat[0][j](cellIdx, nebr[j]->num);
+		matrix[slots[(*counter)++]] += model->solve_eq_dp(cellIdx, nebr[0]->num);
+		for (int j = 1; j < 7; j++)
+			matrix[slots[(*counter)++]] += model->solve_eq_dp_beta(cellIdx, nebr[j]->num);
 
-		rhs[cellIdx] = -foo.rhs[0](cellIdx);
+		rhs[cellIdx] = -model->solve_eq(cellIdx);
 	}
 	else
 	{
-		matrix[(*counter)++] = 1.0;
+		matrix[slots[(*counter)++]] += 1.0;
 		rhs[cellIdx] = 0.0;
 	}
 }
@@ -251,7 +300,7 @@ void MidStencil<oil_perf_nit::Oil_Perf_NIT>::fillIndex(int cellIdx, int *counter
 /*--------------------LeftStencil--------------------*/
 
 template <class modelType>
-LeftStencil<modelType>::LeftStencil(modelType* _model, FillFoo _foo) : model(_model), foo(_foo)
+LeftStencil<modelType>::LeftStencil(modelType* _model) : model(_model)
 {
 }
 
@@ -261,11 +310,17 @@ LeftStencil<modelType>::~LeftStencil()
 }
 
 template <class modelType>
-void LeftStencil<modelType>::setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs)
+void LeftStencil<modelType>::setIndexStorage(int* _ind_i, int* _ind_j)
 {
-	matrix = _matrix;
 	ind_i = _ind_i;
 	ind_j = _ind_j;
+}
+
+template <class modelType>
+void LeftStencil<modelType>::setValueStorage(double* _matrix, const int* _slots, double* _rhs)
+{
+	matrix = _matrix;
+	slots = _slots;
 	rhs = _rhs;
 }
 
@@ -279,29 +334,37 @@ void LeftStencil<modelType>::fillIndex(int cellIdx, int *counter)
 {
 }
 
+template <class modelType>
+void LeftStencil<modelType>::fillRhs(int cellIdx)
+{
+}
+
 template <>
 void LeftStencil<gasOil_3d::GasOil_3D>::fill(int cellIdx, int *counter)
 {
 	int nebr1Idx = cellIdx + model->cellsNum_z + 2;
 	int nebr2Idx = cellIdx + 2 * model->cellsNum_z + 4;
 
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_ds(cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebr1Idx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_dp_beta(cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_ds_beta(cellIdx, nebr1Idx);
 
-		if (i == 1)
-		{
-			matrix[(*counter)++] = foo.mat[i][4](cellIdx, nebr2Idx);
-			matrix[(*counter)++] = foo.mat[i][5](cellIdx, nebr2Idx);
-		}
+	rhs[2 * cellIdx] = -model->solve_eq1Left(cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp_beta(cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds_beta(cellIdx, nebr1Idx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp_beta(cellIdx, nebr2Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds_beta(cellIdx, nebr2Idx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Left(cellIdx);
 }
 
 template <>
@@ -341,23 +404,26 @@ void LeftStencil<gasOil_perf::GasOil_Perf>::fill(int cellIdx, int *counter)
 	int nebr1Idx = model->nebrMap[cellIdx].first;
 	int nebr2Idx = model->nebrMap[cellIdx].second;
 
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_ds(cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebr1Idx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_dp_beta(cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_ds_beta(cellIdx, nebr1Idx);
 
-		if (i == 1)
-		{
-			matrix[(*counter)++] = foo.mat[i][4](cellIdx, nebr2Idx);
-			matrix[(*counter)++] = foo.mat[i][5](cellIdx, nebr2Idx);
-		}
+	rhs[2 * (cellIdx + model->cellsNum)] = -model->solve_eq1Left(cellIdx);
 
-		// Right side
-		rhs[2 * (cellIdx + model->cellsNum) + i] = -foo.rhs[i](cellIdx);
-	}
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp_beta(cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds_beta(cellIdx, nebr1Idx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp_beta(cellIdx, nebr2Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds_beta(cellIdx, nebr2Idx);
+
+	rhs[2 * (cellIdx + model->cellsNum) + 1] = -model->solve_eq2Left(cellIdx);
 }
 
 template <>
@@ -398,23 +464,33 @@ void LeftStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fill(int cellIdx, int *count
 	int nebr1Idx = model->nebrMap[cellIdx].first;
 	int nebr2Idx = model->nebrMap[cellIdx].second;
 
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_ds(cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebr1Idx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_dp_beta(cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Left_ds_beta(cellIdx, nebr1Idx);
 
-		if (i == 1)
-		{
-			matrix[(*counter)++] = foo.mat[i][4](cellIdx, nebr2Idx);
-			matrix[(*counter)++] = foo.mat[i][5](cellIdx, nebr2Idx);
-		}
+	rhs[2 * (cellIdx + model->cellsNum)] = -model->solve_eq1Left(cellIdx);
 
-		// Right side
-		rhs[2 * (cellIdx + model->cellsNum) + i] = -foo.rhs[i](cellIdx);
-	}
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp_beta(cellIdx, nebr1Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds_beta(cellIdx, nebr1Idx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_dp_beta(cellIdx, nebr2Idx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Left_ds_beta(cellIdx, nebr2Idx);
+
+	rhs[2 * (cellIdx + model->cellsNum) + 1] = -model->solve_eq2Left(cellIdx);
+}
+
+template <>
+void LeftStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fillRhs(int cellIdx)
+{
+	rhs[2 * (cellIdx + model->cellsNum)] = -model->solve_eq1Left(cellIdx);
+	rhs[2 * (cellIdx + model->cellsNum) + 1] = -model->solve_eq2Left(cellIdx);
 }
 
 template <>
@@ -454,10 +530,10 @@ void LeftStencil<oil_perf_nit::Oil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = model->nebrMap[cellIdx].first;
 
-	matrix[(*counter)++] = foo.mat[0][0](cellIdx, cellIdx);
-	matrix[(*counter)++] = foo.mat[0][1](cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqLeft_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqLeft_dp_beta(cellIdx, nebrIdx);
 
-	rhs[cellIdx + model->cellsNum] = -foo.rhs[0](cellIdx);
+	rhs[cellIdx + model->cellsNum] = -model->solve_eqLeft(cellIdx);
 }
 
 template <>
@@ -477,7 +553,7 @@ void LeftStencil<oil_perf_nit::Oil_Perf_NIT>::fillIndex(int cellIdx, int *counte
 /*--------------------RightStencil--------------------*/
 
 template <class modelType>
-RightStencil<modelType>::RightStencil(modelType* _model, FillFoo _foo) : model(_model), foo(_foo)
+RightStencil<modelType>::RightStencil(modelType* _model) : model(_model)
 {
 }
 
@@ -487,11 +563,17 @@ RightStencil<modelType>::~RightStencil()
 }
 
 template <class modelType>
-void RightStencil<modelType>::setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs)
+void RightStencil<modelType>::setIndexStorage(int* _ind_i, int* _ind_j)
 {
-	matrix = _matrix;
 	ind_i = _ind_i;
 	ind_j = _ind_j;
+}
+
+template <class modelType>
+void RightStencil<modelType>::setValueStorage(double* _matrix, const int* _slots, double* _rhs)
+{
+	matrix = _matrix;
+	slots = _slots;
 	rhs = _rhs;
 }
 
@@ -505,21 +587,33 @@ void RightStencil<modelType>::fillIndex(int cellIdx, int *counter)
 {
 }
 
+template <class modelType>
+void RightStencil<modelType>::fillRhs(int cellIdx)
+{
+}
+
 template <>
 void RightStencil<gasOil_3d::GasOil_3D>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - model->cellsNum_z - 2;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Right(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Right(cellIdx);
 }
 
 template <>
@@ -546,17 +640,24 @@ void RightStencil<gasOil_3d::GasOil_3D>::fillIndex(int cellIdx, int *counter)
 void RightStencil<gasOil_perf::GasOil_Perf>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - model->cellsNum_z - 2;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Right(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Right(cellIdx);
 }
 
 template <>
@@ -583,17 +684,31 @@ void RightStencil<gasOil_perf::GasOil_Perf>::fillIndex(int cellIdx, int *counter
 void RightStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - model->cellsNum_z - 2;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Right_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Right(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Right_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Right(cellIdx);
+}
+
+template <>
+void RightStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fillRhs(int cellIdx)
+{
+	rhs[2 * cellIdx] = -model->solve_eq1Right(cellIdx);
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Right(cellIdx);
 }
 
 template <>
@@ -621,10 +736,10 @@ void RightStencil<oil_perf_nit::Oil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - model->cellsNum_z - 2;
 
-	matrix[(*counter)++] = foo.mat[0][0](cellIdx, cellIdx);
-	matrix[(*counter)++] = foo.mat[0][1](cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqRight_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqRight_dp_beta(cellIdx, nebrIdx);
 
-	rhs[cellIdx] = -foo.rhs[0](cellIdx);
+	rhs[cellIdx] = -model->solve_eqRight(cellIdx);
 }
 
 template <>
@@ -642,7 +757,7 @@ void RightStencil<oil_perf_nit::Oil_Perf_NIT>::fillIndex(int cellIdx, int *count
 /*--------------------TopStencil--------------------*/
 
 template <class modelType>
-TopStencil<modelType>::TopStencil(modelType* _model, FillFoo _foo) : model(_model), foo(_foo)
+TopStencil<modelType>::TopStencil(modelType* _model) : model(_model)
 {
 }
 
@@ -652,11 +767,17 @@ TopStencil<modelType>::~TopStencil()
 }
 
 template <class modelType>
-void TopStencil<modelType>::setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs)
+void TopStencil<modelType>::setIndexStorage(int* _ind_i, int* _ind_j)
 {
-	matrix = _matrix;
 	ind_i = _ind_i;
 	ind_j = _ind_j;
+}
+
+template <class modelType>
+void TopStencil<modelType>::setValueStorage(double* _matrix, const int* _slots, double* _rhs)
+{
+	matrix = _matrix;
+	slots = _slots;
 	rhs = _rhs;
 }
 
@@ -670,21 +791,33 @@ void TopStencil<modelType>::fillIndex(int cellIdx, int *counter)
 {
 }
 
+template <class modelType>
+void TopStencil<modelType>::fillRhs(int cellIdx)
+{
+}
+
 template <>
 void TopStencil<gasOil_3d::GasOil_3D>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx + 1;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Top(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Top(cellIdx);
 }
 
 template <>
@@ -711,17 +844,24 @@ template <>
 void TopStencil<gasOil_perf::GasOil_Perf>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx + 1;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Top(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Top(cellIdx);
 }
 
 template <>
@@ -748,17 +888,31 @@ template <>
 void TopStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx + 1;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Top_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Top(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Top_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Top(cellIdx);
+}
+
+template <>
+void TopStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fillRhs(int cellIdx)
+{
+	rhs[2 * cellIdx] = -model->solve_eq1Top(cellIdx);
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Top(cellIdx);
 }
 
 template <>
@@ -786,11 +940,10 @@ void TopStencil<oil_perf_nit::Oil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx + 1;
 
-	matrix[(*counter)++] = foo.mat[0][0](cellIdx, cellIdx);
-	matrix[(*counter)++] = foo.mat[0][1](cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqTop_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqTop_dp_beta(cellIdx, nebrIdx);
 
-	// Right side
-	rhs[cellIdx] = -foo.rhs[0](cellIdx);
+	rhs[cellIdx] = -model->solve_eqTop(cellIdx);
 }
 
 template <>
@@ -808,7 +961,7 @@ void TopStencil<oil_perf_nit::Oil_Perf_NIT>::fillIndex(int cellIdx, int *counter
 /*--------------------BotStencil--------------------*/
 
 template <class modelType>
-BotStencil<modelType>::BotStencil(modelType* _model, FillFoo _foo) : model(_model), foo(_foo)
+BotStencil<modelType>::BotStencil(modelType* _model) : model(_model)
 {
 }
 
@@ -818,11 +971,17 @@ BotStencil<modelType>::~BotStencil()
 }
 
 template <class modelType>
-void BotStencil<modelType>::setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs)
+void BotStencil<modelType>::setIndexStorage(int* _ind_i, int* _ind_j)
 {
-	matrix = _matrix;
 	ind_i = _ind_i;
 	ind_j = _ind_j;
+}
+
+template <class modelType>
+void BotStencil<modelType>::setValueStorage(double* _matrix, const int* _slots, double* _rhs)
+{
+	matrix = _matrix;
+	slots = _slots;
 	rhs = _rhs;
 }
 
@@ -836,21 +995,33 @@ void BotStencil<modelType>::fillIndex(int cellIdx, int *counter)
 {
 }
 
+template <class modelType>
+void BotStencil<modelType>::fillRhs(int cellIdx)
+{
+}
+
 template <>
 void BotStencil<gasOil_3d::GasOil_3D>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - 1;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Bot(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Bot(cellIdx);
 }
 
 template <>
@@ -877,17 +1048,24 @@ template <>
 void BotStencil<gasOil_perf::GasOil_Perf>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - 1;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Bot(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Bot(cellIdx);
 }
 
 template <>
@@ -914,17 +1092,31 @@ template <>
 void BotStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - 1;
-	for (int i = 0; i < 2; i++)
-	{
-		matrix[(*counter)++] = foo.mat[i][0](cellIdx, cellIdx);
-		matrix[(*counter)++] = foo.mat[i][1](cellIdx, cellIdx);
 
-		matrix[(*counter)++] = foo.mat[i][2](cellIdx, nebrIdx);
-		matrix[(*counter)++] = foo.mat[i][3](cellIdx, nebrIdx);
+	// First equation
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_ds(cellIdx, cellIdx);
 
-		// Right side
-		rhs[2 * cellIdx + i] = -foo.rhs[i](cellIdx);
-	}
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq1Bot_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx] = -model->solve_eq1Bot(cellIdx);
+
+	// Second equation
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_ds(cellIdx, cellIdx);
+
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_dp_beta(cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eq2Bot_ds_beta(cellIdx, nebrIdx);
+
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Bot(cellIdx);
+}
+
+template <>
+void BotStencil<gasOil_perf_nit::GasOil_Perf_NIT>::fillRhs(int cellIdx)
+{
+	rhs[2 * cellIdx] = -model->solve_eq1Bot(cellIdx);
+	rhs[2 * cellIdx + 1] = -model->solve_eq2Bot(cellIdx);
 }
 
 template <>
@@ -952,11 +1144,10 @@ void BotStencil<oil_perf_nit::Oil_Perf_NIT>::fill(int cellIdx, int *counter)
 {
 	int nebrIdx = cellIdx - 1;
 
-	matrix[(*counter)++] = foo.mat[0][0](cellIdx, cellIdx);
-	matrix[(*counter)++] = foo.mat[0][1](cellIdx, nebrIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqBot_dp(cellIdx, cellIdx);
+	matrix[slots[(*counter)++]] += model->solve_eqBot_dp_beta(cellIdx, nebrIdx);
 
-	// Right side
-	rhs[cellIdx] = -foo.rhs[0](cellIdx);
+	rhs[cellIdx] = -model->solve_eqBot(cellIdx);
 }
 
 template <>
@@ -976,11 +1167,11 @@ void BotStencil<oil_perf_nit::Oil_Perf_NIT>::fillIndex(int cellIdx, int *counter
 template <class modelType>
 UsedStencils<modelType>::UsedStencils(modelType* _model)
 {
-	middle = new MidStencil<modelType>(_model, _model->middleFoo);
-	left = new LeftStencil<modelType>(_model, _model->leftFoo);
-	right = new RightStencil<modelType>(_model, _model->rightFoo);
-	top = new TopStencil<modelType>(_model, _model->topFoo);
-	bot = new BotStencil<modelType>(_model, _model->botFoo);
+	middle = new MidStencil<modelType>(_model);
+	left = new LeftStencil<modelType>(_model);
+	right = new RightStencil<modelType>(_model);
+	top = new TopStencil<modelType>(_model);
+	bot = new BotStencil<modelType>(_model);
 }
 
 template <class modelType>
@@ -994,13 +1185,23 @@ UsedStencils<modelType>::~UsedStencils()
 }
 
 template <class modelType>
-void UsedStencils<modelType>::setStorages(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs)
+void UsedStencils<modelType>::setIndexStorages(int* _ind_i, int* _ind_j)
+{
+	middle->setIndexStorage(_ind_i, _ind_j);
+	left->setIndexStorage(_ind_i, _ind_j);
+	right->setIndexStorage(_ind_i, _ind_j);
+	top->setIndexStorage(_ind_i, _ind_j);
+	bot->setIndexStorage(_ind_i, _ind_j);
+}
+
+template <class modelType>
+void UsedStencils<modelType>::setValueStorages(double* _matrix, const int* _slots, double* _rhs)
 {
-	middle->setStorage(_matrix, _ind_i, _ind_j, _rhs);
-	left->setStorage(_matrix, _ind_i, _ind_j, _rhs);
-	right->setStorage(_matrix, _ind_i, _ind_j, _rhs);
-	top->setStorage(_matrix, _ind_i, _ind_j, _rhs);
-	bot->setStorage(_matrix, _ind_i, _ind_j, _rhs);
+	middle->setValueStorage(_matrix, _slots, _rhs);
+	left->setValueStorage(_matrix, _slots, _rhs);
+	right->setValueStorage(_matrix, _slots, _rhs);
+	top->setValueStorage(_matrix, _slots, _rhs);
+	bot->setValueStorage(_matrix, _slots, _rhs);
 }
 
 template class MidStencil<gasOil_3d::GasOil_3D>;
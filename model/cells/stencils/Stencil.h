@@ -5,10 +5,28 @@
 #include "util\utils.h"
 
 #include <vector>
-#include <functional>
 #include <new>
 #include <initializer_list>
 
+/*--------------------FillCell--------------------*/
+
+#define FILL_BOUND 0
+#define FILL_LEFT 1
+#define FILL_MIDDLE 2
+#define FILL_TOP 3
+#define FILL_BOT 4
+#define FILL_RIGHT 5
+#define FILL_TUNNEL 6
+
+// Cell of assembling plan, offset is the filling position of its first element,
+// so cells can be filled independently
+struct FillCell
+{
+	int idx;
+	int type;
+	int offset;
+};
+
 /*--------------------MidStencil--------------------*/
 
 template <class modelType>
@@ -16,21 +34,24 @@ class MidStencil
 {
 protected:
 	modelType* model;
-	FillFoo foo;
 
 	double* matrix;
+	const int* slots;
 	int* ind_i;
 	int* ind_j;
 	double* rhs;
 
 public:
-	MidStencil(modelType* _model, FillFoo _foo);
+	MidStencil(modelType* _model);
 	~MidStencil();
 
-	void setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs);
+	void setIndexStorage(int* _ind_i, int* _ind_j);
+	void setValueStorage(double* _matrix, const int* _slots, double* _rhs);
 
 	void fill(int cellIdx, int* counter);
 	void fillIndex(int cellIdx, int *counter);
+	// Residual only, matrix is not touched
+	void fillRhs(int cellIdx);
 };
 
 /*--------------------LeftStencil--------------------*/
@@ -40,21 +61,24 @@ class LeftStencil
 {
 protected:
 	modelType* model;
-	const FillFoo foo;
 
 	double* matrix;
+	const int* slots;
 	int* ind_i;
 	int* ind_j;
 	double* rhs;
 
 public:
-	LeftStencil(modelType* _model, FillFoo _foo);
+	LeftStencil(modelType* _model);
 	~LeftStencil();
 
-	void setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs);
+	void setIndexStorage(int* _ind_i, int* _ind_j);
+	void setValueStorage(double* _matrix, const int* _slots, double* _rhs);
 
 	void fill(int cellIdx, int *counter);
 	void fillIndex(int cellIdx, int *counter);
+	// Residual only, matrix is not touched
+	void fillRhs(int cellIdx);
 };
 
 /*--------------------RightStencil--------------------*/
@@ -64,21 +88,24 @@ class RightStencil
 {
 protected:
 	modelType* model;
-	FillFoo foo;
 
 	double* matrix;
+	const int* slots;
 	int* ind_i;
 	int* ind_j;
 	double* rhs;
 
 public:
-	RightStencil(modelType* _model, FillFoo _foo);
+	RightStencil(modelType* _model);
 	~RightStencil();
 
-	void setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs);
+	void setIndexStorage(int* _ind_i, int* _ind_j);
+	void setValueStorage(double* _matrix, const int* _slots, double* _rhs);
 
 	void fill(int cellIdx, int *counter);
 	void fillIndex(int cellIdx, int *counter);
+	// Residual only, matrix is not touched
+	void fillRhs(int cellIdx);
 };
 
 /*--------------------TopStencil--------------------*/
@@ -88,21 +115,24 @@ class TopStencil
 {
 protected:
 	modelType* model;
-	FillFoo foo;
 
 	double* matrix;
+	const int* slots;
 	int* ind_i;
 	int* ind_j;
 	double* rhs;
 
 public:
-	TopStencil(modelType* _model, FillFoo _foo);
+	TopStencil(modelType* _model);
 	~TopStencil();
 
-	void setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs);
+	void setIndexStorage(int* _ind_i, int* _ind_j);
+	void setValueStorage(double* _matrix, const int* _slots, double* _rhs);
 
 	void fill(int cellIdx, int *counter);
 	void fillIndex(int cellIdx, int *counter);
+	// Residual only, matrix is not touched
+	void fillRhs(int cellIdx);
 };
 
 /*--------------------BotStencil--------------------*/
@@ -112,21 +142,24 @@ class BotStencil
 {
 protected:
 	modelType* model;
-	FillFoo foo;
 
 	double* matrix;
+	const int* slots;
 	int* ind_i;
 	int* ind_j;
 	double* rhs;
 
 public:
-	BotStencil(modelType* _model, FillFoo _foo);
+	BotStencil(modelType* _model);
 	~BotStencil();
 
-	void setStorage(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs);
+	void setIndexStorage(int* _ind_i, int* _ind_j);
+	void setValueStorage(double* _matrix, const int* _slots, double* _rhs);
 
 	void fill(int cellIdx, int *counter);
 	void fillIndex(int cellIdx, int *counter);
+	// Residual only, matrix is not touched
+	void fillRhs(int cellIdx);
 };
 
 /*--------------------UsedStencils--------------------*/
@@ -138,7 +171,9 @@ public:
 	UsedStencils(modelType* _model);
 	~UsedStencils();
 
-	void setStorages(double* _matrix, int* _ind_i, int* _ind_j, double* _rhs);
+	// COO indices are filled once, values are written into CSR slots then
+	void setIndexStorages(int* _ind_i, int* _ind_j);
+	void setValueStorages(double* _matrix, const int* _slots, double* _rhs);
 
 	MidStencil<modelType>* middle;
 	LeftStencil<modelType>* left;
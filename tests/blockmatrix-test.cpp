@@ -0,0 +1,310 @@
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include "gtest/gtest.h"
+
+#include "tests/blockmatrix-test.h"
+
+using std::vector;
+
+void BlockMatrix_Test::setGrid(const int nx, const int ny, const int bs, const unsigned seed, const double diag)
+{
+	std::mt19937 gen(seed);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	const int blocksNum = nx * ny;
+	size = blocksNum * bs;
+
+	dense.assign(size * size, 0.0);
+	for (int i = 0; i < nx; i++)
+		for (int j = 0; j < ny; j++)
+		{
+			const int ib = i * ny + j;
+			vector<int> nebrs;
+			nebrs.push_back(ib);
+			if (i > 0)		nebrs.push_back(ib - ny);
+			if (i < nx - 1)	nebrs.push_back(ib + ny);
+			if (j > 0)		nebrs.push_back(ib - 1);
+			if (j < ny - 1)	nebrs.push_back(ib + 1);
+
+			for (int k = 0; k < (int)nebrs.size(); k++)
+				for (int p = 0; p < bs; p++)
+					for (int q = 0; q < bs; q++)
+						dense[(ib * bs + p) * size + nebrs[k] * bs + q] = dist(gen);
+			for (int p = 0; p < bs; p++)
+				dense[(ib * bs + p) * size + ib * bs + p] += diag * bs;
+		}
+
+	row.assign(size + 1, 0);
+	col.clear();	val.clear();
+	for (int i = 0; i < size; i++)
+	{
+		for (int j = 0; j < size; j++)
+			if (dense[i * size + j] != 0.0)
+			{
+				col.push_back(j);
+				val.push_back(dense[i * size + j]);
+			}
+		row[i + 1] = (int)col.size();
+	}
+}
+
+void BlockMatrix_Test::referenceSolve(const vector<double>& rhs, vector<double>& x) const
+{
+	vector<double> lu = dense;
+	vector<bool> mask(size * size);
+	for (int i = 0; i < size * size; i++)
+		mask[i] = (dense[i] != 0.0);
+
+	// IKJ variant, updates outside of the pattern are dropped
+	for (int i = 1; i < size; i++)
+		for (int k = 0; k < i; k++)
+		{
+			if (!mask[i * size + k])
+				continue;
+			lu[i * size + k] /= lu[k * size + k];
+			for (int j = k + 1; j < size; j++)
+				if (mask[i * size + j] && mask[k * size + j])
+					lu[i * size + j] -= lu[i * size + k] * lu[k * size + j];
+		}
+
+	x = rhs;
+	for (int i = 0; i < size; i++)
+		for (int j = 0; j < i; j++)
+			x[i] -= lu[i * size + j] * x[j];
+	for (int i = size - 1; i >= 0; i--)
+	{
+		for (int j = i + 1; j < size; j++)
+			x[i] -= lu[i * size + j] * x[j];
+		x[i] /= lu[i * size + i];
+	}
+}
+
+void BlockMatrix_Test::setElements(const unsigned seed)
+{
+	// Every nonzero is split into two elements
+	vector<int> si, sj;
+	vector<double> sa;
+	for (int i = 0; i < size; i++)
+		for (int l = row[i]; l < row[i + 1]; l++)
+		{
+			si.push_back(i);	sj.push_back(col[l]);	sa.push_back(0.25 * val[l]);
+			si.push_back(i);	sj.push_back(col[l]);	sa.push_back(0.75 * val[l]);
+		}
+
+	const int counter = (int)sa.size();
+	vector<int> order(counter);
+	for (int k = 0; k < counter; k++)
+		order[k] = k;
+	std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+	ind_i.resize(counter);	ind_j.resize(counter);	a.resize(counter);
+	for (int k = 0; k < counter; k++)
+	{
+		ind_i[k] = si[order[k]];	ind_j[k] = sj[order[k]];	a[k] = sa[order[k]];
+	}
+}
+
+double BlockMatrix_Test::compare(const int nx, const int ny, const int bs, const unsigned seed)
+{
+	setGrid(nx, ny, bs, seed);
+
+	BaseBlockMatrix* mat = createBlockMatrix(bs);
+	EXPECT_TRUE(mat != NULL);
+	mat->setFromCSR(size, &row[0], &col[0], &val[0]);
+	EXPECT_EQ(mat->getBlocksNum(), nx * ny);
+	mat->factorILU0();
+
+	std::mt19937 gen(seed + 1);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	vector<double> rhs(size), x(size), x_ref;
+	for (int i = 0; i < size; i++)
+		rhs[i] = dist(gen);
+
+	mat->solveILU0(&rhs[0], &x[0]);
+	referenceSolve(rhs, x_ref);
+	delete mat;
+
+	double diff = 0.0, norm = 0.0;
+	for (int i = 0; i < size; i++)
+	{
+		diff = std::max(diff, fabs(x[i] - x_ref[i]));
+		norm = std::max(norm, fabs(x_ref[i]));
+	}
+	return diff / norm;
+}
+
+void BlockMatrix_Test::tridiagonal_test()
+{
+	const int sizes[] = { 1, 2, 7, 50 };
+	const int blocks[] = { 1, 2, 3, 4 };
+
+	for (int b = 0; b < 4; b++)
+		for (int s = 0; s < 4; s++)
+		{
+			// No fill-in, so block ILU(0) is the exact solve
+			const int bs = blocks[b];
+			setGrid(sizes[s], 1, bs, 10 * s + b);
+			BaseBlockMatrix* mat = createBlockMatrix(bs);
+			mat->setFromCSR(size, &row[0], &col[0], &val[0]);
+			mat->factorILU0();
+
+			vector<double> x(size), rhs(size, 0.0), x_exact(size);
+			for (int i = 0; i < size; i++)
+				x_exact[i] = sin((double)i);
+			for (int i = 0; i < size; i++)
+				for (int j = 0; j < size; j++)
+					rhs[i] += dense[i * size + j] * x_exact[j];
+			mat->solveILU0(&rhs[0], &x[0]);
+			delete mat;
+
+			for (int i = 0; i < size; i++)
+				EXPECT_NEAR(x[i], x_exact[i], BLOCKMATRIX_REL_TOL);
+
+			EXPECT_LT(compare(sizes[s], 1, bs, 10 * s + b), BLOCKMATRIX_REL_TOL);
+		}
+}
+
+void BlockMatrix_Test::grid_test()
+{
+	const int blocks[] = { 1, 2, 3, 4 };
+
+	for (int b = 0; b < 4; b++)
+	{
+		EXPECT_LT(compare(3, 3, blocks[b], b), BLOCKMATRIX_REL_TOL);
+		EXPECT_LT(compare(6, 5, blocks[b], b + 4), BLOCKMATRIX_REL_TOL);
+	}
+	EXPECT_TRUE(createBlockMatrix(5) == NULL);
+}
+
+void BlockMatrix_Test::assembly_test()
+{
+	const int blocks[] = { 1, 2, 3, 4 };
+
+	for (int b = 0; b < 4; b++)
+	{
+		const int bs = blocks[b];
+		setGrid(5, 4, bs, 20 + b);
+
+		setElements(b);
+		const int counter = (int)a.size();
+
+		BaseBlockMatrix* mat = createBlockMatrix(bs);
+		vector<int> slots(counter);
+		mat->setPattern(size, &ind_i[0], &ind_j[0], counter, &slots[0]);
+		EXPECT_EQ(mat->getBlocksNum(), 5 * 4);
+		EXPECT_EQ(mat->getValuesNum(), mat->getNonZeroBlocksNum() * bs * bs);
+
+		double* values = mat->getValues();
+		for (int k = 0; k < counter; k++)
+			values[slots[k]] += a[k];
+
+		// Block SpMV against the dense product
+		vector<double> x(size), y(size), y_ref(size, 0.0);
+		for (int i = 0; i < size; i++)
+			x[i] = cos((double)i);
+		for (int i = 0; i < size; i++)
+			for (int j = 0; j < size; j++)
+				y_ref[i] += dense[i * size + j] * x[j];
+		mat->Apply(&x[0], &y[0]);
+		for (int i = 0; i < size; i++)
+			EXPECT_NEAR(y[i], y_ref[i], BLOCKMATRIX_REL_TOL * (1.0 + fabs(y_ref[i])));
+
+		// Block ILU(0) over the assembled values
+		vector<double> sol_ref;
+		mat->factorILU0();
+		mat->solveILU0(&x[0], &y[0]);
+		referenceSolve(x, sol_ref);
+		for (int i = 0; i < size; i++)
+			EXPECT_NEAR(y[i], sol_ref[i], BLOCKMATRIX_REL_TOL * (1.0 + fabs(sol_ref[i])));
+
+		delete mat;
+	}
+}
+
+int BlockMatrix_Test::solveSequence(ParSolver& solver, const int solvesNum, const double step)
+{
+	const int* slots = solver.getSlots();
+	vector<double> rhs(size), x(size);
+	int iterNum = 0;
+
+	// Newton-like sequence of slowly changing systems, the preconditioner is lagged over updated values
+	for (int it = 0; it < solvesNum; it++)
+	{
+		const double scale = 1.0 + step * it;
+		double* values = solver.beginAssemble();
+		for (int k = 0; k < (int)a.size(); k++)
+			values[slots[k]] += scale * a[k];
+		for (int i = 0; i < size; i++)
+			rhs[i] = sin(0.3 * i + it);
+		solver.Assemble(&rhs[0]);
+		solver.Solve();
+		solver.getSolution().CopyToData(&x[0]);
+
+		double res = 0.0, norm = 0.0;
+		for (int i = 0; i < size; i++)
+		{
+			double sum = rhs[i];
+			for (int j = 0; j < size; j++)
+				sum -= scale * dense[i * size + j] * x[j];
+			res += sum * sum;
+			norm += rhs[i] * rhs[i];
+		}
+		EXPECT_LT(sqrt(res / norm), 1.E-9);
+		EXPECT_GT(solver.getIterNum(), 0);
+		iterNum += solver.getIterNum();
+	}
+
+	return iterNum;
+}
+
+void BlockMatrix_Test::solver_test()
+{
+	const int blocks[] = { 1, 2, 3, 4 };
+	paralution::init_paralution();
+
+	for (int b = 0; b < 4; b++)
+	{
+		const int bs = blocks[b];
+		setGrid(8, 6, bs, 30 + b);
+		setElements(b);
+
+		ParSolver solver;
+		ParSolverConfig config(PRECOND_BILU0, bs);
+		config.relTol = 1.E-12;
+		EXPECT_TRUE(solver.setConfig(config));
+		solver.Init(size);
+		solver.setPattern(&ind_i[0], &ind_j[0], (int)a.size());
+		solveSequence(solver, 2, 0.1);
+
+		// Block operator is kept, so switching to scalar CSR is rejected
+		EXPECT_FALSE(solver.setConfig(ParSolverConfig(PRECOND_ILUT)));
+	}
+
+	paralution::stop_paralution();
+}
+
+void BlockMatrix_Test::recycle_test()
+{
+	// Weak diagonal & short restart make block ILU(0) preconditioned FGMRES slow
+	const int bs = 2;
+	setGrid(12, 10, bs, 7, DIAG_WEAK);
+	setElements(1);
+	paralution::init_paralution();
+
+	int iterNum[2];
+	for (int v = 0; v < 2; v++)
+	{
+		ParSolver solver;
+		ParSolverConfig config(PRECOND_BILU0, bs);
+		config.restart = 8;
+		config.relTol = 1.E-11;
+		config.recycleSize = 4 * v;
+		EXPECT_TRUE(solver.setConfig(config));
+		solver.Init(size);
+		solver.setPattern(&ind_i[0], &ind_j[0], (int)a.size());
+		iterNum[v] = solveSequence(solver, 6, 0.01);
+	}
+	EXPECT_LT(iterNum[1], iterNum[0]);
+
+	paralution::stop_paralution();
+}
@@ -0,0 +1,49 @@
+#ifndef BLOCKMATRIX_TEST_H_
+#define BLOCKMATRIX_TEST_H_
+
+#include <vector>
+
+#include "method/BlockMatrix.h"
+#include "method/ParalutionInterface.h"
+
+#define BLOCKMATRIX_REL_TOL 1.E-10
+// Diagonal shift of the random grid operators per block row
+#define DIAG_STRONG 6.0
+#define DIAG_WEAK 1.2
+
+class BlockMatrix_Test
+{
+protected:
+	int size;
+	// Scalar CSR operator & dense copy
+	std::vector<int> row;
+	std::vector<int> col;
+	std::vector<double> val;
+	std::vector<double> dense;
+	// The same operator as scalar elements in shuffled filling order
+	std::vector<int> ind_i;
+	std::vector<int> ind_j;
+	std::vector<double> a;
+
+	// Random blocks on the block pattern of a nx x ny grid with diag * bs added to the diagonal,
+	// ny == 1 gives a block-tridiagonal matrix
+	void setGrid(const int nx, const int ny, const int bs, const unsigned seed, const double diag = DIAG_STRONG);
+	// Scalar ILU(0) on the expanded block pattern, dense storage
+	void referenceSolve(const std::vector<double>& rhs, std::vector<double>& x) const;
+	void setElements(const unsigned seed);
+	// Solves the operator scaled by 1 + step * it, returns the total number of iterations
+	int solveSequence(ParSolver& solver, const int solvesNum, const double step);
+	double compare(const int nx, const int ny, const int bs, const unsigned seed);
+
+public:
+	void tridiagonal_test();
+	void grid_test();
+	// Pattern & values from scalar elements in filling order, block SpMV
+	void assembly_test();
+	// ParSolver assembling & solving the block operator
+	void solver_test();
+	// GCRO-DR recycling saves iterations over a sequence of systems
+	void recycle_test();
+};
+
+#endif /* BLOCKMATRIX_TEST_H_ */
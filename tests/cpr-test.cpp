@@ -0,0 +1,108 @@
+#include <random>
+#include <cmath>
+#include "gtest/gtest.h"
+
+#include "tests/cpr-test.h"
+
+using std::vector;
+
+void WeightsCPR::calcWeights(const int _blockSize, const int size, const int* row, const int* col, const double* val)
+{
+	blockSize = _blockSize;
+	blocksNum = size / blockSize;
+	setWeights(row, col, val);
+}
+
+void CPR_Test::toCSR()
+{
+	row.assign(size + 1, 0);
+	col.clear();	val.clear();
+	for (int i = 0; i < size; i++)
+	{
+		for (int j = 0; j < size; j++)
+			if (dense[i * size + j] != 0.0)
+			{
+				col.push_back(j);
+				val.push_back(dense[i * size + j]);
+			}
+		row[i + 1] = (int)col.size();
+	}
+}
+
+void CPR_Test::setChain(const int blocksNum, const int bs, const unsigned seed)
+{
+	std::mt19937 gen(seed);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	size = blocksNum * bs;
+
+	dense.assign(size * size, 0.0);
+	for (int k = 0; k < blocksNum; k++)
+		for (int nebr = k - 1; nebr <= k + 1; nebr++)
+		{
+			if (nebr < 0 || nebr >= blocksNum)
+				continue;
+			for (int i = 0; i < bs; i++)
+				for (int j = 0; j < bs; j++)
+					dense[(k * bs + i) * size + nebr * bs + j] = dist(gen) + (nebr == k && i == j ? 4.0 : 0.0);
+		}
+	toCSR();
+}
+
+void CPR_Test::decoupling_test()
+{
+	const int blocks[] = { 1, 2, 3, 4 };
+	WeightsCPR cpr;
+
+	for (int b = 0; b < 4; b++)
+	{
+		const int bs = blocks[b];
+		const int blocksNum = 20;
+		setChain(blocksNum, bs, b);
+		cpr.calcWeights(bs, size, &row[0], &col[0], &val[0]);
+		const vector<double>& w = cpr.getWeights();
+		ASSERT_EQ((int)w.size(), size);
+
+		for (int k = 0; k < blocksNum; k++)
+		{
+			// Unit pressure weight, combined equation is free of the other block variables
+			EXPECT_NEAR(w[k * bs], 1.0, CPR_TOL);
+			for (int j = 1; j < bs; j++)
+			{
+				double sum = 0.0;
+				for (int i = 0; i < bs; i++)
+					sum += w[k * bs + i] * dense[(k * bs + i) * size + k * bs + j];
+				EXPECT_NEAR(sum, 0.0, CPR_TOL);
+			}
+		}
+	}
+}
+
+void CPR_Test::analytic_test()
+{
+	WeightsCPR cpr;
+	const int bs = 2;
+	size = 3 * bs;
+	dense.assign(size * size, 0.0);
+
+	// Regular block: w = (1, -b / d)
+	dense[0 * size + 0] = 2.0;	dense[0 * size + 1] = 3.0;
+	dense[1 * size + 0] = 1.0;	dense[1 * size + 1] = 4.0;
+	// Zero pressure derivative in the first equation needs pivoting: w = (1, -1)
+	dense[2 * size + 2] = 0.0;	dense[2 * size + 3] = 1.0;
+	dense[3 * size + 2] = 1.0;	dense[3 * size + 3] = 1.0;
+	// Singular block falls back to the pressure equation only
+	dense[4 * size + 4] = 1.0;	dense[4 * size + 5] = 2.0;
+	dense[5 * size + 4] = 2.0;	dense[5 * size + 5] = 4.0;
+	// Couplings outside of the diagonal blocks do not affect the weights
+	dense[0 * size + 3] = 5.0;	dense[3 * size + 4] = -7.0;
+	toCSR();
+
+	cpr.calcWeights(bs, size, &row[0], &col[0], &val[0]);
+	const vector<double>& w = cpr.getWeights();
+	EXPECT_NEAR(w[0], 1.0, CPR_TOL);
+	EXPECT_NEAR(w[1], -0.75, CPR_TOL);
+	EXPECT_NEAR(w[2], 1.0, CPR_TOL);
+	EXPECT_NEAR(w[3], -1.0, CPR_TOL);
+	EXPECT_NEAR(w[4], 1.0, CPR_TOL);
+	EXPECT_NEAR(w[5], 0.0, CPR_TOL);
+}
@@ -0,0 +1,36 @@
+#ifndef CPR_TEST_H_
+#define CPR_TEST_H_
+
+#include <vector>
+
+#include "method/CPRPreconditioner.h"
+
+#define CPR_TOL 1.E-12
+
+// Access to the quasi-IMPES weights without building the whole preconditioner
+class WeightsCPR : public CPRPreconditioner
+{
+public:
+	void calcWeights(const int _blockSize, const int size, const int* row, const int* col, const double* val);
+	const std::vector<double>& getWeights() const { return weights; };
+};
+
+class CPR_Test
+{
+protected:
+	int size;
+	std::vector<int> row;
+	std::vector<int> col;
+	std::vector<double> val;
+	std::vector<double> dense;
+
+	// Random point-block chain with couplings to the neighbour blocks
+	void setChain(const int blocksNum, const int bs, const unsigned seed);
+	void toCSR();
+
+public:
+	void decoupling_test();
+	void analytic_test();
+};
+
+#endif /* CPR_TEST_H_ */
@@ -49,8 +49,8 @@ Properties* Gas1D_Test::getProps()
 
 	props->depth_point = 1500.0;
 
-	setDataFromFile(props->z_factor, "props/z.txt");
-	setDataFromFile(props->visc_gas, "props/gas_visc.txt");
+	props->z_factor = "props/z.txt";
+	props->visc_gas = "props/gas_visc.txt";
 
 	return props;
 }
@@ -50,7 +50,7 @@ Properties* Gas1D_Simple_Test::getProps()
 	props->depth_point = 1500.0;
 
 	props->props_gas.visc = 0.01;
-	setDataFromFile(props->z_factor, "props/z.txt");
+	props->z_factor = "props/z.txt";
 
 	return props;
 }
@@ -0,0 +1,132 @@
+#include <random>
+#include <cmath>
+#include "gtest/gtest.h"
+
+#include "tests/interpolate-test.h"
+#include "util/utils.h"
+
+void Interpolate_Test::setTable(const int n, const double ratio)
+{
+	double h = 0.1;
+
+	x.resize(n);	y.resize(n);	dy.resize(n);
+	x[0] = -1.0;
+	for (int i = 1; i < n; i++)
+	{
+		x[i] = x[i - 1] + h;
+		h *= ratio;
+	}
+	for (int i = 0; i < n; i++)
+	{
+		y[i] = sin(x[i]) + x[i] * x[i];
+		dy[i] = cos(x[i]) + 2.0 * x[i];
+	}
+}
+
+int Interpolate_Test::findSegment(const double arg) const
+{
+	const int n = (int)x.size();
+
+	if (arg <= x[0])
+		return 0;
+	for (int i = 0; i < n - 1; i++)
+		if (arg <= x[i + 1])
+			return i;
+	return n - 2;
+}
+
+void Interpolate_Test::compare(const Interpolate& table, const int argsNum)
+{
+	const int n = (int)x.size();
+	const double xmin = x[0], xmax = x[n - 1];
+	std::mt19937 gen(n);
+	std::uniform_real_distribution<double> dist(xmin - 0.5, xmax + 0.5);
+	double arg, argc, val, dval, val1, dval1;
+	int i;
+
+	for (int k = 0; k < argsNum + n; k++)
+	{
+		// Table nodes themselves & random points including ones out of the table
+		arg = (k < n ? x[k] : dist(gen));
+		argc = (arg < xmin ? xmin : (arg > xmax ? xmax : arg));
+
+		i = findSegment(argc);
+		val = y[i] + (argc - x[i]) / (x[i + 1] - x[i]) * (y[i + 1] - y[i]);
+		if (arg < xmin || arg > xmax)
+			dval = 0.0;
+		else if (table.IsSetDiff)
+			dval = dy[i] + (arg - x[i]) / (x[i + 1] - x[i]) * (dy[i + 1] - dy[i]);
+		else
+			dval = (y[i + 1] - y[i]) / (x[i + 1] - x[i]);
+
+		// At nodes the neighbour segment gives the same value
+		EXPECT_NEAR(table.Solve(arg), val, INTERPOLATE_TOL);
+		table.Solve(arg, val1, dval1);
+		EXPECT_NEAR(val1, val, INTERPOLATE_TOL);
+		if (k >= n)
+		{
+			EXPECT_NEAR(table.DSolve(arg), dval, INTERPOLATE_TOL);
+			EXPECT_NEAR(dval1, dval, INTERPOLATE_TOL);
+		}
+	}
+}
+
+void Interpolate_Test::compareScaled(const double xDim, const double yDim)
+{
+	const int n = (int)x.size();
+	std::vector<double> xr(n), yr(n);
+	for (int i = 0; i < n; i++)
+	{
+		xr[i] = x[i] * xDim;
+		yr[i] = y[i] * yDim;
+	}
+
+	Interpolate table(&xr[0], &yr[0], n, xDim, yDim);
+	Interpolate ref(&x[0], &y[0], n);
+	EXPECT_EQ(table.x, (const double*)&xr[0]);
+
+	std::mt19937 gen(n);
+	std::uniform_real_distribution<double> dist(x[0] - 0.5, x[n - 1] + 0.5);
+	double arg, val, dval, d2val, val1, dval1, d2val1;
+
+	for (int k = 0; k < 2000 + n; k++)
+	{
+		arg = (k < n ? x[k] : dist(gen));
+		// Scaling rounds the stored points, so values are compared relatively
+		ref.Solve(arg, val, dval, d2val);
+		table.Solve(arg, val1, dval1, d2val1);
+		EXPECT_NEAR(val1, val, INTERPOLATE_TOL * (1.0 + fabs(val)));
+		EXPECT_NEAR(table.Solve(arg), val1, INTERPOLATE_TOL * (1.0 + fabs(val)));
+		if (k >= n)
+		{
+			EXPECT_NEAR(dval1, dval, INTERPOLATE_TOL * (1.0 + fabs(dval)));
+			EXPECT_NEAR(table.DSolve(arg), dval1, INTERPOLATE_TOL * (1.0 + fabs(dval)));
+		}
+		table.Solve(&arg, &val1, &dval1, 1);
+		EXPECT_NEAR(val1, val, INTERPOLATE_TOL * (1.0 + fabs(val)));
+	}
+}
+
+void Interpolate_Test::test()
+{
+	// Uniform, strongly refined towards one end & minimal tables
+	const int sizes[] = { 2, 3, 17, 200 };
+	const double ratios[] = { 1.0, 1.05, 0.9 };
+
+	for (int s = 0; s < 4; s++)
+		for (int r = 0; r < 3; r++)
+		{
+			setTable(sizes[s], ratios[r]);
+			Interpolate table(&x[0], &y[0], (int)x.size());
+			Interpolate diffTable(&x[0], &y[0], &dy[0], (int)x.size());
+			compare(table, 2000);
+			compare(diffTable, 2000);
+			compareScaled(1.E5, 0.25);
+		}
+}
+
+void Interpolate_Test::missing_test()
+{
+	EXPECT_EXIT(setDataset("props/no_such_table.txt", 1.0, 1.0), ::testing::ExitedWithCode(255), "");
+	EXPECT_EXIT(setInvDataset("props/no_such_table.txt", 1.0, 1.0), ::testing::ExitedWithCode(255), "");
+}
@@ -0,0 +1,31 @@
+#ifndef INTERPOLATE_TEST_H_
+#define INTERPOLATE_TEST_H_
+
+#include <vector>
+
+#include "util/Interpolate.h"
+
+#define INTERPOLATE_TOL 1.E-12
+
+class Interpolate_Test
+{
+protected:
+	std::vector<double> x;
+	std::vector<double> y;
+	std::vector<double> dy;
+
+	// Grid of n points with geometric steps, ratio == 1 gives a uniform one
+	void setTable(const int n, const double ratio);
+	// Segment found by linear search as before the bucket index
+	int findSegment(const double arg) const;
+	void compare(const Interpolate& table, const int argsNum);
+	// Table over unscaled external arrays as mapped from a binary file
+	void compareScaled(const double xDim, const double yDim);
+
+public:
+	void test();
+	// Missing table stops the model loading
+	void missing_test();
+};
+
+#endif /* INTERPOLATE_TEST_H_ */
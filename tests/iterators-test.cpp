@@ -64,17 +64,17 @@ Properties* Iterators_Test::getProps()
 	props->props_gas.dens_stc = 0.8;
 
 	// Defining relative permeabilities
-	setDataFromFile(props->kr_oil, "props/koil.txt");
-	setDataFromFile(props->kr_gas, "props/kgas.txt");
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
 
 	// Defining volume factors
 	//props->byDefault.B_oil = true;
-	setDataFromFile(props->B_oil, "props/Boil.txt");
+	props->B_oil = "props/Boil.txt";
 	//props->byDefault.B_gas = false;
-	setDataFromFile(props->B_gas, "props/Bgas.txt");
+	props->B_gas = "props/Bgas.txt";
 
 	//props->byDefault.Rs = true;
-	setDataFromFile(props->Rs, "props/Rs.txt");
+	props->Rs = "props/Rs.txt";
 
 	return props;
 }
@@ -0,0 +1,179 @@
+#include <new>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "gtest/gtest.h"
+
+#include "tests/jfnk-test.h"
+#include "util/utils.h"
+
+using namespace gasOil_perf_nit;
+using std::make_pair;
+using std::vector;
+
+Properties* JFNK_Test::getProps()
+{
+	Properties* props = new gasOil_perf_nit::Properties();
+
+	props->cellsNum_r = 8;
+	props->cellsNum_phi = 3;
+	props->cellsNum_z = 2;
+
+	props->timePeriods.push_back(86400.0);
+
+	props->leftBoundIsRate = true;
+	props->rightBoundIsPres = true;
+	props->rates.push_back(100.0);
+
+	props->ht = 100.0;
+	props->ht_min = 100.0;
+	props->ht_max = 100000.0;
+
+	props->alpha = 7200.0;
+
+	props->perfTunnels.push_back(make_pair(1, 0));
+	props->perfTunnels.push_back(make_pair(1 + 1 * (props->cellsNum_r + 2) * (props->cellsNum_z + 2), 0));
+	props->perfTunnels.push_back(make_pair(2 + 2 * (props->cellsNum_r + 2) * (props->cellsNum_z + 2), 0));
+
+	props->r_w = 0.05;
+	props->r_e = 1000.0;
+
+	Skeleton_Props tmp;
+	tmp.cellsNum_z = 2;
+	tmp.m = 0.1;
+	tmp.p_init = tmp.p_out = tmp.p_bub = 200.0 * 100000.0;
+	tmp.s_init = 0.8;
+	tmp.t_init = -0.025;
+	tmp.h1 = 0.0;
+	tmp.h2 = 10.0;
+	tmp.height = 10.0;
+	tmp.perm_r = 100.0;
+	tmp.perm_z = 10.0;
+	tmp.dens_stc = 2000.0;
+	tmp.beta = 6.0 * 1.0e-10;
+
+	tmp.skins.push_back(0.0);
+	tmp.radiuses_eff.push_back(props->r_w);
+
+	tmp.c = 1800.0;
+	tmp.kappa_eff = 0.0;
+	tmp.lambda_r = tmp.lambda_z = 0.0;
+	props->props_sk.push_back(tmp);
+
+	props->depth_point = 0.0;
+
+	props->props_oil.visc = 1.0;
+	props->props_oil.b_bore = 1.0;
+	props->props_oil.dens_stc = 736.0;
+	props->props_oil.beta = 1.0 * 1.e-9;
+	props->props_oil.jt = 0.0;
+	props->props_oil.ad = 0.0;
+	props->props_oil.c = 1880.0;
+	props->props_oil.lambda = 0.0;
+
+	props->props_gas.visc = 0.03;
+	props->props_gas.dens_stc = 0.8;
+	props->props_gas.jt = 0.0;
+	props->props_gas.ad = 0.0;
+	props->props_gas.c = 3200.0;
+	props->props_gas.lambda = 0.0;
+
+	props->L = -50.0 * 1.e3;
+
+	props->kr_oil = "props/koil.txt";
+	props->kr_gas = "props/kgas.txt";
+	props->B_oil = "props/new/Boil100.txt";
+	props->B_gas = "props/Bgas.txt";
+	props->Rs = "props/new/Rs100.txt";
+
+	return props;
+}
+
+void JFNK_Test::setState(GasOil_Perf_NIT_Wrapped* model)
+{
+	std::mt19937 gen(7);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+	for (int i = 0; i < (int)model->cells.size() + (int)model->tunnelCells.size(); i++)
+	{
+		Cell& cell = (i < (int)model->cells.size() ? model->cells[i] : model->tunnelCells[i - model->cells.size()]);
+		Var2phaseNIT& next = cell.u_next;
+		next.p *= 1.0 + 0.05 * dist(gen);
+		next.s = 0.75 + 0.15 * dist(gen);
+		next.SATUR = (i % 3 != 0);
+		next.p_bub = (next.SATUR ? next.p : 0.9 * next.p);
+	}
+}
+
+void JFNK_Test::test()
+{
+	Properties* props = getProps();
+	GasOil_Perf_NIT_Wrapped* model = new GasOil_Perf_NIT_Wrapped();
+	model->load(*props);
+	paralution::init_paralution();
+	ParPerfNIT_Wrapped* solver = new ParPerfNIT_Wrapped(model);
+
+	const int size = 2 * (model->cellsNum + (int)model->tunnelCells.size());
+	solver->pres_solver.Init(size);
+	solver->fillIndices(PRES);
+	const int elemNum = solver->presElemNum;
+	const vector<int> ind_i(solver->ind_i, solver->ind_i + elemNum);
+	const vector<int> ind_j(solver->ind_j, solver->ind_j + elemNum);
+	solver->pres_solver.setPattern(solver->ind_i, solver->ind_j, elemNum);
+
+	model->setPeriod(0);
+	setState(model);
+	solver->copyIterLayer();
+
+	// Assembled Jacobian in COO form, duplicated elements share the slot value
+	solver->a = solver->pres_solver.beginAssemble();
+	solver->fill(PRES);
+	const int* slots = solver->pres_solver.getSlots();
+	int nnz = 0;
+	for (int k = 0; k < elemNum; k++)
+		nnz = std::max(nnz, slots[k] + 1);
+	vector<int> row(nnz), col(nnz);
+	for (int k = 0; k < elemNum; k++)
+	{
+		row[slots[k]] = ind_i[k];
+		col[slots[k]] = ind_j[k];
+	}
+	const vector<double> val(solver->a, solver->a + nnz);
+	solver->pres_solver.Assemble(solver->rhs);
+
+	std::mt19937 gen(11);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	vector<double> v(size), Av(size), y(size);
+	for (int test = 0; test < 3; test++)
+	{
+		for (int i = 0; i < size; i++)
+			v[i] = dist(gen) * (i % 2 == 0 ? 1.0 : 0.01);
+
+		std::fill(Av.begin(), Av.end(), 0.0);
+		for (int l = 0; l < nnz; l++)
+			Av[row[l]] += val[l] * v[col[l]];
+		solver->applyJacobian(&v[0], &y[0]);
+
+		double diff = 0.0, norm = 0.0;
+		for (int i = 0; i < size; i++)
+		{
+			diff = std::max(diff, fabs(y[i] - Av[i]));
+			norm = std::max(norm, fabs(Av[i]));
+		}
+		EXPECT_LT(diff, JFNK_REL_TOL * norm);
+	}
+
+	// Perturbed state is reverted
+	for (int i = 0; i < model->cellsNum; i++)
+	{
+		EXPECT_EQ(model->cells[i].u_next.p, model->cells[i].u_iter.p);
+		EXPECT_EQ(model->cells[i].u_next.s, model->cells[i].u_iter.s);
+		EXPECT_EQ(model->cells[i].u_next.p_bub, model->cells[i].u_iter.p_bub);
+	}
+
+	delete solver;
+	delete model;
+	delete props;
+	paralution::stop_paralution();
+}
@@ -0,0 +1,33 @@
+#ifndef JFNK_TEST_H_
+#define JFNK_TEST_H_
+
+#include "model/3D/Perforation/GasOil_Perf_NIT.h"
+#include "model/3D/Perforation/ParPerfNITSolver.h"
+
+#define JFNK_REL_TOL 1.E-4
+
+class GasOil_Perf_NIT_Wrapped : public gasOil_perf_nit::GasOil_Perf_NIT
+{
+	friend class JFNK_Test;
+};
+
+class ParPerfNIT_Wrapped : public gasOil_perf_nit::ParPerfNITSolver
+{
+	friend class JFNK_Test;
+public:
+	ParPerfNIT_Wrapped(gasOil_perf_nit::GasOil_Perf_NIT* _model) : gasOil_perf_nit::ParPerfNITSolver(_model) {};
+};
+
+// Finite difference Jacobian products against the assembled Jacobian
+class JFNK_Test
+{
+protected:
+	gasOil_perf_nit::Properties* getProps();
+	// Non-uniform state with saturated & undersaturated cells
+	void setState(GasOil_Perf_NIT_Wrapped* model);
+
+public:
+	void test();
+};
+
+#endif /* JFNK_TEST_H_ */
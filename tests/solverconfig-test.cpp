@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+
+#include "tests/solverconfig-test.h"
+
+using std::string;
+
+bool SolverConfig_Test::load(const string& text, ParSolverConfig& config)
+{
+	std::ofstream file(SOLVERCONFIG_TEST_FILE);
+	file << text;
+	file.close();
+
+	const bool isLoaded = config.load(SOLVERCONFIG_TEST_FILE);
+	remove(SOLVERCONFIG_TEST_FILE);
+	return isLoaded;
+}
+
+void SolverConfig_Test::valid_test()
+{
+	ParSolverConfig config;
+	EXPECT_TRUE(load("# CPR for pressure-saturation blocks\n"
+		"precond cpr\n"
+		"block_size 2\n"
+		"restart 40   # longer basis\n"
+		"rel_tol 1.E-8\n"
+		"recycle_size 4\n"
+		"warm_start true\n"
+		"inexact_newton 0\n", config));
+
+	EXPECT_EQ(config.precond, PRECOND_CPR);
+	EXPECT_EQ(config.blockSize, 2);
+	EXPECT_EQ(config.restart, 40);
+	EXPECT_DOUBLE_EQ(config.relTol, 1.E-8);
+	EXPECT_EQ(config.recycleSize, 4);
+	EXPECT_TRUE(config.isWarmStart);
+	EXPECT_FALSE(config.isInexactNewton);
+	// Not mentioned settings are kept
+	EXPECT_EQ(config.maxIter, ParSolverConfig().maxIter);
+}
+
+void SolverConfig_Test::rejected_test()
+{
+	const char* texts[] = {
+		"restart 40\nrestrat 50\n",
+		"restart 3x\n",
+		"rel_tol abc\n",
+		"warm_start yes\n",
+		"precond ilu0\n",
+		"restart 0\n",
+		"max_iter -5\n",
+		"rel_tol 2.0\n",
+		"abs_tol -1.E-10\n",
+		"fill_level -1\n",
+		"precond bilu0\nblock_size 5\n",
+		"recycle_size 30\n",
+		"precond cpr\nblock_size 2\nprecision single_krylov\n",
+		"precond amg\nprecision single_precond\n",
+		"method bicgstab\nprecision single_krylov\n",
+		"precision single_krylov\njfnk true\n",
+		"precision single_krylov\nrecycle_size 4\n"
+	};
+
+	for (int i = 0; i < (int)(sizeof(texts) / sizeof(texts[0])); i++)
+	{
+		ParSolverConfig config;
+		EXPECT_FALSE(load(texts[i], config)) << texts[i];
+		// Settings are left untouched
+		EXPECT_EQ(config.restart, ParSolverConfig().restart);
+		EXPECT_EQ(config.precond, ParSolverConfig().precond);
+	}
+
+	ParSolverConfig config;
+	EXPECT_FALSE(config.load("snaps/no_such_config.txt"));
+}
@@ -0,0 +1,22 @@
+#ifndef SOLVERCONFIG_TEST_H_
+#define SOLVERCONFIG_TEST_H_
+
+#include <string>
+
+#include "method/ParalutionInterface.h"
+
+#define SOLVERCONFIG_TEST_FILE "snaps/solver_config.txt"
+
+class SolverConfig_Test
+{
+protected:
+	// Writes text to the test file & loads it over the defaults
+	bool load(const std::string& text, ParSolverConfig& config);
+
+public:
+	void valid_test();
+	// Unknown names, malformed numbers & out of range values reject the whole file
+	void rejected_test();
+};
+
+#endif /* SOLVERCONFIG_TEST_H_ */
@@ -0,0 +1,258 @@
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "gtest/gtest.h"
+
+#include "tests/sweep-test.h"
+
+using std::vector;
+
+void OriginalSweep::Solve(int NZ, int MZ, int key)
+{
+	int i, j, k, l, n;
+	double piv, c;
+	vector<vector<vector<double> > > pz(NZ + 1, vector<vector<double> >(MZ + 1, vector<double>(MZ + 1, 0.0)));
+	vector<vector<vector<double> > > qz(NZ + 1, vector<vector<double> >(MZ + 1, vector<double>(MZ + 1, 0.0)));
+
+	InitWorkspace();
+	for (i = 1; i <= MZ; i++)
+		for (j = 1; j <= 3 * MZ + 1; j++)
+			bz[i][j] = 0.0;
+	RightBoundAppr(MZ, key);
+
+	for (n = NZ; n >= 0; n--)
+	{
+		for (i = MZ + 1; i <= 2 * MZ; i++)
+			for (j = 1; j <= 3 * MZ + 1; j++)
+				bz[i][j] = 0.0;
+
+		if (n == 1)
+		{
+			LeftBoundAppr(MZ, key);
+			for (k = 1; k <= MZ; k++)
+				for (j = MZ + 1; j <= 2 * MZ; j++)
+				{
+					if (bz[j][k] == 0.0)
+						continue;
+					for (i = 1; i <= MZ; i++)
+					{
+						bz[j][i + MZ] -= pz[2][k][i] * bz[j][k];
+						bz[j][i + 2 * MZ] -= qz[2][k][i] * bz[j][k];
+					}
+					bz[j][3 * MZ + 1] -= fz[2][k] * bz[j][k];
+				}
+			for (i = 1; i <= MZ; i++)
+				for (j = MZ + 1; j <= 2 * MZ; j++)
+				{
+					bz[j][i] = bz[j][i + MZ];
+					bz[j][i + MZ] = bz[j][i + 2 * MZ];
+					bz[j][i + 2 * MZ] = 0.0;
+				}
+		} else if (n > 1)
+			MiddleAppr(n - 1, MZ, key);
+
+		for (l = 1; l <= MZ; l++)
+		{
+			// Maximum searching over both floors
+			piv = 0.0;
+			k = l;
+			for (i = l; i <= 2 * MZ; i++)
+				if (fabs(bz[i][l]) > fabs(piv))
+				{
+					k = i;
+					piv = bz[i][l];
+				}
+			for (j = l; j <= 3 * MZ + 1; j++)
+			{
+				bz[k][j] /= piv;
+				if (k != l)
+					std::swap(bz[k][j], bz[l][j]);
+			}
+			for (i = 1; i <= 2 * MZ; i++)
+			{
+				if (i == l)
+					continue;
+				c = bz[i][l];
+				for (j = l + 1; j <= 3 * MZ + 1; j++)
+					bz[i][j] -= bz[l][j] * c;
+			}
+		}
+
+		for (i = 1; i <= MZ; i++)
+		{
+			fz[n][i] = bz[i][3 * MZ + 1];
+			if (n == 0)
+				continue;
+			for (j = 1; j <= MZ; j++)
+			{
+				pz[n][i][j] = bz[i][j + MZ];
+				if (n != 1)
+					qz[n][i][j] = bz[i][j + 2 * MZ];
+			}
+		}
+		if (n == 0)
+			break;
+
+		for (i = 1; i <= MZ; i++)
+		{
+			bz[i][3 * MZ + 1] = bz[i + MZ][3 * MZ + 1];
+			for (j = 1; j <= 2 * MZ; j++)
+				bz[i][j] = bz[i + MZ][j + MZ];
+			for (j = 2 * MZ + 1; j <= 3 * MZ; j++)
+				bz[i][j] = 0.0;
+		}
+	}
+
+	for (j = 1; j <= MZ; j++)
+		for (i = 1; i <= MZ; i++)
+			fz[1][j] -= pz[1][j][i] * fz[0][i];
+	for (k = 2; k <= NZ; k++)
+		for (j = 1; j <= MZ; j++)
+			for (i = 1; i <= MZ; i++)
+				fz[k][j] -= pz[k][j][i] * fz[k - 1][i] + qz[k][j][i] * fz[k - 2][i];
+}
+
+template <class sweepType>
+RandomSweep<sweepType>::RandomSweep(const int _nodesNum, const int _eqNum, const unsigned seed) : nodesNum(_nodesNum), eqNum(_eqNum)
+{
+	const int mz2 = eqNum * eqNum;
+	const int blockNum = 3 * mz2 + eqNum;
+	std::mt19937 gen(seed);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+	this->Initialize(nodesNum, eqNum);
+
+	blocks.resize(nodesNum * blockNum);
+	for (int k = 0; k < (int)blocks.size(); k++)
+		blocks[k] = dist(gen);
+
+	// Block of the node itself: A for the right boundary, C for the left one, B in the middle
+	for (int n = 0; n < nodesNum; n++)
+	{
+		const int diag = (n == nodesNum - 1 ? 0 : (n == 0 ? 2 : 1));
+		for (int i = 0; i < eqNum; i++)
+			blocks[n * blockNum + diag * mz2 + i * eqNum + i] += 4.0 * eqNum;
+	}
+}
+
+template <class sweepType>
+void RandomSweep<sweepType>::setBlocks(const int node)
+{
+	const int mz2 = eqNum * eqNum;
+	const double* b = &blocks[node * (3 * mz2 + eqNum)];
+
+	for (int i = 0; i < eqNum; i++)
+	{
+		for (int j = 0; j < eqNum; j++)
+		{
+			this->A[i][j] = b[i * eqNum + j];
+			this->B[i][j] = b[mz2 + i * eqNum + j];
+			this->C[i][j] = b[2 * mz2 + i * eqNum + j];
+		}
+		this->RightSide[i][0] = b[3 * mz2 + i];
+	}
+}
+
+template <class sweepType>
+void RandomSweep<sweepType>::LeftBoundAppr(int MZ, int key)
+{
+	setBlocks(0);
+	this->construction_bz(MZ, 2);
+}
+
+template <class sweepType>
+void RandomSweep<sweepType>::MiddleAppr(int current, int MZ, int key)
+{
+	setBlocks(current);
+	this->construction_bz(MZ, 2);
+}
+
+template <class sweepType>
+void RandomSweep<sweepType>::RightBoundAppr(int MZ, int key)
+{
+	setBlocks(nodesNum - 1);
+	this->construction_bz(MZ, 1);
+}
+
+template <class sweepType>
+void RandomSweep<sweepType>::solve()
+{
+	this->Solve(nodesNum - 1, eqNum, 0);
+}
+
+template <class sweepType>
+double Sweep_Test::compare(const int nodesNum, const int eqNum, const unsigned seed)
+{
+	RandomSweep<OriginalSweep> orig(nodesNum, eqNum, seed);
+	RandomSweep<sweepType> tested(nodesNum, eqNum, seed);
+	double norm = 0.0, diff = 0.0;
+
+	orig.solve();
+	tested.solve();
+
+	for (int n = 0; n < nodesNum; n++)
+		for (int e = 0; e < eqNum; e++)
+		{
+			norm = std::max(norm, fabs(orig.getSolution(n, e)));
+			diff = std::max(diff, fabs(orig.getSolution(n, e) - tested.getSolution(n, e)));
+		}
+
+	return diff / norm;
+}
+
+void Sweep_Test::kernels_test()
+{
+	// Unrolled kernels for 1-4 equations & the generic one
+	for (int eqNum = 1; eqNum <= 6; eqNum++)
+	{
+		EXPECT_LT(compare<Sweep>(3, eqNum, eqNum), SWEEP_REL_TOL);
+		EXPECT_LT(compare<Sweep>(20, eqNum, eqNum), SWEEP_REL_TOL);
+	}
+}
+
+void Sweep_Test::band_test()
+{
+	// Equation counts with & without grouped numbering
+	const int eqNums[] = { 1, 2, 3, 5, 8 };
+	for (int k = 0; k < 5; k++)
+	{
+		EXPECT_LT(compare<BandSweep>(4, eqNums[k], k), SWEEP_REL_TOL);
+		EXPECT_LT(compare<BandSweep>(17, eqNums[k], k), SWEEP_REL_TOL);
+	}
+}
+
+void Sweep_Test::cyclic_test()
+{
+	// Odd & even node counts, 5, 6 & 7 blocks have kept blocks without an upper neighbour
+	for (int nodesNum = 9; nodesNum <= 14; nodesNum++)
+		for (int eqNum = 1; eqNum <= 3; eqNum++)
+			EXPECT_LT(compare<ForcedCyclicSweep>(nodesNum, eqNum, nodesNum * eqNum), SWEEP_REL_TOL);
+
+	EXPECT_LT(compare<ForcedCyclicSweep>(3, 2, 1), SWEEP_REL_TOL);
+	EXPECT_LT(compare<ForcedCyclicSweep>(64, 2, 2), SWEEP_REL_TOL);
+	EXPECT_LT(compare<ForcedCyclicSweep>(101, 4, 3), SWEEP_REL_TOL);
+}
+
+void Sweep_Test::memory_test()
+{
+	// Wide blocks as in (z, phi) slabs of 3D grids
+	const int nodesNum = 40, eqNum = 96;
+	paralution::init_paralution();
+
+	RandomSweep<Sweep> dense(nodesNum, eqNum, 1);
+	EXPECT_EQ(dense.getWorkspaceSize(), 0);
+	dense.solve();
+	EXPECT_GE(dense.getWorkspaceSize(), 2 * nodesNum * eqNum * eqNum * sizeof(double));
+
+	// Assembled sweeps keep only non-zeros, no dense elimination workspace
+	RandomSweep<BandSweep> band(nodesNum, eqNum, 1);
+	band.solve();
+	EXPECT_EQ(band.getWorkspaceSize(), 0);
+
+	RandomSweep<SparseSweep> sparse(nodesNum, eqNum, 1);
+	sparse.solve();
+	sparse.solve();
+	EXPECT_EQ(sparse.getWorkspaceSize(), 0);
+
+	paralution::stop_paralution();
+}
@@ -0,0 +1,64 @@
+#ifndef SWEEP_TEST_H_
+#define SWEEP_TEST_H_
+
+#include <vector>
+
+#include "method/sweep.h"
+#include "method/BandSweep.h"
+#include "method/CyclicSweep.h"
+#include "method/SparseSweep.h"
+
+#define SWEEP_REL_TOL 1.E-10
+
+// Sweep::Solve as it was before the block kernels, used as the reference
+class OriginalSweep : public Sweep
+{
+public:
+	void Solve(int NZ, int MZ, int key);
+};
+
+// Cyclic reduction regardless of grid size & number of threads
+class ForcedCyclicSweep : public CyclicSweep
+{
+public:
+	void Solve(int NZ, int MZ, int key) { solveCyclic(NZ, MZ, key); };
+};
+
+// Random diagonally dominant block-tridiagonal system passed through the approximation hooks
+template <class sweepType>
+class RandomSweep : public sweepType
+{
+protected:
+	int nodesNum;
+	int eqNum;
+	// A, B, C blocks & right side of each node
+	std::vector<double> blocks;
+
+	void setBlocks(const int node);
+	void LeftBoundAppr(int MZ, int key);
+	void MiddleAppr(int current, int MZ, int key);
+	void RightBoundAppr(int MZ, int key);
+
+public:
+	RandomSweep(const int _nodesNum, const int _eqNum, const unsigned seed);
+
+	void solve();
+	double getSolution(const int node, const int eq) const { return this->fz[node][eq + 1]; };
+};
+
+class Sweep_Test
+{
+protected:
+	// Maximum difference with the original sweep relative to the solution norm
+	template <class sweepType>
+	double compare(const int nodesNum, const int eqNum, const unsigned seed);
+
+public:
+	void kernels_test();
+	void band_test();
+	void cyclic_test();
+	// Dense workspace is left to the dense sweep only
+	void memory_test();
+};
+
+#endif /* SWEEP_TEST_H_ */
@@ -4,6 +4,12 @@
 #include "tests/gas1D-test.h"
 #include "tests/gas1Dsimple-test.h"
 #include "tests/iterators-test.h"
+#include "tests/sweep-test.h"
+#include "tests/interpolate-test.h"
+#include "tests/blockmatrix-test.h"
+#include "tests/solverconfig-test.h"
+#include "tests/cpr-test.h"
+#include "tests/jfnk-test.h"
 
 TEST(Gas1DTest, StationaryRate)
 {
@@ -45,4 +51,100 @@ TEST(Iterators, 3D_Iterators)
 	Iterators_Test test;
 	test.run();
 	test.test();
+}
+
+TEST(Sweep, BlockKernels)
+{
+	Sweep_Test test;
+	test.kernels_test();
+}
+
+TEST(Sweep, BandLU)
+{
+	Sweep_Test test;
+	test.band_test();
+}
+
+TEST(Sweep, CyclicReduction)
+{
+	Sweep_Test test;
+	test.cyclic_test();
+}
+
+TEST(Sweep, WorkspaceMemory)
+{
+	Sweep_Test test;
+	test.memory_test();
+}
+
+TEST(Interpolate, BucketIndex)
+{
+	Interpolate_Test test;
+	test.test();
+}
+
+TEST(Interpolate, MissingTable)
+{
+	Interpolate_Test test;
+	test.missing_test();
+}
+
+TEST(BlockMatrix, Tridiagonal)
+{
+	BlockMatrix_Test test;
+	test.tridiagonal_test();
+}
+
+TEST(BlockMatrix, GridILU0)
+{
+	BlockMatrix_Test test;
+	test.grid_test();
+}
+
+TEST(BlockMatrix, Assembly)
+{
+	BlockMatrix_Test test;
+	test.assembly_test();
+}
+
+TEST(BlockMatrix, BlockOperatorSolve)
+{
+	BlockMatrix_Test test;
+	test.solver_test();
+}
+
+TEST(BlockMatrix, KrylovRecycling)
+{
+	BlockMatrix_Test test;
+	test.recycle_test();
+}
+
+TEST(SolverConfig, Valid)
+{
+	SolverConfig_Test test;
+	test.valid_test();
+}
+
+TEST(SolverConfig, Rejected)
+{
+	SolverConfig_Test test;
+	test.rejected_test();
+}
+
+TEST(CPR, QuasiImpesDecoupling)
+{
+	CPR_Test test;
+	test.decoupling_test();
+}
+
+TEST(CPR, QuasiImpesWeights)
+{
+	CPR_Test test;
+	test.analytic_test();
+}
+
+TEST(JFNK, JacobianProduct)
+{
+	JFNK_Test test;
+	test.test();
 }
\ No newline at end of file
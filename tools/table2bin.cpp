@@ -0,0 +1,43 @@
+// Converts text tables of "argument value" lines into the binary format mapped by TableRegistry
+// Usage: table2bin input.txt output.bin [input2.txt output2.bin ...]
+// Build: tools/table2bin.vcxproj in the solution, or
+//        g++ -std=c++11 -I.. table2bin.cpp ../util/TableFile.cpp ../util/TableRegistry.cpp ../util/Interpolate.cpp
+
+#include <iostream>
+#include <cstdlib>
+
+#include "util/utils.h"
+#include "util/TableFile.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3 || argc % 2 == 0)
+	{
+		cerr << "Usage: table2bin input.txt output.bin [input2.txt output2.bin ...]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 1; i < argc; i += 2)
+	{
+		vector< pair<double,double> > vec;
+		setDataFromFile(vec, argv[i]);
+		if (vec.empty())
+		{
+			cerr << "No data in " << argv[i] << endl;
+			return EXIT_FAILURE;
+		}
+
+		if (!writeTableFile(argv[i + 1], vec))
+		{
+			cerr << "Cannot write " << argv[i + 1] << endl;
+			return EXIT_FAILURE;
+		}
+		cout << argv[i] << " -> " << argv[i + 1] << " (" << vec.size() << " points)" << endl;
+	}
+
+	return EXIT_SUCCESS;
+}
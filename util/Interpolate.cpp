@@ -1,116 +1,187 @@
 #include "util/Interpolate.h"
 #include <iostream>
 
+// Average number of buckets per segment
+#define BUCKETS_PER_SEGMENT 4
+
 Interpolate::Interpolate()
 {
+	x = y = dy = d2y = NULL;
+	bucket = NULL;
+	N = bucketsNum = 0;
+	IsSetDiff = IsSetDiff2 = false;
+	isOwner = true;
+	setScales(1.0, 1.0);
 }
 
 Interpolate::~Interpolate()
 {
+	if (isOwner)
+	{
+		delete[] x;
+		delete[] y;
+		delete[] dy;
+		delete[] d2y;
+	}
+	delete[] bucket;
 }
 
 Interpolate::Interpolate(double *ptx, double *pty, int _N)
 {
-	Nf = 1000000;
-	Flag = new int[Nf+1];
 	N  = _N;
-	x = new double[N];
-	y = new double[N];
+	double* tx = new double[N];
+	double* ty = new double[N];
+	dy = d2y = NULL;
 
 	for (int i= 0; i < N; i++){
-		x[i] = ptx[i];
-		y[i] = pty[i];
+		tx[i] = ptx[i];
+		ty[i] = pty[i];
 	}
+	x = tx;		y = ty;
+	isOwner = true;
+	setScales(1.0, 1.0);
 	
 	xmin = x[0];
 	xmax = x[N-1];
-	int j;
-	temp = (xmax - xmin)/Nf;
-	
-	for (int i = 0; i < N-1; i++)
-		for (j = floor((x[i] - xmin)/temp); j <= floor((x[i+1] - xmin)/temp); j++)
-			Flag[j] = i;
+	buildIndex();
 	
 	IsSetDiff = false;
-
+	IsSetDiff2 = false;
 }
 
-Interpolate::Interpolate(double *ptx, double *pty, double *dpty, int N)
+Interpolate::Interpolate(double *ptx, double *pty, double *dpty, int _N)
 {
-	Nf = 10000;
-	Flag = new int[Nf+1];
-	x = new double[N];
-	y = new double[N];
-	dy = new double[N];
+	N = _N;
+	double* tx = new double[N];
+	double* ty = new double[N];
+	double* tdy = new double[N];
+	d2y = NULL;
 	for (int i= 0; i < N; i++){
-		x[i] = ptx[i];
-		y[i] = pty[i];
-		dy[i] = dpty[i];
+		tx[i] = ptx[i];
+		ty[i] = pty[i];
+		tdy[i] = dpty[i];
 	}
+	x = tx;		y = ty;		dy = tdy;
+	isOwner = true;
+	setScales(1.0, 1.0);
 	xmin = x[0];
 	xmax = x[N-1];
-	temp = (xmax - xmin)/Nf;
-	for (int i = 0; i < N-1; i++){
-		for (int j = floor((x[i] - xmin)/temp); j <= floor((x[i+1] - xmin)/temp); j++)
-		Flag[j] = i;
-	}
+	buildIndex();
 	IsSetDiff = true;
-
+	IsSetDiff2 = false;
 }
 
-Interpolate::Interpolate(double *ptx, double *pty, double *dpty, double *d2pty, int N)
+Interpolate::Interpolate(double *ptx, double *pty, double *dpty, double *d2pty, int _N)
 {
-	Nf = 10000;
-	Flag = new int[Nf+1];
-	x = new double[N];
-	y = new double[N];
-	dy = new double[N];
-	d2y = new double[N];
+	N = _N;
+	double* tx = new double[N];
+	double* ty = new double[N];
+	double* tdy = new double[N];
+	double* td2y = new double[N];
 
 	for (int i= 0; i < N; i++){
-		x[i] = ptx[i];
-		y[i] = pty[i];
-		dy[i] = dpty[i];
-		d2y[i]  = d2pty[i];
+		tx[i] = ptx[i];
+		ty[i] = pty[i];
+		tdy[i] = dpty[i];
+		td2y[i]  = d2pty[i];
 	}
+	x = tx;		y = ty;		dy = tdy;		d2y = td2y;
+	isOwner = true;
+	setScales(1.0, 1.0);
 	xmin = x[0];
 	xmax = x[N-1];
-	temp = (xmax - xmin)/Nf;
-	for (int i = 0; i < N-1; i++){
-		for (int j = floor((x[i] - xmin)/temp); j <= floor((x[i+1] - xmin)/temp); j++)
-		Flag[j] = i;
-	}
+	buildIndex();
 	IsSetDiff = true;
 	IsSetDiff2 = true;
 }
 
-double Interpolate::Solve(double arg)
+Interpolate::Interpolate(const double *ptx, const double *pty, int _N, const double xDim, const double yDim)
 {
+	N = _N;
+	x = ptx;
+	y = pty;
+	dy = d2y = NULL;
+	isOwner = false;
+	setScales(xDim, yDim);
+
+	xmin = x[0];
+	xmax = x[N-1];
+	buildIndex();
+
+	IsSetDiff = false;
+	IsSetDiff2 = false;
+}
+
+void Interpolate::setScales(const double xDim, const double yDim)
+{
+	argScale = xDim;
+	valScale = 1.0 / yDim;
+	derScale = xDim / yDim;
+	der2Scale = xDim * xDim / yDim;
+}
+
+void Interpolate::buildIndex()
+{
+	bucketsNum = BUCKETS_PER_SEGMENT * (N > 1 ? N - 1 : 1);
+	bucketWidth = (xmax - xmin) / bucketsNum;
+	bucket = new int[bucketsNum + 1];
+
+	int seg = 0;
+	for (int k = 0; k <= bucketsNum; k++)
+	{
+		const double left = xmin + k * bucketWidth;
+		while (seg < N - 2 && x[seg + 1] <= left)
+			seg++;
+		bucket[k] = seg;
+	}
+}
+
+int Interpolate::getSegment(double arg) const
+{
+	int k = (bucketWidth > 0.0 ? (int)floor((arg - xmin) / bucketWidth) : 0);
+	if (k < 0)
+		k = 0;
+	else if (k > bucketsNum)
+		k = bucketsNum;
+
+	int seg = bucket[k];
+	while (seg < N - 2 && x[seg + 1] < arg)
+		seg++;
+	// Rounding of the bucket number
+	while (seg > 0 && x[seg] > arg)
+		seg--;
+
+	return seg;
+}
+
+double Interpolate::Solve(double arg) const
+{
+	arg *= argScale;
 	if (arg < xmin ) 
 		arg = xmin;
 	else if(arg > xmax) 
 		arg = xmax;
 
-	int index = floor( (arg - xmin) / temp );
-	double dx = x[Flag[index]+1] - x[Flag[index]];
-	double dy = y[Flag[index]+1] - y[Flag[index]];
+	const int index = getSegment(arg);
+	double dx = x[index+1] - x[index];
+	double dy = y[index+1] - y[index];
 	
-	return (arg - x[Flag[index]])/dx*dy + y[Flag[index]];
+	return ((arg - x[index])/dx*dy + y[index]) * valScale;
 }
 
-double Interpolate::DSolve(double arg)
+double Interpolate::DSolve(double arg) const
 {
 	double result;
 	double dx;
 	double dcy;
 	
+	arg *= argScale;
 	if(arg < xmin)
 		return 0;
 	else if(arg > xmax)
 		return 0;
 
-	int i = floor((arg - xmin)/temp);
-	int index = Flag[i];
+	const int index = getSegment(arg);
 	
 	if (IsSetDiff)
 	{
@@ -123,21 +194,17 @@ double Interpolate::DSolve(double arg)
 		result = dcy/dx;
 	}
 
-	return result;
+	return result * derScale;
 }
 
-double Interpolate::D2Solve(double arg)
+double Interpolate::D2Solve(double arg) const
 {
 	double result;
 	double dx;
 	double dcy;
 	
-	int i = floor((arg - xmin)/temp);
-	if (i > Nf)
-		i= Nf;
-	if (i < 0)
-		i = 0;
-    int index = Flag[i];
+	arg *= argScale;
+	const int index = getSegment(arg);
 	
 	if (IsSetDiff2)
 	{
@@ -147,6 +214,80 @@ double Interpolate::D2Solve(double arg)
 	} else 
 		result = 0;
 	
-	return result;
+	return result * der2Scale;
+
+}
+
+void Interpolate::Solve(double arg, double& val, double& dval) const
+{
+	arg *= argScale;
+	const bool isInside = (arg >= xmin && arg <= xmax);
+	const double argc = (arg < xmin ? xmin : (arg > xmax ? xmax : arg));
+
+	const int index = getSegment(argc);
+	const double dx = x[index+1] - x[index];
+	
+	val = (argc - x[index])/dx*(y[index+1] - y[index]) + y[index];
+
+	if(!isInside)
+		dval = 0.0;
+	else if(IsSetDiff)
+		dval = (arg - x[index])/dx*(dy[index+1] - dy[index]) + dy[index];
+	else
+		dval = (y[index] - y[index + 1]) / (x[index] - x[index + 1]);
+
+	val *= valScale;
+	dval *= derScale;
+}
+
+void Interpolate::Solve(double arg, double& val, double& dval, double& d2val) const
+{
+	arg *= argScale;
+	const bool isInside = (arg >= xmin && arg <= xmax);
+	const double argc = (arg < xmin ? xmin : (arg > xmax ? xmax : arg));
+
+	// Clamped argument falls into the boundary segment D2Solve extrapolates over
+	const int index = getSegment(argc);
+	const double dx = x[index+1] - x[index];
+	
+	val = (argc - x[index])/dx*(y[index+1] - y[index]) + y[index];
+
+	if(!isInside)
+		dval = 0.0;
+	else if(IsSetDiff)
+		dval = (arg - x[index])/dx*(dy[index+1] - dy[index]) + dy[index];
+	else
+		dval = (y[index] - y[index + 1]) / (x[index] - x[index + 1]);
+
+	if(IsSetDiff2)
+		d2val = (arg - x[index])/dx*(d2y[index+1] - d2y[index]) + d2y[index];
+	else
+		d2val = 0.0;
+
+	val *= valScale;
+	dval *= derScale;
+	d2val *= der2Scale;
+}
 
-}
\ No newline at end of file
+void Interpolate::Solve(const double* arg, double* val, double* dval, int n) const
+{
+	// Segment search is the only branchy part, the rest is a streaming pass over contiguous arrays
+	for (int i = 0; i < n; i++)
+	{
+		const double a = arg[i] * argScale;
+		const double argc = (a < xmin ? xmin : (a > xmax ? xmax : a));
+		const int index = getSegment(argc);
+		const double dx = x[index+1] - x[index];
+
+		val[i] = ((argc - x[index])/dx*(y[index+1] - y[index]) + y[index]) * valScale;
+		if (dval == NULL)
+			continue;
+
+		if (a < xmin || a > xmax)
+			dval[i] = 0.0;
+		else if (IsSetDiff)
+			dval[i] = ((a - x[index])/dx*(dy[index+1] - dy[index]) + dy[index]) * derScale;
+		else
+			dval[i] = (y[index] - y[index + 1]) / (x[index] - x[index + 1]) * derScale;
+	}
+}
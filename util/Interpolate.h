@@ -5,25 +5,52 @@
 
 class Interpolate
 {
+	protected:
+	// Bucket index over [xmin, xmax]: bucket k keeps the first segment crossing it,
+	// the segment is then found by a short search
+	int* bucket;
+	int bucketsNum;
+	double bucketWidth;
+	void buildIndex();
+	int getSegment(double arg) const;
+
+	// Tables over external arrays do not delete them
+	bool isOwner;
+	// Lookup arguments are multiplied by argScale to get stored ones,
+	// stored values & derivatives are multiplied by valScale, derScale & der2Scale
+	double argScale, valScale, derScale, der2Scale;
+	void setScales(const double xDim, const double yDim);
+
+	// Owns bucket array & usually x, y arrays, copies are not allowed
+	Interpolate(const Interpolate&);
+	Interpolate& operator=(const Interpolate&);
+
 	public:
 	Interpolate();
 	Interpolate(double *ptx, double *pty, int N);
 	Interpolate(double *ptx, double *pty, double *dpty, int N);
 	Interpolate(double *ptx, double *pty, double *dpty,double *d2pty, int N);
+	// Points to ptx & pty without copying, they must outlive the table.
+	// The table is over ptx / xDim with values pty / yDim
+	Interpolate(const double *ptx, const double *pty, int N, const double xDim, const double yDim);
 	~Interpolate();
 	
-	double Solve(double arg);
-	double DSolve(double arg);
-	double D2Solve(double arg);
+	double Solve(double arg) const;
+	double DSolve(double arg) const;
+	double D2Solve(double arg) const;
+	// Fused lookups: the same results as Solve, DSolve & D2Solve from a single segment search
+	void Solve(double arg, double& val, double& dval) const;
+	void Solve(double arg, double& val, double& dval, double& d2val) const;
+	// Batch lookup of n arguments, dval may be NULL if derivatives are not needed
+	void Solve(const double* arg, double* val, double* dval, int n) const;
 	
-	double *x;
-	double *y;
-	double *dy;
-	double *d2y;
-	int *Flag;
+	const double *x;
+	const double *y;
+	const double *dy;
+	const double *d2y;
 	int N;
-	int Nf;
-	double xmin, xmax, temp;
+	// Bounds of stored arguments
+	double xmin, xmax;
 	bool IsSetDiff;
 	bool IsSetDiff2;
 };
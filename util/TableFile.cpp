@@ -0,0 +1,144 @@
+#include "util/TableFile.h"
+
+#include <fstream>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::pair;
+using std::ofstream;
+
+MappedTable::MappedTable() : data(NULL), size(0), x(NULL), y(NULL), N(0)
+{
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#else
+	fd = -1;
+#endif
+}
+
+MappedTable::~MappedTable()
+{
+	close();
+}
+
+bool MappedTable::open(const string& fileName)
+{
+	close();
+
+#ifdef _WIN32
+	file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(TableFileHeader))
+	{
+		close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+	data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TableFileHeader))
+	{
+		close();
+		return false;
+	}
+	size = (size_t)st.st_size;
+
+	data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+		data = NULL;
+#endif
+
+	if (data == NULL)
+	{
+		close();
+		return false;
+	}
+
+	const TableFileHeader* header = (const TableFileHeader*)data;
+	if (header->magic != TABLE_FILE_MAGIC || header->version != TABLE_FILE_VERSION || header->N < 0 ||
+		size < sizeof(TableFileHeader) + 2 * sizeof(double) * (size_t)header->N)
+	{
+		close();
+		return false;
+	}
+
+	N = header->N;
+	x = (const double*)((const char*)data + sizeof(TableFileHeader));
+	y = x + N;
+
+	return true;
+}
+
+void MappedTable::close()
+{
+#ifdef _WIN32
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (mapping != NULL)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data != NULL)
+		munmap(data, size);
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+#endif
+
+	data = NULL;
+	size = 0;
+	x = y = NULL;
+	N = 0;
+}
+
+bool writeTableFile(const string& fileName, vector< pair<double,double> > vec)
+{
+	std::sort(vec.begin(), vec.end());
+
+	TableFileHeader header;
+	header.magic = TABLE_FILE_MAGIC;
+	header.version = TABLE_FILE_VERSION;
+	header.N = (int)vec.size();
+	header.reserved = 0;
+
+	ofstream file(fileName.c_str(), ofstream::out | ofstream::binary);
+	if (!file.is_open())
+		return false;
+
+	file.write((const char*)&header, sizeof(header));
+	for (int i = 0; i < header.N; i++)
+		file.write((const char*)&vec[i].first, sizeof(double));
+	for (int i = 0; i < header.N; i++)
+		file.write((const char*)&vec[i].second, sizeof(double));
+
+	return file.good();
+}
@@ -0,0 +1,55 @@
+#ifndef TABLEFILE_H_
+#define TABLEFILE_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Binary table file: header, then N arguments and N values as native doubles.
+// Arguments are sorted ascending, so the table needs neither parsing nor sorting on load
+#define TABLE_FILE_MAGIC 0x4C425444
+#define TABLE_FILE_VERSION 1
+
+struct TableFileHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	int N;
+	// Keeps data aligned by 8 bytes
+	int reserved;
+};
+
+// Read-only memory mapping of a binary table file
+class MappedTable
+{
+	protected:
+	void* data;
+	size_t size;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#else
+	int fd;
+#endif
+
+	MappedTable(const MappedTable&);
+	MappedTable& operator=(const MappedTable&);
+
+	public:
+	MappedTable();
+	~MappedTable();
+
+	// Returns false if the file is missing or is not a binary table
+	bool open(const std::string& fileName);
+	void close();
+
+	// Point to the mapped memory, valid until close()
+	const double* x;
+	const double* y;
+	int N;
+};
+
+// Writes pairs of (argument, value) sorted by argument
+bool writeTableFile(const std::string& fileName, std::vector< std::pair<double,double> > vec);
+
+#endif /* TABLEFILE_H_ */
@@ -0,0 +1,151 @@
+#include "util/TableRegistry.h"
+#include "util/utils.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using std::vector;
+using std::pair;
+using std::map;
+using std::string;
+using std::lock_guard;
+using std::mutex;
+
+bool TableRegistry::Key::operator<(const Key& key) const
+{
+	if (fileName != key.fileName)
+		return fileName < key.fileName;
+	if (xDim != key.xDim)
+		return xDim < key.xDim;
+	if (yDim != key.yDim)
+		return yDim < key.yDim;
+	return inverse < key.inverse;
+}
+
+TableRegistry::TableRegistry()
+{
+}
+
+TableRegistry::~TableRegistry()
+{
+	map<Key, Entry>::iterator it;
+	for (it = tables.begin(); it != tables.end(); ++it)
+	{
+		delete it->second.table;
+		delete it->second.file;
+	}
+}
+
+TableRegistry& TableRegistry::get()
+{
+	static TableRegistry registry;
+	return registry;
+}
+
+bool TableRegistry::load(const Key& key, Entry& entry)
+{
+	vector< pair<double,double> > vec;
+
+	entry.file = new MappedTable;
+	if (entry.file->open(key.fileName))
+	{
+		// Binary arguments are sorted, the inverse table is used in place if values are sorted too
+		const double* x = (key.inverse ? entry.file->y : entry.file->x);
+		const double* y = (key.inverse ? entry.file->x : entry.file->y);
+		const int N = entry.file->N;
+		if (N > 0 && std::is_sorted(x, x + N))
+		{
+			entry.table = new Interpolate(x, y, N, key.xDim, key.yDim);
+			return true;
+		}
+
+		vec.reserve(N);
+		for (int i = 0; i < N; i++)
+			vec.push_back(make_pair(entry.file->x[i], entry.file->y[i]));
+	} else
+		setDataFromFile(vec, key.fileName);
+
+	delete entry.file;
+	entry.file = NULL;
+	if (vec.empty())
+		return false;
+
+	const int N = vec.size();
+	vector<double> x(N), y(N);
+	if (key.inverse)
+	{
+		sort(vec.begin(), vec.end(), sort_pair_second());
+		for (int i = 0; i < N; i++)
+		{
+			x[i] = vec[i].second / key.xDim;
+			y[i] = vec[i].first / key.yDim;
+		}
+	} else {
+		sort(vec.begin(), vec.end(), sort_pair_first());
+		for (int i = 0; i < N; i++)
+		{
+			x[i] = vec[i].first / key.xDim;
+			y[i] = vec[i].second / key.yDim;
+		}
+	}
+
+	entry.table = new Interpolate(x.data(), y.data(), N);
+	return true;
+}
+
+Interpolate* TableRegistry::acquire(const string& fileName, const double xDim, const double yDim, const bool inverse)
+{
+	Key key;
+	key.fileName = fileName;
+	key.xDim = xDim;
+	key.yDim = yDim;
+	key.inverse = inverse;
+
+	lock_guard<mutex> lock(mtx);
+
+	// Looked up before the file is read, so every file is parsed once per scaling
+	map<Key, Entry>::iterator it = tables.find(key);
+	if (it != tables.end())
+	{
+		it->second.refs++;
+		return it->second.table;
+	}
+
+	// Models cannot run without their tables, so the load is stopped here rather than at the first lookup
+	Entry entry;
+	if (!load(key, entry))
+	{
+		std::cout << "Error: no data in table " << fileName << std::endl;
+		exit(-1);
+	}
+	entry.refs = 1;
+
+	tables[key] = entry;
+	return entry.table;
+}
+
+void TableRegistry::release(const Interpolate* table)
+{
+	lock_guard<mutex> lock(mtx);
+
+	// Models hold a few tables, so the linear search is cheap
+	map<Key, Entry>::iterator it;
+	for (it = tables.begin(); it != tables.end(); ++it)
+		if (it->second.table == table)
+			break;
+	if (it == tables.end())
+		return;
+
+	if (--it->second.refs == 0)
+	{
+		delete it->second.table;
+		delete it->second.file;
+		tables.erase(it);
+	}
+}
+
+int TableRegistry::size()
+{
+	lock_guard<mutex> lock(mtx);
+	return (int)tables.size();
+}
@@ -0,0 +1,59 @@
+#ifndef TABLEREGISTRY_H_
+#define TABLEREGISTRY_H_
+
+#include <string>
+#include <map>
+#include <mutex>
+
+#include "util/Interpolate.h"
+#include "util/TableFile.h"
+
+// Process-wide storage of read-only property tables.
+// A table is read from its file once per scaling and shared by all models,
+// it is deleted when its last user releases it. Tables from binary files
+// point into the file mapping, which the entry keeps open. Interpolate lookups are const,
+// so a shared table is safe to read from several threads
+class TableRegistry
+{
+	protected:
+	struct Key
+	{
+		std::string fileName;
+		double xDim;
+		double yDim;
+		// Table of argument over value
+		bool inverse;
+
+		bool operator<(const Key& key) const;
+	};
+	struct Entry
+	{
+		Interpolate* table;
+		// NULL for text tables
+		MappedTable* file;
+		int refs;
+	};
+
+	std::map<Key, Entry> tables;
+	std::mutex mtx;
+
+	TableRegistry();
+	~TableRegistry();
+	TableRegistry(const TableRegistry&);
+	TableRegistry& operator=(const TableRegistry&);
+
+	// Maps or reads the table, false if the file has no data
+	static bool load(const Key& key, Entry& entry);
+
+	public:
+	static TableRegistry& get();
+
+	// Returns the table from the file with arguments divided by xDim & values by yDim.
+	// Exits if the file is missing or has no data
+	Interpolate* acquire(const std::string& fileName, const double xDim, const double yDim, const bool inverse);
+	// Tables that do not belong to registry are ignored
+	void release(const Interpolate* table);
+	int size();
+};
+
+#endif /* TABLEREGISTRY_H_ */
@@ -6,9 +6,9 @@
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <functional>
 
 #include "util/Interpolate.h"
+#include "util/TableRegistry.h"
 
 #define BAR_TO_PA 1.E5
 #define P_ATM 1.0
@@ -20,21 +20,6 @@ using std::string;
 using std::sort;
 using std::make_pair;
 using std::ifstream;
-using std::function;
-
-struct FillFoo
-{
-	std::vector<vector<function<double(int, int)> > > mat;
-	std::vector<function<double(int)> > rhs;
-
-	FillFoo& operator=(const FillFoo& a)
-	{
-		mat = a.mat;
-		rhs = a.rhs;
-
-		return *this;
-	}
-};
 
 inline constexpr double delta(const int i, const int j)
 {
@@ -47,14 +32,8 @@ inline void setDataFromFile(vector< pair<double,double> >& vec, string fileName)
 	file.open(fileName.c_str(), ifstream::in);
 	
 	double temp1, temp2;
-	while( !file.eof() )
-	{
-		file >> temp1;
-		if( file.eof() )
-			break;
-		file >> temp2;
+	while( file >> temp1 >> temp2 )
 		vec.push_back(make_pair(temp1, temp2));
-	}
 
 	file.close();
 };
@@ -114,38 +93,22 @@ struct sort_pair_second {
     }
 };
 
-inline Interpolate* setDataset(vector< pair<double,double> >& vec, const double xDim, const double yDim)
+// Shared table from the file, arguments are divided by xDim & values by yDim
+inline Interpolate* setDataset(const string& fileName, const double xDim, const double yDim)
 {
-	sort(vec.begin(), vec.end(), sort_pair_first());
-
-	const int N = vec.size();
-	double* x = new double [N];
-	double* y  = new double [N];
-
-	for (int i = 0; i < N; i++)
-	{
-		x[i] = vec[i].first / xDim;
-		y[i] = vec[i].second / yDim;
-	}
-
-	return new Interpolate(x, y, N);
+	return TableRegistry::get().acquire(fileName, xDim, yDim, false);
 };
 
-inline Interpolate* setInvDataset(vector< pair<double,double> >& vec, const double xDim, const double yDim)
+// Shared table of arguments over values from the file
+inline Interpolate* setInvDataset(const string& fileName, const double xDim, const double yDim)
 {
-	sort(vec.begin(), vec.end(), sort_pair_second());
-
-	const int N = vec.size();
-	double* x = new double [N];
-	double* y  = new double [N];
-
-	for (int i = 0; i < N; i++)
-	{
-		x[i] = vec[i].second / xDim;
-		y[i] = vec[i].first / yDim;
-	}
+	return TableRegistry::get().acquire(fileName, xDim, yDim, true);
+};
 
-	return new Interpolate(x, y, N);
+// Counterpart of setDataset & setInvDataset
+inline void releaseDataset(Interpolate* table)
+{
+	TableRegistry::get().release(table);
 };
 
 #endif /* UTILS_H_ */
\ No newline at end of file